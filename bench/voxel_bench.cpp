@@ -0,0 +1,394 @@
+// Headless benchmark of the voxel core: terrain generation, sky light, meshing and the network codec for fixed seeds,
+// without Godot.
+//
+//   scons bench && ./bin/voxel_bench [iterations] && ./bin/voxel_bench_morton [iterations]
+//
+// The two builds differ only in the block layout (see Core::MORTON_LAYOUT) and must print the same golden hash.
+//
+// The golden hash covers every mesh built, so a change to generation or meshing output fails the run even when it
+// is faster. Update EXPECTED_GOLDEN only for intended output changes. Every chunk and delta batch is sent through the
+// wire codec and must decode to the same blocks.
+//
+// Meshing runs the extension's path: faces counted to size the buffers, buffers taken from a MeshBufferPool and held
+// while the previous mesh "uploads", collision faces built into one reused vector. Everything else keeps its buffers
+// between seeds too, so after the first iteration the run must not allocate at all. Operator new is replaced below
+// to count every allocation.
+
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/core/mesh_builder.hpp"
+#include "hpp/voxel/core/pcg32.hpp"
+#include "hpp/voxel/core/sky_light.hpp"
+#include "hpp/voxel/core/terrain_generator.hpp"
+#include "hpp/voxel/core/wire_codec.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+using namespace Voxel;
+
+namespace Bench
+{
+    static uint64_t s_allocations = 0;
+} //namespace Bench
+
+// The array and nothrow forms call these. The bench is single threaded, so the count is a plain integer.
+void *operator new(std::size_t p_size)
+{
+    Bench::s_allocations++;
+    if (void *pMemory = std::malloc(p_size == 0 ? 1 : p_size))
+        return pMemory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p_memory) noexcept
+{
+    std::free(p_memory);
+}
+
+void operator delete(void *p_memory, std::size_t) noexcept
+{
+    std::free(p_memory);
+}
+
+namespace Bench
+{
+    static constexpr int64_t SEEDS[] = { 8675309, 1, 20240611 };
+    // Generated chunks per side. Only the inner ones are meshed, so every meshed chunk has all four neighbors.
+    static constexpr int32_t GRID = 5;
+    static constexpr int32_t SEA_LEVEL = static_cast<int32_t>(CHUNK_HEIGHT_U / 4);
+
+    static constexpr uint64_t EXPECTED_GOLDEN = 0xfccf8b26d73cfad3ull;
+
+    struct ChunkStorage
+    {
+        std::unique_ptr<Block[]> pBlocks = std::make_unique<Block[]>(CHUNK_BLOCK_COUNT_MAX);
+        std::unique_ptr<uint8_t[]> pLight = std::make_unique<uint8_t[]>(CHUNK_BLOCK_COUNT_MAX);
+        // Zero until the chunk is first meshed, as on a Chunk.
+        Core::FaceCounts faceCounts;
+    };
+
+    // Everything reused from seed to seed and iteration to iteration, as the extension keeps its buffers.
+    struct Workspace
+    {
+        std::vector<ChunkStorage> grid = std::vector<ChunkStorage>(static_cast<size_t>(GRID) * GRID);
+        std::vector<uint32_t> lightQueue;
+        Core::MeshBufferPool meshPool;
+        std::vector<Core::Float3> collisionFaces;
+        std::unique_ptr<Block[]> pReceived = std::make_unique<Block[]>(CHUNK_BLOCK_COUNT_MAX);
+        std::vector<uint8_t> wireBytes;
+        std::vector<uint16_t> deltaIndices;
+        std::vector<Core::WireCodec::SectionDelta> deltas;
+    };
+
+    struct Totals
+    {
+        double generateSec = 0.0;
+        double lightSec = 0.0;
+        double meshSec = 0.0;
+        double collisionSec = 0.0;
+        uint64_t generated = 0;
+        uint64_t meshed = 0;
+        uint64_t faces = 0;
+        uint64_t vertices = 0;
+        uint64_t meshBytes = 0;
+        uint64_t collisionFaces = 0;
+
+        double wireEncodeSec = 0.0;
+        double wireDecodeSec = 0.0;
+        uint64_t wireChunks = 0;
+        uint64_t wireBodyBytes = 0;
+        uint64_t deltaBatches = 0;
+        uint64_t deltaBlocks = 0;
+        uint64_t deltaBytes = 0;
+        uint64_t mismatches = 0;
+    };
+
+    // Edits per delta batch: sparse changes in a few sections and one section rewritten whole.
+    static constexpr uint32_t DELTA_SPARSE_SECTIONS = 3;
+    static constexpr uint32_t DELTA_SPARSE_CHANGES = 20;
+
+    static double seconds_since(std::chrono::steady_clock::time_point p_start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - p_start).count();
+    }
+
+    // Sends a chunk through the wire codec into pReceived, then a batch of edits to it, checking after each that the
+    // receiver holds the same blocks. Edits the sender's blocks, so it runs after meshing.
+    static void round_trip_chunk(int64_t p_seed, int32_t x, int32_t z, ChunkStorage &r_chunk, Workspace &r_work, Totals &r_totals)
+    {
+        Block *pBlocks = r_chunk.pBlocks.get();
+        Block *pReceived = r_work.pReceived.get();
+        std::vector<uint8_t> &r_bytes = r_work.wireBytes;
+        std::vector<uint16_t> &indices = r_work.deltaIndices;
+        std::vector<Core::WireCodec::SectionDelta> &deltas = r_work.deltas;
+
+        r_bytes.clear();
+        auto start = std::chrono::steady_clock::now();
+        Core::WireCodec::encode_sections(pBlocks, CHUNK_SECTION_COUNT, r_bytes);
+        r_totals.wireEncodeSec += seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        const uint8_t *pEnd = r_bytes.data() + r_bytes.size();
+        const bool decoded = Core::WireCodec::decode_sections(r_bytes.data(), pEnd, CHUNK_SECTION_COUNT, pReceived) == pEnd;
+        r_totals.wireDecodeSec += seconds_since(start);
+
+        r_totals.wireChunks++;
+        r_totals.wireBodyBytes += r_bytes.size();
+        if (!decoded || !std::equal(pBlocks, pBlocks + CHUNK_BLOCK_COUNT_MAX, pReceived))
+        {
+            std::printf("Chunk (%d, %d) of seed %" PRId64 " decoded to different blocks.\n", x, z, p_seed);
+            r_totals.mismatches++;
+            return;
+        }
+
+        // The edits are as random as the terrain, but the same every run.
+        Core::Pcg32 rng(Core::TerrainGenerator::get_chunk_seed(p_seed, x, z) ^ 0x5DEECE66Dull);
+
+        r_bytes.clear();
+        uint32_t entries = 0;
+        for (uint32_t i = 0; i <= DELTA_SPARSE_SECTIONS; i++)
+        {
+            const uint32_t section = rng.next_bounded(CHUNK_SECTION_COUNT);
+            Block *pSection = pBlocks + static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+            const bool snapshot = i == DELTA_SPARSE_SECTIONS;
+
+            indices.clear();
+            const uint32_t changes = snapshot ? SECTION_BLOCK_COUNT : DELTA_SPARSE_CHANGES;
+            for (uint32_t change = 0; change < changes; change++)
+            {
+                const uint32_t index = snapshot ? change : rng.next_bounded(SECTION_BLOCK_COUNT);
+                pSection[Core::to_storage_local(index)] = Block::from_id(static_cast<int32_t>(rng.next_bounded(Block::ID_COUNT)));
+                indices.push_back(static_cast<uint16_t>(index));
+            }
+
+            std::sort(indices.begin(), indices.end());
+            indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+            r_totals.deltaBlocks += indices.size();
+
+            start = std::chrono::steady_clock::now();
+            const Core::WireCodec::DeltaMode mode = snapshot ? Core::WireCodec::DELTA_SNAPSHOT : Core::WireCodec::DELTA_SPARSE;
+            Core::WireCodec::encode_delta(x, z, section, pSection, mode, indices, r_bytes);
+            r_totals.wireEncodeSec += seconds_since(start);
+            entries++;
+        }
+
+        start = std::chrono::steady_clock::now();
+        const bool decodedDeltas = Core::WireCodec::decode_deltas(r_bytes.data(), r_bytes.data() + r_bytes.size(), entries, deltas);
+        r_totals.wireDecodeSec += seconds_since(start);
+
+        r_totals.deltaBatches++;
+        r_totals.deltaBytes += r_bytes.size();
+        if (!decodedDeltas)
+        {
+            std::printf("Delta batch for chunk (%d, %d) of seed %" PRId64 " failed to decode.\n", x, z, p_seed);
+            r_totals.mismatches++;
+            return;
+        }
+
+        // Applied the way World::apply_block_deltas does.
+        for (const Core::WireCodec::SectionDelta &delta : deltas)
+        {
+            Block *pSection = pReceived + static_cast<size_t>(delta.section) * SECTION_BLOCK_COUNT;
+            if (delta.mode == Core::WireCodec::DELTA_SNAPSHOT)
+            {
+                std::copy(delta.blocks.begin(), delta.blocks.end(), pSection);
+                continue;
+            }
+
+            for (size_t i = 0; i < delta.indices.size(); i++)
+                pSection[Core::to_storage_local(delta.indices[i])] = delta.blocks[i];
+        }
+
+        if (!std::equal(pBlocks, pBlocks + CHUNK_BLOCK_COUNT_MAX, pReceived))
+        {
+            std::printf("Delta batch for chunk (%d, %d) of seed %" PRId64 " left different blocks.\n", x, z, p_seed);
+            r_totals.mismatches++;
+        }
+    }
+
+    static ChunkStorage &at(std::vector<ChunkStorage> &p_grid, int32_t x, int32_t z)
+    {
+        return p_grid[static_cast<size_t>(z) * GRID + x];
+    }
+
+    static uint64_t run_seed(int64_t p_seed, Workspace &r_work, Totals &r_totals)
+    {
+        std::vector<ChunkStorage> &grid = r_work.grid;
+        const Core::GenerationParams params{ p_seed, SEA_LEVEL };
+
+        auto start = std::chrono::steady_clock::now();
+        for (int32_t z = 0; z < GRID; z++)
+        {
+            for (int32_t x = 0; x < GRID; x++)
+            {
+                Core::TerrainGenerator::generate(params, x, z, at(grid, x, z).pBlocks.get());
+                at(grid, x, z).faceCounts = Core::FaceCounts();
+                r_totals.generated++;
+            }
+        }
+        r_totals.generateSec += seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (ChunkStorage &chunk : grid)
+            Core::SkyLight::light_chunk(chunk.pBlocks.get(), chunk.pLight.get(), r_work.lightQueue);
+        r_totals.lightSec += seconds_since(start);
+
+        uint64_t hash = 14695981039346656037ull;
+        // The last mesh built, waiting on its upload while the next one builds.
+        Core::MeshBuffers uploading;
+        bool isUploading = false;
+
+        for (int32_t z = 1; z < GRID - 1; z++)
+        {
+            for (int32_t x = 1; x < GRID - 1; x++)
+            {
+                ChunkStorage &chunk = at(grid, x, z);
+
+                Core::ChunkView view;
+                view.pBlocks = chunk.pBlocks.get();
+                view.pLight = chunk.pLight.get();
+                view.pNeighborBlocks[Core::ChunkView::SIDE_POS_X] = at(grid, x + 1, z).pBlocks.get();
+                view.pNeighborBlocks[Core::ChunkView::SIDE_NEG_X] = at(grid, x - 1, z).pBlocks.get();
+                view.pNeighborBlocks[Core::ChunkView::SIDE_POS_Z] = at(grid, x, z + 1).pBlocks.get();
+                view.pNeighborBlocks[Core::ChunkView::SIDE_NEG_Z] = at(grid, x, z - 1).pBlocks.get();
+                view.pNeighborLight[Core::ChunkView::SIDE_POS_X] = at(grid, x + 1, z).pLight.get();
+                view.pNeighborLight[Core::ChunkView::SIDE_NEG_X] = at(grid, x - 1, z).pLight.get();
+                view.pNeighborLight[Core::ChunkView::SIDE_POS_Z] = at(grid, x, z + 1).pLight.get();
+                view.pNeighborLight[Core::ChunkView::SIDE_NEG_Z] = at(grid, x, z - 1).pLight.get();
+
+                // As ChunkMesher::build_mesh does it.
+                start = std::chrono::steady_clock::now();
+                if (chunk.faceCounts.get_total() == 0)
+                    Core::MeshBuilder::count_faces(view, chunk.faceCounts);
+
+                Core::MeshBuffers mesh = r_work.meshPool.acquire();
+                mesh.reserve(chunk.faceCounts);
+                Core::MeshBuilder::build(view, mesh);
+                chunk.faceCounts = mesh.get_face_counts();
+                r_totals.meshSec += seconds_since(start);
+
+                r_totals.meshed++;
+                r_totals.faces += mesh.faceCount;
+                for (const Core::SurfaceBuffers &surface : mesh.surfaces)
+                    r_totals.vertices += surface.vertices.size();
+                r_totals.meshBytes += mesh.get_byte_size();
+
+                hash = (hash ^ mesh.get_hash()) * 1099511628211ull;
+
+                if (isUploading)
+                    r_work.meshPool.release(std::move(uploading));
+                uploading = std::move(mesh);
+                isUploading = true;
+
+                start = std::chrono::steady_clock::now();
+                for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; section++)
+                {
+                    r_work.collisionFaces.clear();
+                    Core::MeshBuilder::build_collision(view, section, r_work.collisionFaces);
+                    r_totals.collisionFaces += r_work.collisionFaces.size() / 3;
+                }
+                r_totals.collisionSec += seconds_since(start);
+            }
+        }
+
+        if (isUploading)
+            r_work.meshPool.release(std::move(uploading));
+
+        for (int32_t z = 0; z < GRID; z++)
+        {
+            for (int32_t x = 0; x < GRID; x++)
+                round_trip_chunk(p_seed, x, z, at(grid, x, z), r_work, r_totals);
+        }
+
+        return hash;
+    }
+} //namespace Bench
+
+int main(int argc, char **argv)
+{
+    using namespace Bench;
+
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+
+    Totals totals;
+    Workspace work;
+    uint64_t golden = 0;
+    uint64_t warmAllocations = 0;
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (int64_t seed : SEEDS)
+            hash = (hash ^ run_seed(seed, work, totals)) * 1099511628211ull;
+
+        if (iteration == 0)
+            warmAllocations = s_allocations;
+
+        // Every iteration builds the same meshes.
+        if (iteration > 0 && hash != golden)
+        {
+            std::printf("Mesh output changed between iterations, %016" PRIx64 " vs %016" PRIx64 ".\n", hash, golden);
+            return 1;
+        }
+        golden = hash;
+    }
+
+    const double meshed = static_cast<double>(totals.meshed);
+    const size_t storageBytes = CHUNK_BLOCK_COUNT_MAX * (sizeof(Block) + sizeof(uint8_t));
+
+#if VOXEL_MORTON_LAYOUT && defined(__BMI2__)
+    const char *pLAYOUT = "morton (bmi2)";
+#elif VOXEL_MORTON_LAYOUT
+    const char *pLAYOUT = "morton (tables)";
+#else
+    const char *pLAYOUT = "linear";
+#endif
+
+    std::printf("Seeds: %zu, grid %dx%d, %d iteration(s), %s layout\n", sizeof(SEEDS) / sizeof(SEEDS[0]), GRID, GRID,
+                iterations, pLAYOUT);
+    std::printf("Generation: %.1f chunks/sec\n", static_cast<double>(totals.generated) / totals.generateSec);
+    std::printf("Sky light:  %.1f chunks/sec\n", static_cast<double>(totals.generated) / totals.lightSec);
+    std::printf("Meshing:    %.1f chunks/sec, %.0f faces/sec, %.0f vertices/chunk\n", meshed / totals.meshSec,
+                static_cast<double>(totals.faces) / totals.meshSec, static_cast<double>(totals.vertices) / meshed);
+    std::printf("Memory:     %zu bytes/chunk of blocks and light, %.0f bytes/chunk of mesh\n", storageBytes,
+                static_cast<double>(totals.meshBytes) / meshed);
+    // FastLZ runs on top of the encoded body in ChunkWire, it is Godot's and not measured here.
+    std::printf("Wire:       %.1f chunks/sec encoded, %.1f decoded, %zu bytes/chunk of blocks, %.0f bytes/chunk encoded\n",
+                static_cast<double>(totals.wireChunks) / totals.wireEncodeSec,
+                static_cast<double>(totals.wireChunks) / totals.wireDecodeSec, CHUNK_BLOCK_COUNT_MAX * sizeof(Block),
+                static_cast<double>(totals.wireBodyBytes) / static_cast<double>(totals.wireChunks));
+    std::printf("Deltas:     %" PRIu64 " batch(es), %.1f bytes/changed block, %" PRIu64 " mismatch(es)\n", totals.deltaBatches,
+                static_cast<double>(totals.deltaBytes) / static_cast<double>(totals.deltaBlocks), totals.mismatches);
+    std::printf("Collision:  %.1f chunks/sec, %.0f faces/chunk\n", meshed / totals.collisionSec,
+                static_cast<double>(totals.collisionFaces) / meshed);
+    std::printf("Allocs:     %" PRIu64 " allocation(s) warming up, %" PRIu64 " after\n", warmAllocations,
+                s_allocations - warmAllocations);
+    std::printf("Golden:     %016" PRIx64 "\n", golden);
+
+    if (totals.mismatches > 0)
+    {
+        std::printf("The wire codec did not round trip.\n");
+        return 1;
+    }
+
+    if (s_allocations != warmAllocations)
+    {
+        std::printf("Allocated after warming up.\n");
+        return 1;
+    }
+
+    if (golden != EXPECTED_GOLDEN)
+    {
+        std::printf("Golden hash mismatch, expected %016" PRIx64 ".\n", EXPECTED_GOLDEN);
+        return 1;
+    }
+
+    return 0;
+}
@@ -2,13 +2,20 @@
 #include "godot_cpp/variant/utility_functions.hpp"
 #include "hpp/tools/log_stream.hpp"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
 
 
 namespace Tools::Log
@@ -21,18 +28,54 @@ namespace Tools::Log
 
     static bool s_useTimestamp = false;
     static bool s_fileClosed = true;
-    static Level s_logLevel = Level::Info;
     static std::ofstream s_file;
 
     static std::string s_fileName;
     static std::string s_timestampStr;
-    static std::string s_msgHeaderStr;
 
-    static std::tm utc_tm_now()
+    struct Record
+    {
+        Level level;
+        std::chrono::system_clock::time_point time;
+        std::string text;
+    };
+
+    // Bounded multi-producer, single-consumer ring. Each slot's sequence says whose turn it is: a producer may fill
+    // slot i at position p once its sequence is p, the writer may take it once it is p + 1.
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    static constexpr size_t RING_SIZE = 4096;
+    static constexpr size_t RING_MASK = RING_SIZE - 1;
+    static_assert((RING_SIZE & RING_MASK) == 0, "Log ring size must be a power of two.");
+
+    static Slot s_ring[RING_SIZE];
+    static std::atomic<size_t> s_enqueuePos{ 0 };
+    static std::atomic<size_t> s_dequeuePos{ 0 };
+    // Everything before this position is in the console and the file.
+    static std::atomic<size_t> s_writtenPos{ 0 };
+    static std::atomic<size_t> s_dropped{ 0 };
+    static std::atomic<bool> s_isWriterRunning{ false };
+    // Producers between their check of s_isWriterRunning and the end of their enqueue. The writer is only told to stop
+    // once this drops to zero, so no line is queued after its final drain.
+    static std::atomic<uint32_t> s_producers{ 0 };
+    static std::atomic<Overflow> s_overflow{ static_cast<Overflow>(VOXEL_LOG_OVERFLOW) };
+
+    static std::thread s_writer;
+    static std::mutex s_wakeMutex;
+    static std::condition_variable s_wake;
+    static bool s_stopWriter = false;
+    // Held around console and file writes, by the writer per batch and by lines written on the calling thread.
+    static std::mutex s_writeMutex;
+
+    // Under s_writeMutex: the second the cached timestamp text is for.
+    static std::time_t s_timestampSecond = 0;
+
+    static std::tm utc_tm(std::time_t time)
     {
-        const auto now = std::chrono::system_clock::now();
-        const std::time_t time = std::chrono::system_clock::to_time_t(now);
-
         std::tm out{};
 #if defined(_WIN32)
         gmtime_s(&out, &time);
@@ -42,9 +85,14 @@ namespace Tools::Log
         return out;
     }
 
-    static std::string utc_timestamp_string()
+    static std::tm utc_tm_now()
     {
-        std::tm tm = utc_tm_now();
+        return utc_tm(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+    }
+
+    static std::string utc_timestamp_string(std::time_t time)
+    {
+        std::tm tm = utc_tm(time);
         std::ostringstream oss;
         oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
         return oss.str();
@@ -83,73 +131,264 @@ namespace Tools::Log
         s_fileName.append(".log");
     }
 
-    static void log_line(Level lvl, std::string_view msg)
+    static const char *level_name(Level lvl)
     {
-        const char *level_str = "Unknown";
         switch (lvl)
         {
             case Level::Info:
-                level_str = "Info ";
-                break;
+                return "Info ";
             case Level::Error:
-                level_str = "Error";
-                break;
+                return "Error";
             case Level::Warn:
-                level_str = "Warn ";
-                break;
+                return "Warn ";
             case Level::Debug:
-                level_str = "Debug";
-                break;
+                return "Debug";
         }
 
+        return "Unknown";
+    }
+
+    static std::string format_line(const Record &record)
+    {
         if (s_useTimestamp)
-            s_timestampStr = "[" + utc_timestamp_string() + "]";
+        {
+            // Formatted once per second rather than once per line.
+            const std::time_t second = std::chrono::system_clock::to_time_t(record.time);
+            if (second != s_timestampSecond || s_timestampStr.empty())
+            {
+                s_timestampSecond = second;
+                s_timestampStr = "[" + utc_timestamp_string(second) + "]";
+            }
+        }
         else
+        {
             s_timestampStr.clear();
+        }
+
+        std::string line;
+        line.reserve(s_timestampStr.size() + 8 + record.text.size());
+        line.append(s_timestampStr).append("[").append(level_name(record.level)).append("] ").append(record.text);
+        return line;
+    }
+
+    // Console lines are gathered into one print, errors and warnings have their own channels and go out in order.
+    static void print_console(Level lvl, const std::string &line, std::string &r_pending)
+    {
+        if (lvl != Level::Error && lvl != Level::Warn)
+        {
+            if (!r_pending.empty())
+                r_pending.push_back('\n');
+            r_pending.append(line);
+            return;
+        }
+
+        if (!r_pending.empty())
+        {
+            godot::UtilityFunctions::print(godot::String(r_pending.c_str()));
+            r_pending.clear();
+        }
 
-        if (!s_timestampStr.empty())
-            s_msgHeaderStr = s_timestampStr + "[" + level_str + "] ";
+        if (lvl == Level::Error)
+            godot::UtilityFunctions::printerr(godot::String(line.c_str()));
         else
-            s_msgHeaderStr = std::string("[") + level_str + "] ";
+            godot::UtilityFunctions::push_warning(godot::String(line.c_str()));
+    }
 
-        const std::string line = s_msgHeaderStr + std::string(msg);
+    static void write_record(const Record &record, std::string &r_pending)
+    {
+        const std::string line = format_line(record);
+        print_console(record.level, line, r_pending);
 
-        switch (lvl)
+        if (!s_isSetup || s_fileClosed)
+            return;
+
+        s_file << line << '\n';
+    }
+
+    static bool try_enqueue(Record &record)
+    {
+        size_t pos = s_enqueuePos.load(std::memory_order_relaxed);
+        while (true)
         {
-            case Level::Error:
-                godot::UtilityFunctions::printerr(godot::String(line.c_str()));
-                break;
-            case Level::Warn:
-                godot::UtilityFunctions::push_warning(godot::String(line.c_str()));
-                break;
-            default:
-                godot::UtilityFunctions::print(godot::String(line.c_str()));
+            Slot &slot = s_ring[pos & RING_MASK];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+            if (difference == 0)
+            {
+                if (s_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.record = std::move(record);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The writer hasn't freed this slot yet, the ring is full.
+                return false;
+            }
+            else
+            {
+                pos = s_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static bool try_dequeue(Record &r_record)
+    {
+        const size_t pos = s_dequeuePos.load(std::memory_order_relaxed);
+        Slot &slot = s_ring[pos & RING_MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+            return false;
+
+        r_record = std::move(slot.record);
+        slot.sequence.store(pos + RING_SIZE, std::memory_order_release);
+        s_dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    static void run_writer()
+    {
+        Record record;
+        std::string pending;
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> writeLock(s_writeMutex);
+            size_t written = 0;
+            while (try_dequeue(record))
+            {
+                write_record(record, pending);
+                written++;
+            }
+
+            const size_t dropped = s_dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
+            {
+                Record notice{ Level::Warn, std::chrono::system_clock::now(),
+                               std::to_string(dropped) + " log line(s) dropped, the log queue was full." };
+                write_record(notice, pending);
+                written++;
+            }
+
+            if (written > 0)
+            {
+                if (!pending.empty())
+                {
+                    godot::UtilityFunctions::print(godot::String(pending.c_str()));
+                    pending.clear();
+                }
+
+                // One flush per batch instead of per line.
+                if (s_file.is_open())
+                    s_file.flush();
+
+                s_writtenPos.store(s_dequeuePos.load(std::memory_order_relaxed), std::memory_order_release);
+                continue;
+            }
+            writeLock.unlock();
+
+            std::unique_lock<std::mutex> lock(s_wakeMutex);
+            if (s_stopWriter)
                 break;
+
+            // Producers don't take the mutex, so a wake-up can be missed; the timeout bounds how late that makes a line.
+            s_wake.wait_for(lock, std::chrono::milliseconds(5));
         }
+    }
+
+    static void start_writer()
+    {
+        for (size_t i = 0; i < RING_SIZE; i++)
+            s_ring[i].sequence.store(i, std::memory_order_relaxed);
+        s_enqueuePos.store(0, std::memory_order_relaxed);
+        s_dequeuePos.store(0, std::memory_order_relaxed);
+        s_writtenPos.store(0, std::memory_order_relaxed);
+
+        s_stopWriter = false;
+        s_writer = std::thread(run_writer);
+        s_isWriterRunning.store(true, std::memory_order_release);
+    }
 
-        // Always write to godot but only to file when actually ready for that
-        if (lvl > s_logLevel)
+    static void stop_writer()
+    {
+        if (!s_isWriterRunning.exchange(false, std::memory_order_seq_cst))
             return;
 
-        if (!s_isSetup || s_fileClosed)
+        // Producers that saw the writer running finish enqueuing, those arriving now write directly. The writer keeps
+        // draining meanwhile, so one waiting on a full ring gets its slot.
+        while (s_producers.load(std::memory_order_seq_cst) != 0)
+            std::this_thread::yield();
+
+        {
+            std::lock_guard<std::mutex> lock(s_wakeMutex);
+            s_stopWriter = true;
+        }
+
+        // The writer drains the ring before it checks the stop flag.
+        s_wake.notify_one();
+        s_writer.join();
+    }
+
+    // Callers have checked the level.
+    static void log_line(Level lvl, std::string &&msg)
+    {
+        Record record{ lvl, std::chrono::system_clock::now(), std::move(msg) };
+
+        // Counted before the check, so stop_writer either sees this producer or this producer sees it stopping.
+        s_producers.fetch_add(1, std::memory_order_seq_cst);
+        if (!s_isWriterRunning.load(std::memory_order_seq_cst))
+        {
+            s_producers.fetch_sub(1, std::memory_order_release);
+
+            std::lock_guard<std::mutex> lock(s_writeMutex);
+            std::string pending;
+            write_record(record, pending);
+            if (!pending.empty())
+                godot::UtilityFunctions::print(godot::String(pending.c_str()));
+            if (s_file.is_open())
+                s_file.flush();
             return;
+        }
 
-        s_file << line << '\n';
-        s_file.flush();
+        const bool mayDrop = s_overflow.load(std::memory_order_relaxed) == Overflow::Drop && lvl != Level::Error && lvl != Level::Warn;
+        while (!try_enqueue(record))
+        {
+            if (mayDrop)
+            {
+                s_dropped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            s_wake.notify_one();
+            std::this_thread::yield();
+        }
+
+        s_producers.fetch_sub(1, std::memory_order_release);
+        s_wake.notify_one();
     }
 
-    void info(std::string_view msg) { log_line(Level::Info, msg); }
-    void warn(std::string_view msg) { log_line(Level::Warn, msg); }
-    void error(std::string_view msg) { log_line(Level::Error, msg); }
-    void debug(std::string_view msg) { log_line(Level::Debug, msg); }
+    static void log_view(Level lvl, std::string_view msg)
+    {
+        if (is_enabled(lvl))
+            log_line(lvl, std::string(msg));
+    }
+
+    void write_line(Level lvl, std::string &&line) { log_line(lvl, std::move(line)); }
+
+    void info(std::string_view msg) { log_view(Level::Info, msg); }
+    void warn(std::string_view msg) { log_view(Level::Warn, msg); }
+    void error(std::string_view msg) { log_view(Level::Error, msg); }
+    void debug(std::string_view msg) { log_view(Level::Debug, msg); }
 
     Line::~Line() noexcept
     {
         if (!active)
             return;
-        const std::string s = oss.str();
+        std::string s = oss.str();
         if (!s.empty())
-            log_line(level, s);
+            log_line(level, std::move(s));
     }
 
     Line info() { return Line(Level::Info); }
@@ -159,12 +398,13 @@ namespace Tools::Log
 
     static void log_compile_version()
     {
-        Tools::Log::debug() << "C++ version: "
-                            << std::string("C++ __cplusplus=") + std::to_string((long long)__cplusplus)
 #if defined(_MSVC_LANG)
-                                       + " _MSVC_LANG=" + std::to_string((long long)_MSVC_LANG)
+        VOXEL_LOG_DEBUG("C++ version: C++ __cplusplus={} _MSVC_LANG={}", (long long)__cplusplus, (long long)_MSVC_LANG);
+#else
+        VOXEL_LOG_DEBUG("C++ version: C++ __cplusplus={}", (long long)__cplusplus);
 #endif
-                ;
+        VOXEL_LOG_DEBUG("Compiled log level: {}.", VOXEL_LOG_LEVEL);
+        VOXEL_LOG_DEBUG("Log overflow policy: {}.", s_overflow.load(std::memory_order_relaxed) == Overflow::Drop ? "drop" : "block");
     }
 
     void begin(const char *application_name,
@@ -179,7 +419,7 @@ namespace Tools::Log
 
         s_pAPPLICATION_NAME = application_name;
         s_useTimestamp = use_timestamp;
-        s_logLevel = logging_level;
+        set_level(logging_level);
 
         s_applicationPathRoot = std::filesystem::u8path(application_path_root_utf8);
 
@@ -187,14 +427,34 @@ namespace Tools::Log
         s_isSetup = true;
         create_log_file();
 
+        start_writer();
+
         if (s_useTimestamp)
             info("Timestamps are enabled recorded as YYYY-MM-DD HH:MM:SS in UTC time.");
 
         log_compile_version();
     }
 
+    void set_overflow(Overflow overflow) { s_overflow.store(overflow, std::memory_order_relaxed); }
+
+    void flush()
+    {
+        if (!s_isWriterRunning.load(std::memory_order_acquire))
+            return;
+
+        const size_t target = s_enqueuePos.load(std::memory_order_acquire);
+        while (s_writtenPos.load(std::memory_order_acquire) < target)
+        {
+            s_wake.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
     void end()
     {
+        stop_writer();
+
+        std::lock_guard<std::mutex> lock(s_writeMutex);
         if (!s_isSetup || s_fileClosed)
             return;
         s_file.close();
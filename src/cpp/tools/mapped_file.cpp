@@ -0,0 +1,231 @@
+#include "hpp/tools/mapped_file.hpp"
+#include "hpp/tools/log.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Tools
+{
+    // Smallest growth step, so a new file doesn't remap on every early append.
+    static constexpr size_t MIN_GROWTH = 256 * 1024;
+
+#if defined(_WIN32)
+    bool MappedFile::open(const std::string &p_path)
+    {
+        close();
+
+        HANDLE file = CreateFileA(p_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            VOXEL_LOG_ERROR("Failed to open {} (error {}).", p_path, GetLastError());
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+
+        m_file = file;
+        m_size = static_cast<size_t>(size.QuadPart);
+        return map();
+    }
+
+    void MappedFile::close()
+    {
+        unmap();
+
+        if (m_file)
+        {
+            CloseHandle(static_cast<HANDLE>(m_file));
+            m_file = nullptr;
+        }
+
+        m_size = 0;
+    }
+
+    bool MappedFile::is_open() const
+    {
+        return m_file != nullptr;
+    }
+
+    bool MappedFile::map()
+    {
+        if (m_size == 0)
+            return true;
+
+        HANDLE mapping = CreateFileMappingA(static_cast<HANDLE>(m_file), nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+            return false;
+
+        m_mapping = mapping;
+        m_pData = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        return m_pData != nullptr;
+    }
+
+    void MappedFile::unmap()
+    {
+        if (m_pData)
+        {
+            UnmapViewOfFile(m_pData);
+            m_pData = nullptr;
+        }
+
+        if (m_mapping)
+        {
+            CloseHandle(static_cast<HANDLE>(m_mapping));
+            m_mapping = nullptr;
+        }
+    }
+
+    bool MappedFile::resize(size_t p_size)
+    {
+        unmap();
+
+        LARGE_INTEGER position;
+        position.QuadPart = static_cast<LONGLONG>(p_size);
+        if (!SetFilePointerEx(static_cast<HANDLE>(m_file), position, nullptr, FILE_BEGIN) ||
+            !SetEndOfFile(static_cast<HANDLE>(m_file)))
+        {
+            map();
+            return false;
+        }
+
+        m_size = p_size;
+        return map();
+    }
+
+    bool MappedFile::write(size_t p_offset, const void *p_data, size_t p_length)
+    {
+        if (p_offset + p_length > m_size && !resize(std::max({ p_offset + p_length, m_size + m_size / 2, MIN_GROWTH })))
+            return false;
+
+        const uint8_t *pBytes = static_cast<const uint8_t *>(p_data);
+        while (p_length > 0)
+        {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(p_offset & 0xFFFFFFFFull);
+            overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(p_offset) >> 32);
+
+            const DWORD request = static_cast<DWORD>(std::min<size_t>(p_length, 1u << 30));
+            DWORD written = 0;
+            if (!WriteFile(static_cast<HANDLE>(m_file), pBytes, request, &written, &overlapped) || written == 0)
+                return false;
+
+            pBytes += written;
+            p_offset += written;
+            p_length -= written;
+        }
+
+        return true;
+    }
+#else
+    bool MappedFile::open(const std::string &p_path)
+    {
+        close();
+
+        const int fd = ::open(p_path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+        {
+            VOXEL_LOG_ERROR("Failed to open {}.", p_path);
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        m_fd = fd;
+        m_size = static_cast<size_t>(info.st_size);
+        return map();
+    }
+
+    void MappedFile::close()
+    {
+        unmap();
+
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+
+        m_size = 0;
+    }
+
+    bool MappedFile::is_open() const
+    {
+        return m_fd >= 0;
+    }
+
+    bool MappedFile::map()
+    {
+        if (m_size == 0)
+            return true;
+
+        void *pData = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (pData == MAP_FAILED)
+            return false;
+
+        m_pData = static_cast<const uint8_t *>(pData);
+        return true;
+    }
+
+    void MappedFile::unmap()
+    {
+        if (!m_pData)
+            return;
+
+        munmap(const_cast<uint8_t *>(m_pData), m_size);
+        m_pData = nullptr;
+    }
+
+    bool MappedFile::resize(size_t p_size)
+    {
+        unmap();
+
+        if (ftruncate(m_fd, static_cast<off_t>(p_size)) != 0)
+        {
+            map();
+            return false;
+        }
+
+        m_size = p_size;
+        return map();
+    }
+
+    bool MappedFile::write(size_t p_offset, const void *p_data, size_t p_length)
+    {
+        if (p_offset + p_length > m_size && !resize(std::max({ p_offset + p_length, m_size + m_size / 2, MIN_GROWTH })))
+            return false;
+
+        const uint8_t *pBytes = static_cast<const uint8_t *>(p_data);
+        while (p_length > 0)
+        {
+            const ssize_t written = pwrite(m_fd, pBytes, p_length, static_cast<off_t>(p_offset));
+            if (written <= 0)
+                return false;
+
+            pBytes += written;
+            p_offset += static_cast<size_t>(written);
+            p_length -= static_cast<size_t>(written);
+        }
+
+        return true;
+    }
+#endif
+} //namespace Tools
@@ -0,0 +1,244 @@
+#include "hpp/tools/trace.hpp"
+#include "hpp/tools/format.hpp"
+#include "hpp/tools/log.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Tools::Trace
+{
+    // Past this a thread's events are counted but not kept, about 6 MiB per thread.
+    static constexpr size_t MAX_EVENTS_PER_THREAD = 1 << 18;
+
+    struct Event
+    {
+        const char *pNAME;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+    struct Total
+    {
+        uint64_t ns = 0;
+        uint32_t count = 0;
+    };
+
+    // The owning thread appends, end_frame and export read. The mutex is only ever contended during those.
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        uint32_t threadId = 0;
+        std::string name;
+        std::vector<Event> events;
+        size_t dropped = 0;
+        std::unordered_map<const char *, Total> totals;
+    };
+
+    static const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+    // Buffers outlive their threads, so events of a finished worker can still be exported.
+    static std::mutex s_buffersMutex;
+    static std::vector<std::shared_ptr<ThreadBuffer>> s_buffers;
+    static uint32_t s_nextThreadId = 1;
+
+    static std::mutex s_frameMutex;
+    static std::unordered_map<std::string, Total> s_frameTotals;
+
+    static ThreadBuffer &get_thread_buffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> s_threadBuffer;
+        if (!s_threadBuffer)
+        {
+            s_threadBuffer = std::make_shared<ThreadBuffer>();
+
+            std::lock_guard<std::mutex> lock(s_buffersMutex);
+            s_threadBuffer->threadId = s_nextThreadId++;
+            s_buffers.emplace_back(s_threadBuffer);
+        }
+
+        return *s_threadBuffer;
+    }
+
+    void set_enabled(bool enabled)
+    {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+        if (enabled)
+            return;
+
+        std::lock_guard<std::mutex> lock(s_frameMutex);
+        s_frameTotals.clear();
+    }
+
+    uint64_t now_ns()
+    {
+        return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_epoch).count());
+    }
+
+    void record(const char *pNAME, uint64_t start_ns, uint64_t end_ns)
+    {
+        ThreadBuffer &buffer = get_thread_buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+
+        if (buffer.events.size() < MAX_EVENTS_PER_THREAD)
+            buffer.events.push_back({ pNAME, start_ns, end_ns });
+        else
+            buffer.dropped++;
+
+        Total &total = buffer.totals[pNAME];
+        total.ns += end_ns - start_ns;
+        total.count++;
+    }
+
+    void set_thread_name(const char *pNAME)
+    {
+        ThreadBuffer &buffer = get_thread_buffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = pNAME;
+    }
+
+    void end_frame()
+    {
+        std::unordered_map<std::string, Total> frame;
+        {
+            std::lock_guard<std::mutex> lock(s_buffersMutex);
+            for (const auto &pBuffer : s_buffers)
+            {
+                std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+                for (const auto &kvp : pBuffer->totals)
+                {
+                    Total &total = frame[kvp.first];
+                    total.ns += kvp.second.ns;
+                    total.count += kvp.second.count;
+                }
+                pBuffer->totals.clear();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(s_frameMutex);
+        s_frameTotals.swap(frame);
+    }
+
+    double get_frame_msec(std::string_view name)
+    {
+        std::lock_guard<std::mutex> lock(s_frameMutex);
+        auto iterator = s_frameTotals.find(std::string(name));
+        return iterator != s_frameTotals.end() ? static_cast<double>(iterator->second.ns) / 1e6 : 0.0;
+    }
+
+    uint32_t get_frame_count(std::string_view name)
+    {
+        std::lock_guard<std::mutex> lock(s_frameMutex);
+        auto iterator = s_frameTotals.find(std::string(name));
+        return iterator != s_frameTotals.end() ? iterator->second.count : 0;
+    }
+
+    size_t get_event_count()
+    {
+        size_t count = 0;
+
+        std::lock_guard<std::mutex> lock(s_buffersMutex);
+        for (const auto &pBuffer : s_buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+            count += pBuffer->events.size();
+        }
+
+        return count;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(s_buffersMutex);
+        for (const auto &pBuffer : s_buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+            pBuffer->events.clear();
+            pBuffer->dropped = 0;
+        }
+    }
+
+    static void append_json_string(std::string &r_out, std::string_view p_text)
+    {
+        r_out.push_back('"');
+        for (char c : p_text)
+        {
+            if (c == '"' || c == '\\')
+                r_out.push_back('\\');
+            r_out.push_back(c);
+        }
+        r_out.push_back('"');
+    }
+
+    // Chrome takes microseconds, kept to the nanosecond as a fraction.
+    static void append_microseconds(std::string &r_out, uint64_t p_ns)
+    {
+        Format::format_to(r_out, "{}.", p_ns / 1000);
+        const uint64_t fraction = p_ns % 1000;
+        if (fraction < 100)
+            r_out.push_back('0');
+        if (fraction < 10)
+            r_out.push_back('0');
+        Format::append(r_out, fraction);
+    }
+
+    bool write_chrome_json(const std::string &utf8_path)
+    {
+        std::ofstream file(std::filesystem::u8path(utf8_path), std::ios::out | std::ios::trunc);
+        if (!file)
+        {
+            VOXEL_LOG_ERROR("Failed to open {} for the trace.", utf8_path);
+            return false;
+        }
+
+        std::string line;
+        size_t dropped = 0;
+        bool first = true;
+
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+        std::lock_guard<std::mutex> lock(s_buffersMutex);
+        for (const auto &pBuffer : s_buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+            dropped += pBuffer->dropped;
+
+            if (!pBuffer->name.empty())
+            {
+                line.clear();
+                Format::format_to(line, "{}\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{\"name\":",
+                                  first ? "" : ",", pBuffer->threadId);
+                append_json_string(line, pBuffer->name);
+                line.append("}}");
+                file << line;
+                first = false;
+            }
+
+            for (const Event &event : pBuffer->events)
+            {
+                line.clear();
+                Format::format_to(line, "{}\n{\"name\":", first ? "" : ",");
+                append_json_string(line, event.pNAME);
+                line.append(",\"ph\":\"X\",\"ts\":");
+                append_microseconds(line, event.startNs);
+                line.append(",\"dur\":");
+                append_microseconds(line, event.endNs - event.startNs);
+                Format::format_to(line, ",\"pid\":1,\"tid\":{}}", pBuffer->threadId);
+                file << line;
+                first = false;
+            }
+        }
+
+        file << "\n]}\n";
+
+        if (dropped > 0)
+            VOXEL_LOG_WARN("The trace is missing {} zone(s), their threads' buffers were full.", dropped);
+
+        return static_cast<bool>(file);
+    }
+} //namespace Tools::Trace
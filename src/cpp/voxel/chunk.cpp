@@ -1,37 +1,32 @@
 #include "hpp/voxel/chunk.hpp"
-#include "godot_cpp/classes/random_number_generator.hpp"
-#include "hpp/tools/log_stream.hpp"
-#include "hpp/tools/string.hpp"
+#include "hpp/tools/log.hpp"
+#include "hpp/tools/trace.hpp"
 #include "hpp/voxel/block.hpp"
+#include "hpp/voxel/chunk_codec.hpp"
+#include "hpp/voxel/chunk_collider.hpp"
+#include "hpp/voxel/chunk_io.hpp"
 #include "hpp/voxel/chunk_mesher.hpp"
 #include "hpp/voxel/constants.hpp"
+#include "hpp/voxel/core/terrain_generator.hpp"
 #include "hpp/voxel/world.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <godot_cpp/classes/mesh.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/standard_material3d.hpp>
 #include <godot_cpp/classes/world3d.hpp>
-#include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/aabb.hpp>
 #include <godot_cpp/variant/array.hpp>
 #include <godot_cpp/variant/color.hpp>
+#include <utility>
+#include <vector>
 
 using namespace godot;
 using namespace Voxel::Resource;
 
-#define DEBUG_VERBOSE
-
 namespace Voxel
 {
-    void Chunk::_ready()
-    {
-        set_notify_transform(true);
-        initialize_block_data();
-        ensure_instance();
-        sync_instance_transform();
-    }
-
-    void Chunk::_exit_tree()
+    Chunk::~Chunk()
     {
         RenderingServer *pRenderingServer = RenderingServer::get_singleton();
 
@@ -42,12 +37,11 @@ namespace Voxel
         }
     }
 
-    void Chunk::_notification(int p_what)
+    void Chunk::initialize()
     {
-        if (p_what == NOTIFICATION_TRANSFORM_CHANGED)
-        {
-            sync_instance_transform();
-        }
+        initialize_block_data();
+        ensure_instance();
+        sync_instance_transform(m_pWorld->get_global_transform());
     }
 
     void Chunk::ensure_instance()
@@ -61,7 +55,7 @@ namespace Voxel
         if (!pRenderingServer)
             return;
 
-        Ref<World3D> world = get_world_3d();
+        Ref<World3D> world = m_pWorld->get_world_3d();
         if (world.is_null())
             return;
 
@@ -76,14 +70,9 @@ namespace Voxel
 
     void Chunk::initialize_block_data()
     {
-        m_pBlocks = std::make_unique<Block *[]>(CHUNK_BLOCK_COUNT_MAX);
-
-        for (uint32_t i{}; i < CHUNK_BLOCK_COUNT_MAX; i++)
-        {
-            auto block = new Block();
-            block->set_solid(false);
-            m_pBlocks[i] = block;
-        }
+        // Blocks are stored by value in one allocation so edits and generation can write whole spans.
+        m_pBlocks = std::make_unique<Block[]>(CHUNK_BLOCK_COUNT_MAX);
+        m_pLight = std::make_unique<uint8_t[]>(CHUNK_BLOCK_COUNT_MAX);
 
         ChunkMesher::create_mesh(this);
     }
@@ -95,13 +84,15 @@ namespace Voxel
         constexpr int L = static_cast<int>(CHUNK_AXIS_LENGTH_U);
 
         m_chunk_pos = godot::Vector2i(x / L, z / L);
-        set_position(godot::Vector3i(x, 0, z));
-        Tools::Log::debug() << "Set chunk " << this << " to " << Tools::String::to_string(m_chunk_pos)
-                            << " in world " << pWorld << ".";
+        m_origin = godot::Vector3i(x, 0, z);
+        VOXEL_LOG_DEBUG("Set chunk {} to {} in world {}.", this, m_chunk_pos, pWorld);
     }
 
-    void Chunk::sync_instance_transform()
+    void Chunk::sync_instance_transform(const godot::Transform3D &p_worldTransform)
     {
+        if (m_pCollider)
+            m_pCollider->sync_transform(p_worldTransform);
+
         if (!m_instanceRID.is_valid())
             return;
 
@@ -109,109 +100,308 @@ namespace Voxel
         if (!rs)
             return;
 
-        rs->instance_set_transform(m_instanceRID, get_global_transform());
+        rs->instance_set_transform(m_instanceRID, p_worldTransform * Transform3D(Basis(), get_origin()));
     }
 
-    const Block *Chunk::get_block_at(godot::Vector3 p_pos)
+    const Block *Chunk::get_block_at(godot::Vector3 p_pos) const
     {
         return get_block_at(p_pos.x, p_pos.y, p_pos.z);
     }
 
-    const Block *Chunk::get_block_at(uint32_t x, uint32_t y, uint32_t z)
+    const Block *Chunk::get_block_at(uint32_t x, uint32_t y, uint32_t z) const
     {
         if (!m_pBlocks)
         {
-            Tools::Log::error() << "Attempted to access block at "
-                                << Tools::String::xyz_to_string(x, y, z)
-                                << " but the chunk's block data wasn't initialized.";
+            VOXEL_LOG_ERROR("Attempted to access block at ({}, {}, {}) but the chunk's block data wasn't initialized.",
+                            x, y, z);
+        }
+
+        return &m_pBlocks[get_block_index_local(x, y, z)];
+    }
+
+    void Chunk::fill_span(uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, const Block &p_block)
+    {
+        // Rows along x are only contiguous in the linear layout, see Core::get_block_index.
+        for (uint32_t x = x0; x <= x1; x++)
+            m_pBlocks[get_block_index_local(x, y, z)] = p_block;
+
+        if (p_block.is_solid())
+            mark_section_solid(y / SECTION_AXIS_LENGTH_U);
+
+        if (m_pWorld->get_tick_scheduler().is_tickable(&p_block))
+        {
+            for (uint32_t x = x0; x <= x1; x++)
+                update_tickable(x, y, z);
+        }
+    }
+
+    uint32_t Chunk::replace_span(uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, const Block &p_from, const Block &p_to)
+    {
+        const bool tickable = m_pWorld->get_tick_scheduler().is_tickable(&p_to);
+
+        if (p_to.is_solid())
+            mark_section_solid(y / SECTION_AXIS_LENGTH_U);
+
+        uint32_t count = 0;
+        for (uint32_t x = x0; x <= x1; x++)
+        {
+            Block &block = m_pBlocks[get_block_index_local(x, y, z)];
+            if (block != p_from)
+                continue;
+
+            block = p_to;
+            count++;
+
+            if (tickable)
+                update_tickable(x, y, z);
+        }
+
+        return count;
+    }
+
+    void Chunk::write_span(uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, const Block *p_blocks)
+    {
+        const uint32_t count = x1 - x0 + 1;
+        for (uint32_t i = 0; i < count; i++)
+            m_pBlocks[get_block_index_local(x0 + i, y, z)] = p_blocks[i];
+
+        const TickScheduler &ticks = m_pWorld->get_tick_scheduler();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (p_blocks[i].is_solid())
+                mark_section_solid(y / SECTION_AXIS_LENGTH_U);
+
+            if (ticks.is_tickable(&p_blocks[i]))
+                update_tickable(x0 + i, y, z);
         }
+    }
 
-        return m_pBlocks[get_block_index_local(x, y, z)];
+    uint32_t Chunk::generate_into(Block *r_blocks) const
+    {
+        return Core::TerrainGenerator::generate(m_generation, m_chunk_pos.x, m_chunk_pos.y, r_blocks);
+    }
+
+    void Chunk::adopt_generation()
+    {
+        m_generation = m_pWorld->get_generation_params();
+        m_generationHash = m_pWorld->get_generation_hash();
+    }
+
+    Core::ChunkView Chunk::get_view() const
+    {
+        Core::ChunkView view;
+        view.pBlocks = m_pBlocks.get();
+        view.pLight = m_pLight.get();
+        view.pFluid = m_pFluid.get();
+
+        const Chunk *neighbors[Core::ChunkView::SIDE_COUNT] = { m_neighbors.pos_x, m_neighbors.neg_x, m_neighbors.pos_z,
+                                                                 m_neighbors.neg_z };
+        for (int side = 0; side < Core::ChunkView::SIDE_COUNT; side++)
+        {
+            if (!neighbors[side])
+                continue;
+
+            view.pNeighborBlocks[side] = neighbors[side]->m_pBlocks.get();
+            view.pNeighborLight[side] = neighbors[side]->m_pLight.get();
+            view.pNeighborFluid[side] = neighbors[side]->m_pFluid.get();
+        }
+
+        return view;
     }
 
     void Chunk::generate_blocks()
     {
-        const uint32_t XZ = CHUNK_AXIS_LENGTH_U;
-        const uint32_t Y = CHUNK_HEIGHT_U;
+        VOXEL_TRACE_ZONE("Chunk::generate_blocks");
+        adopt_generation();
+        m_pFluid.reset();
+        m_solidSectionMask = generate_into(m_pBlocks.get());
 
-        auto rng = m_pWorld->get_generation_rng();
-        auto settings = m_pWorld->get_settings();
-        auto sea_level = settings->get_sea_level();
+        // Edit overlays are relative to exactly these blocks, only a full save has to store them.
+        m_isModified = m_pWorld->get_save_mode() == World::SAVE_FULL;
+
+        VOXEL_LOG_DEBUG("(Re)generated blocks for chunk at {}.", m_chunk_pos);
+
+        finish_blocks();
+    }
 
-        for (int y = 0; y < Y; y++)
+    bool Chunk::load_blocks(const uint8_t *p_data, size_t p_size)
+    {
+        VOXEL_TRACE_ZONE("Chunk::load_blocks");
+        adopt_generation();
+        if (ChunkCodec::is_overlay(p_data, p_size))
         {
-            for (int z = 0; z < XZ; z++)
+            uint64_t generationHash;
+            if (!ChunkCodec::read_generation_hash(p_data, p_size, generationHash) || generationHash != m_generationHash)
             {
-                for (int x = 0; x < XZ; x++)
-                {
-                    // 1 / belowSeaLevel solid vs air at/below sea level, 1 / aboveSeaLevel above
-                    const int belowSeaLevel = 5;
-                    const int aboveSeaLevel = 100;
-                    auto block = new Block();
-                    bool solid = rng->randi_range(1, y < sea_level ? belowSeaLevel : aboveSeaLevel) == 1;
-
-                    if (solid)
-                    {
-                        // 0 is for unknown only
-                        auto index = rng->randi_range(1, Pallet::TYPE_COUNT - 1);
-                        block->set_material_type(static_cast<Pallet::MaterialType>(index));
-                        block->set_solid(solid);
-                        block->set_texture(static_cast<Pallet::BlockTexture>(index));
-                    }
-
-                    m_pBlocks[get_block_index_local(x, y, z)] = block;
-                }
+                // Left on disk untouched, until the chunk is edited again, in case the settings are changed back.
+                VOXEL_LOG_WARN("Saved edits for chunk {} were made with different generation settings, ignoring them.",
+                               m_chunk_pos);
+                return false;
             }
+
+            generate_into(m_pBlocks.get());
+        }
+
+        m_pFluid.reset();
+        if (!ChunkCodec::decode(this, p_data, p_size))
+            return false;
+
+        finish_load();
+        return true;
+    }
+
+    void Chunk::finish_load()
+    {
+        // Replicated chunks are filled without load_blocks.
+        adopt_generation();
+        m_solidSectionMask = 0;
+        for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; section++)
+        {
+            const Block *pFirst = &m_pBlocks[static_cast<size_t>(section) * SECTION_BLOCK_COUNT];
+            if (std::any_of(pFirst, pFirst + SECTION_BLOCK_COUNT, [](const Block &p_block)
+                            { return p_block.is_solid(); }))
+                mark_section_solid(section);
         }
 
-        Tools::Log::debug() << "(Re)generated blocks for chunk at " << Tools::String::to_string(m_chunk_pos) << ".";
+        m_isModified = false;
+
+        VOXEL_LOG_DEBUG("Loaded blocks for chunk at {}.", m_chunk_pos);
+
+        finish_blocks();
+    }
+
+    void Chunk::set_fluid(size_t p_index, uint8_t p_fluid)
+    {
+        if (!m_pFluid)
+        {
+            if (p_fluid == Core::Fluid::NONE)
+                return;
+
+            m_pFluid = std::make_unique<uint8_t[]>(CHUNK_BLOCK_COUNT_MAX);
+        }
+
+        m_pFluid[p_index] = p_fluid;
+    }
+
+    uint8_t *Chunk::allocate_fluid_data()
+    {
+        if (!m_pFluid)
+            m_pFluid = std::make_unique<uint8_t[]>(CHUNK_BLOCK_COUNT_MAX);
+
+        return m_pFluid.get();
+    }
+
+    void Chunk::finish_blocks()
+    {
+        m_contentVersion = m_pWorld->next_content_version();
+        rebuild_tickable_sections();
+        m_pWorld->get_fluid_simulator().on_chunk_replaced(this);
+        mark_collision_dirty(ChunkCollider::ALL_SECTIONS);
+
+        // Light spilling into the neighbors dirties their sections, the edit queues those remeshes.
+        m_pWorld->begin_edit();
+        m_pWorld->get_light_engine().light_chunk(m_pWorld, this);
+        m_pWorld->commit_edit();
 
         ChunkMesher::mesh_queue(this);
         remesh_neighbors();
     }
 
-    Chunk::Neighbors Chunk::get_neighbors()
+    void Chunk::update_tickable(uint32_t x, uint32_t y, uint32_t z)
+    {
+        const TickScheduler &ticks = m_pWorld->get_tick_scheduler();
+        if (!ticks.is_tickable(get_block_at(x, y, z)))
+            return;
+
+        // Only additions happen here, the scheduler drops entries that stopped being tickable when it reaches them.
+        const uint32_t section = y / SECTION_AXIS_LENGTH_U;
+        const size_t local = get_block_index_local(x, y, z) - static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+
+        m_sections[section].add_tickable(static_cast<uint16_t>(local));
+        set_section_tickable(section, true);
+    }
+
+    void Chunk::rebuild_tickable_sections()
     {
-        auto pos_x = Vector2i(m_chunk_pos.x + 1, m_chunk_pos.y);
-        auto neg_x = Vector2i(m_chunk_pos.x - 1, m_chunk_pos.y);
-        auto pos_z = Vector2i(m_chunk_pos.x, m_chunk_pos.y + 1);
-        auto neg_z = Vector2i(m_chunk_pos.x, m_chunk_pos.y - 1);
+        for (ChunkSection &section : m_sections)
+            section.clear_tickable();
+
+        m_tickableSectionMask = 0;
 
-#ifdef DEBUG_VERBOSE
-        Tools::Log::debug() << "Getting neighbors for chunk " << Tools::String::to_string(m_chunk_pos) << " at "
-                            << Tools::String::to_string(pos_x) << ", " << Tools::String::to_string(neg_x) << ", "
-                            << Tools::String::to_string(pos_z) << ", and " << Tools::String::to_string(neg_z) << ".";
-#endif
+        const TickScheduler &ticks = m_pWorld->get_tick_scheduler();
+        if (!ticks.has_random_tick_handlers())
+            return;
 
-        Chunk::Neighbors neighbors{};
-        neighbors.pos_x = m_pWorld->try_get_chunk(pos_x);
-        neighbors.neg_x = m_pWorld->try_get_chunk(neg_x);
-        neighbors.pos_z = m_pWorld->try_get_chunk(pos_z);
-        neighbors.neg_z = m_pWorld->try_get_chunk(neg_z);
+        for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; section++)
+        {
+            const size_t base = static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+            for (uint32_t local = 0; local < SECTION_BLOCK_COUNT; local++)
+            {
+                if (ticks.is_tickable(&m_pBlocks[base + local]))
+                    m_sections[section].add_tickable(static_cast<uint16_t>(local));
+            }
 
-        return neighbors;
+            set_section_tickable(section, !m_sections[section].tickable.empty());
+        }
     }
 
     void Chunk::remesh_neighbors()
     {
-        auto neighbors = get_neighbors();
+        const Neighbors &neighbors = get_neighbors();
 
-        if (neighbors.pos_x)
-            ChunkMesher::mesh_queue(neighbors.pos_x);
+        // Border faces of the neighbors depend on this chunk, for collision as much as for rendering.
+        for (Chunk *pNeighbor : { neighbors.pos_x, neighbors.neg_x, neighbors.pos_z, neighbors.neg_z })
+        {
+            if (!pNeighbor)
+                continue;
 
-        if (neighbors.neg_x)
-            ChunkMesher::mesh_queue(neighbors.neg_x);
+            ChunkMesher::mesh_queue(pNeighbor);
+            pNeighbor->mark_collision_dirty(ChunkCollider::ALL_SECTIONS);
+        }
+    }
 
-        if (neighbors.pos_z)
-            ChunkMesher::mesh_queue(neighbors.pos_z);
+    void Chunk::enable_collision()
+    {
+        if (!m_pCollider)
+            m_pCollider = std::make_unique<ChunkCollider>(this);
+    }
+
+    void Chunk::disable_collision()
+    {
+        m_pCollider.reset();
+    }
+
+    bool Chunk::save(ChunkIO &p_io)
+    {
+        if (!m_isModified || !p_io.is_running())
+            return false;
+
+        VOXEL_TRACE_ZONE("Chunk::save");
+
+        // Encoding is a single pass over memory; the region file write happens on the worker.
+        std::vector<uint8_t> bytes;
+        if (m_pWorld->get_save_mode() == World::SAVE_EDITS)
+        {
+            // Regenerated rather than kept per chunk, a baseline copy would double block memory. Main thread only, the
+            // streaming budget charges it as STEP_SAVE_OVERLAY.
+            static std::vector<Block> s_baseline(CHUNK_BLOCK_COUNT_MAX);
+            generate_into(s_baseline.data());
+            ChunkCodec::encode_overlay(this, s_baseline.data(), m_generationHash, bytes);
+        }
+        else
+        {
+            ChunkCodec::encode(this, bytes);
+        }
+        p_io.save(m_chunk_pos, std::move(bytes));
 
-        if (neighbors.neg_z)
-            ChunkMesher::mesh_queue(neighbors.neg_z);
+        m_isModified = false;
+        return true;
     }
 
     void Chunk::unload()
     {
+        save(m_pWorld->get_chunk_io());
         ChunkMesher::on_chunk_unload(this);
-        Tools::Log::debug() << "Chunk " << Tools::String::to_string(m_chunk_pos) << " unloaded!";
+        VOXEL_LOG_DEBUG("Chunk {} unloaded!", m_chunk_pos);
     }
 } //namespace Voxel
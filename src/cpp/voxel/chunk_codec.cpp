@@ -0,0 +1,218 @@
+#include "hpp/voxel/chunk_codec.hpp"
+#include "hpp/tools/log.hpp"
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/constants.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/core/wire_codec.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace Voxel
+{
+    static constexpr uint32_t MAX_RUN = 1u << 16;
+
+    static inline void put_u16(std::vector<uint8_t> &r_bytes, uint32_t p_value)
+    {
+        r_bytes.push_back(static_cast<uint8_t>(p_value & 0xFF));
+        r_bytes.push_back(static_cast<uint8_t>((p_value >> 8) & 0xFF));
+    }
+
+    static inline uint32_t get_u16(const uint8_t *p_bytes)
+    {
+        return static_cast<uint32_t>(p_bytes[0]) | (static_cast<uint32_t>(p_bytes[1]) << 8);
+    }
+
+    // Codec byte and generation hash.
+    static constexpr size_t OVERLAY_HEADER_SIZE = 1 + 8;
+    static constexpr size_t OVERLAY_SECTION_SIZE = 3;
+    static constexpr size_t OVERLAY_RUN_SIZE = 6;
+
+    static bool decode_overlay(Chunk *p_chunk, const uint8_t *p_bytes, size_t p_size)
+    {
+        Block *pBlocks = p_chunk->get_block_data();
+        const uint8_t *pCursor = p_bytes + OVERLAY_HEADER_SIZE;
+        const uint8_t *pEnd = p_bytes + p_size;
+
+        while (pEnd - pCursor >= static_cast<ptrdiff_t>(OVERLAY_SECTION_SIZE))
+        {
+            if (pCursor[0] == Core::WireCodec::FLUID_MARKER)
+                return Core::WireCodec::decode_fluid(pCursor, pEnd, p_chunk->allocate_fluid_data());
+
+            const uint32_t section = pCursor[0];
+            const uint32_t runs = get_u16(pCursor + 1);
+            pCursor += OVERLAY_SECTION_SIZE;
+
+            if (section >= CHUNK_SECTION_COUNT || pEnd - pCursor < static_cast<ptrdiff_t>(runs * OVERLAY_RUN_SIZE))
+                return false;
+
+            Block *pSection = pBlocks + static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+            for (uint32_t run = 0; run < runs; run++, pCursor += OVERLAY_RUN_SIZE)
+            {
+                const uint32_t start = get_u16(pCursor);
+                const uint32_t length = get_u16(pCursor + 2) + 1;
+                const int32_t id = static_cast<int32_t>(get_u16(pCursor + 4));
+
+                if (id >= Block::ID_COUNT || start >= SECTION_BLOCK_COUNT || length > SECTION_BLOCK_COUNT - start)
+                    return false;
+
+                const Block block = Block::from_id(id);
+                for (uint32_t i = start; i < start + length; i++)
+                    pSection[Core::to_storage_local(i)] = block;
+            }
+        }
+
+        return pCursor == pEnd;
+    }
+
+    void ChunkCodec::encode(const Chunk *p_chunk, std::vector<uint8_t> &r_bytes)
+    {
+        r_bytes.clear();
+        r_bytes.push_back(CODEC_RLE16);
+
+        // Runs follow the linear block order whatever the storage layout, so saves load in either.
+        uint32_t index = 0;
+        while (index < CHUNK_BLOCK_COUNT_MAX)
+        {
+            const Block &block = *p_chunk->get_block(Core::to_storage_index(index));
+            const uint32_t end = std::min(index + MAX_RUN, CHUNK_BLOCK_COUNT_MAX);
+
+            uint32_t run = index + 1;
+            while (run < end && *p_chunk->get_block(Core::to_storage_index(run)) == block)
+                run++;
+
+            // Stored as length - 1 so a full 65536 block run fits in 16 bits.
+            put_u16(r_bytes, run - index - 1);
+            put_u16(r_bytes, static_cast<uint32_t>(block.to_id()));
+            index = run;
+        }
+
+        Core::WireCodec::encode_fluid(p_chunk->get_fluid_data(), r_bytes);
+    }
+
+    void ChunkCodec::encode_overlay(const Chunk *p_chunk, const Block *p_baseline, uint64_t p_generationHash,
+                                    std::vector<uint8_t> &r_bytes)
+    {
+        r_bytes.clear();
+        r_bytes.push_back(CODEC_OVERLAY);
+        for (uint32_t byte = 0; byte < 8; byte++)
+            r_bytes.push_back(static_cast<uint8_t>((p_generationHash >> (byte * 8)) & 0xFF));
+
+        for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; section++)
+        {
+            const uint32_t first = section * SECTION_BLOCK_COUNT;
+            const size_t header = r_bytes.size();
+            uint32_t runs = 0;
+
+            uint32_t index = 0;
+            while (index < SECTION_BLOCK_COUNT)
+            {
+                const uint32_t stored = first + Core::to_storage_local(index);
+                const Block &block = *p_chunk->get_block(stored);
+                if (block == p_baseline[stored])
+                {
+                    index++;
+                    continue;
+                }
+
+                // A run is changed blocks that all became the same block, the shape most edits leave behind.
+                uint32_t end = index + 1;
+                while (end < SECTION_BLOCK_COUNT && *p_chunk->get_block(first + Core::to_storage_local(end)) == block &&
+                       p_baseline[first + Core::to_storage_local(end)] != block)
+                    end++;
+
+                if (runs == 0)
+                {
+                    r_bytes.push_back(static_cast<uint8_t>(section));
+                    put_u16(r_bytes, 0);
+                }
+
+                put_u16(r_bytes, index);
+                put_u16(r_bytes, end - index - 1);
+                put_u16(r_bytes, static_cast<uint32_t>(block.to_id()));
+                runs++;
+                index = end;
+            }
+
+            if (runs > 0)
+            {
+                r_bytes[header + 1] = static_cast<uint8_t>(runs & 0xFF);
+                r_bytes[header + 2] = static_cast<uint8_t>((runs >> 8) & 0xFF);
+            }
+        }
+
+        // Generation places no fluid, so all of it is an edit.
+        Core::WireCodec::encode_fluid(p_chunk->get_fluid_data(), r_bytes);
+    }
+
+    bool ChunkCodec::is_overlay(const uint8_t *p_bytes, size_t p_size)
+    {
+        return p_size >= 1 && p_bytes[0] == CODEC_OVERLAY;
+    }
+
+    bool ChunkCodec::read_generation_hash(const uint8_t *p_bytes, size_t p_size, uint64_t &r_hash)
+    {
+        if (!is_overlay(p_bytes, p_size) || p_size < OVERLAY_HEADER_SIZE)
+            return false;
+
+        r_hash = 0;
+        for (uint32_t byte = 0; byte < 8; byte++)
+            r_hash |= static_cast<uint64_t>(p_bytes[1 + byte]) << (byte * 8);
+        return true;
+    }
+
+    bool ChunkCodec::decode(Chunk *p_chunk, const uint8_t *p_bytes, size_t p_size)
+    {
+        if (is_overlay(p_bytes, p_size))
+        {
+            if (p_size < OVERLAY_HEADER_SIZE || !decode_overlay(p_chunk, p_bytes, p_size))
+            {
+                VOXEL_LOG_ERROR("Chunk edit overlay is corrupt.");
+                return false;
+            }
+
+            return true;
+        }
+
+        if (p_size < 1 || p_bytes[0] != CODEC_RLE16)
+        {
+            VOXEL_LOG_ERROR("Chunk payload uses unknown codec {}.", p_size < 1 ? -1 : static_cast<int>(p_bytes[0]));
+            return false;
+        }
+
+        Block *pBlocks = p_chunk->get_block_data();
+        const uint8_t *pCursor = p_bytes + 1;
+        const uint8_t *pEnd = p_bytes + p_size;
+
+        uint32_t index = 0;
+        while (index < CHUNK_BLOCK_COUNT_MAX && pEnd - pCursor >= 4)
+        {
+            const uint32_t length = get_u16(pCursor) + 1;
+            const int32_t id = static_cast<int32_t>(get_u16(pCursor + 2));
+            pCursor += 4;
+
+            if (id >= Block::ID_COUNT || length > CHUNK_BLOCK_COUNT_MAX - index)
+                break;
+
+            const Block block = Block::from_id(id);
+            for (uint32_t i = index; i < index + length; i++)
+                pBlocks[Core::to_storage_index(i)] = block;
+            index += length;
+        }
+
+        if (index != CHUNK_BLOCK_COUNT_MAX)
+        {
+            VOXEL_LOG_ERROR("Chunk payload is corrupt, decoded {} of {} blocks.", index, CHUNK_BLOCK_COUNT_MAX);
+            return false;
+        }
+
+        if (pCursor != pEnd && !Core::WireCodec::decode_fluid(pCursor, pEnd, p_chunk->allocate_fluid_data()))
+        {
+            VOXEL_LOG_ERROR("Chunk payload has corrupt fluid.");
+            return false;
+        }
+
+        return true;
+    }
+} //namespace Voxel
@@ -0,0 +1,109 @@
+#include "hpp/voxel/chunk_collider.hpp"
+#include "hpp/tools/bits.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/chunk_mesher.hpp"
+#include "hpp/voxel/world.hpp"
+#include <cstdint>
+#include <godot_cpp/classes/physics_server3d.hpp>
+#include <godot_cpp/classes/world3d.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+
+using namespace godot;
+
+namespace Voxel
+{
+    ChunkCollider::ChunkCollider(Chunk *p_chunk) : m_pChunk(p_chunk)
+    {
+        for (int32_t &index : m_shapeIndices)
+            index = -1;
+
+        PhysicsServer3D *pPhysicsServer = PhysicsServer3D::get_singleton();
+        Ref<World3D> world = p_chunk->get_world()->get_world_3d();
+        if (!pPhysicsServer || world.is_null())
+            return;
+
+        m_body = pPhysicsServer->body_create();
+        pPhysicsServer->body_set_mode(m_body, PhysicsServer3D::BODY_MODE_STATIC);
+        pPhysicsServer->body_set_space(m_body, world->get_space());
+        sync_transform(p_chunk->get_world()->get_global_transform());
+    }
+
+    ChunkCollider::~ChunkCollider()
+    {
+        PhysicsServer3D *pPhysicsServer = PhysicsServer3D::get_singleton();
+        if (!pPhysicsServer)
+            return;
+
+        // Shapes go first so the body never points at a freed shape.
+        if (m_body.is_valid())
+            pPhysicsServer->body_clear_shapes(m_body);
+
+        for (const RID &shape : m_shapes)
+        {
+            if (shape.is_valid())
+                pPhysicsServer->free_rid(shape);
+        }
+
+        if (m_body.is_valid())
+            pPhysicsServer->free_rid(m_body);
+    }
+
+    void ChunkCollider::sync_transform(const Transform3D &p_transform)
+    {
+        if (!m_body.is_valid())
+            return;
+
+        PhysicsServer3D::get_singleton()->body_set_state(
+                m_body, PhysicsServer3D::BODY_STATE_TRANSFORM,
+                p_transform * Transform3D(Basis(), m_pChunk->get_origin()));
+    }
+
+    size_t ChunkCollider::rebuild_next_section()
+    {
+        if (m_dirtySectionMask == 0)
+            return 0;
+
+        const uint32_t section = Tools::Bits::count_trailing_zeros(m_dirtySectionMask);
+        m_dirtySectionMask &= m_dirtySectionMask - 1;
+
+        if (!m_body.is_valid())
+            return 0;
+
+        PackedVector3Array faces;
+        if (m_pChunk->get_solid_section_mask() & (1u << section))
+            ChunkMesher::build_collision_faces(m_pChunk, section, faces);
+
+        PhysicsServer3D *pPhysicsServer = PhysicsServer3D::get_singleton();
+        int32_t &index = m_shapeIndices[section];
+
+        if (faces.is_empty())
+        {
+            if (index >= 0)
+                pPhysicsServer->body_set_shape_disabled(m_body, index, true);
+
+            return 0;
+        }
+
+        if (!m_shapes[section].is_valid())
+            m_shapes[section] = pPhysicsServer->concave_polygon_shape_create();
+
+        Dictionary data;
+        data["faces"] = faces;
+        data["backface_collision"] = false;
+        pPhysicsServer->shape_set_data(m_shapes[section], data);
+
+        // Shapes are never removed from the body, so the indices handed out here stay valid.
+        if (index < 0)
+        {
+            pPhysicsServer->body_add_shape(m_body, m_shapes[section]);
+            index = m_shapeCount++;
+        }
+        else
+        {
+            pPhysicsServer->body_set_shape_disabled(m_body, index, false);
+        }
+
+        return static_cast<size_t>(faces.size() / 3);
+    }
+} //namespace Voxel
@@ -0,0 +1,86 @@
+#include "hpp/voxel/chunk_grid.hpp"
+#include "hpp/tools/hash.hpp"
+#include "hpp/tools/log.hpp"
+
+namespace Voxel
+{
+    Chunk *ChunkGrid::find_overflow(Chunk::ChunkPos p_pos) const
+    {
+        auto iterator = m_overflow.find(Tools::Hash::chunk_pos(p_pos));
+        return iterator != m_overflow.end() ? iterator->second : nullptr;
+    }
+
+    void ChunkGrid::insert(Chunk *p_chunk)
+    {
+        auto pos = p_chunk->get_pos();
+        Slot &slot = m_slots[slot_index(pos)];
+
+        if (!slot.pChunk)
+        {
+            slot.pos = pos;
+            slot.pChunk = p_chunk;
+        }
+        else
+        {
+            m_overflow.emplace(Tools::Hash::chunk_pos(pos), p_chunk);
+            VOXEL_LOG_DEBUG("Chunk {} collided with loaded chunk {} in the chunk grid and was stored in overflow.", pos, slot.pos);
+        }
+
+        m_count++;
+        link_neighbors(p_chunk);
+    }
+
+    void ChunkGrid::erase(Chunk *p_chunk)
+    {
+        const auto pos = p_chunk->get_pos();
+        Slot &slot = m_slots[slot_index(pos)];
+
+        if (slot.pChunk == p_chunk)
+        {
+            slot.pChunk = nullptr;
+        }
+        else if (m_overflow.erase(Tools::Hash::chunk_pos(pos)) == 0)
+        {
+            return;
+        }
+
+        m_count--;
+        unlink_neighbors(p_chunk);
+    }
+
+    void ChunkGrid::link_neighbors(Chunk *p_chunk)
+    {
+        const auto pos = p_chunk->get_pos();
+        Chunk::Neighbors &links = p_chunk->get_neighbor_links();
+
+        links.pos_x = find(Chunk::ChunkPos(pos.x + 1, pos.y));
+        links.neg_x = find(Chunk::ChunkPos(pos.x - 1, pos.y));
+        links.pos_z = find(Chunk::ChunkPos(pos.x, pos.y + 1));
+        links.neg_z = find(Chunk::ChunkPos(pos.x, pos.y - 1));
+
+        if (links.pos_x)
+            links.pos_x->get_neighbor_links().neg_x = p_chunk;
+        if (links.neg_x)
+            links.neg_x->get_neighbor_links().pos_x = p_chunk;
+        if (links.pos_z)
+            links.pos_z->get_neighbor_links().neg_z = p_chunk;
+        if (links.neg_z)
+            links.neg_z->get_neighbor_links().pos_z = p_chunk;
+    }
+
+    void ChunkGrid::unlink_neighbors(Chunk *p_chunk)
+    {
+        Chunk::Neighbors &links = p_chunk->get_neighbor_links();
+
+        if (links.pos_x)
+            links.pos_x->get_neighbor_links().neg_x = nullptr;
+        if (links.neg_x)
+            links.neg_x->get_neighbor_links().pos_x = nullptr;
+        if (links.pos_z)
+            links.pos_z->get_neighbor_links().neg_z = nullptr;
+        if (links.neg_z)
+            links.neg_z->get_neighbor_links().pos_z = nullptr;
+
+        links = Chunk::Neighbors{};
+    }
+} //namespace Voxel
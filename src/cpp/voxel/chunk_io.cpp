@@ -0,0 +1,220 @@
+#include "hpp/voxel/chunk_io.hpp"
+#include "hpp/tools/hash.hpp"
+#include "hpp/tools/log.hpp"
+#include "hpp/tools/trace.hpp"
+#include <utility>
+
+namespace Voxel
+{
+    void ChunkIO::start(const std::string &p_directory)
+    {
+        stop();
+        m_loadResults.clear();
+
+        m_store.set_directory(p_directory);
+        if (!m_store.is_enabled())
+            return;
+
+        m_stopping = false;
+        m_thread = std::thread(&ChunkIO::run, this);
+
+        VOXEL_LOG_DEBUG("Chunk I/O worker started for {}.", p_directory);
+    }
+
+    void ChunkIO::stop()
+    {
+        if (!m_thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        // The worker drains every queue before it exits, so nothing handed off is lost.
+        m_wake.notify_all();
+        m_thread.join();
+        m_store.close_all();
+    }
+
+    bool ChunkIO::request_load(Chunk::ChunkPos p_chunkPos)
+    {
+        if (!is_running())
+            return false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_loadQueue.size() >= MAX_QUEUED_LOADS)
+                return false;
+
+            m_loadQueue.emplace_back(p_chunkPos);
+        }
+
+        m_wake.notify_one();
+        return true;
+    }
+
+    bool ChunkIO::poll_load(LoadResult &r_result)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_loadResults.empty())
+            return false;
+
+        r_result = std::move(m_loadResults.front());
+        m_loadResults.pop_front();
+        return true;
+    }
+
+    bool ChunkIO::load_now(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &r_bytes)
+    {
+        if (!is_running())
+            return false;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_urgentLoads.emplace_back(p_chunkPos);
+        m_wake.notify_one();
+        m_done.wait(lock, [this]()
+                    { return !m_urgentResults.empty(); });
+
+        LoadResult result = std::move(m_urgentResults.front());
+        m_urgentResults.pop_front();
+
+        r_bytes = std::move(result.bytes);
+        return result.found;
+    }
+
+    void ChunkIO::save(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &&p_bytes)
+    {
+        if (!is_running())
+            return;
+
+        const uint64_t key = Tools::Hash::chunk_pos(p_chunkPos);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_pendingWrites.size() >= MAX_PENDING_WRITES && m_pendingWrites.find(key) == m_pendingWrites.end())
+            {
+                VOXEL_TRACE_ZONE("ChunkIO::wait_for_write");
+                m_wake.notify_one();
+                m_done.wait(lock, [this]()
+                            { return m_pendingWrites.size() < MAX_PENDING_WRITES; });
+            }
+
+            // Replaces an older payload that was not written yet.
+            m_pendingWrites[key] = std::move(p_bytes);
+        }
+
+        m_wake.notify_one();
+    }
+
+    bool ChunkIO::is_write_queue_full() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pendingWrites.size() >= MAX_PENDING_WRITES;
+    }
+
+    void ChunkIO::flush()
+    {
+        if (!is_running())
+            return;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]()
+                    { return is_idle(); });
+
+        // The worker can't pick up new work while the lock is held, so the store is safe to touch here.
+        m_store.close_all();
+
+        Tools::Log::debug("Chunk I/O flushed.");
+    }
+
+    size_t ChunkIO::get_queued_load_count() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_loadQueue.size();
+    }
+
+    size_t ChunkIO::get_pending_write_count() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pendingWrites.size();
+    }
+
+    bool ChunkIO::is_idle() const
+    {
+        return !m_busy && m_loadQueue.empty() && m_urgentLoads.empty() && m_pendingWrites.empty();
+    }
+
+    bool ChunkIO::find_pending_write(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &r_bytes) const
+    {
+        auto iterator = m_pendingWrites.find(Tools::Hash::chunk_pos(p_chunkPos));
+        if (iterator == m_pendingWrites.end())
+            return false;
+
+        r_bytes = iterator->second;
+        return true;
+    }
+
+    void ChunkIO::run()
+    {
+        Tools::Trace::set_thread_name("Chunk I/O");
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            m_wake.wait(lock, [this]()
+                        { return m_stopping || !m_urgentLoads.empty() || !m_loadQueue.empty() || !m_pendingWrites.empty(); });
+
+            // Loads come first, something is waiting on them. Writes only bound how long a payload stays in memory.
+            if (!m_urgentLoads.empty() || !m_loadQueue.empty())
+            {
+                const bool isUrgent = !m_urgentLoads.empty();
+                std::deque<Chunk::ChunkPos> &queue = isUrgent ? m_urgentLoads : m_loadQueue;
+
+                LoadResult result{ queue.front(), false, {} };
+                queue.pop_front();
+
+                // A pending write is newer than anything on disk.
+                result.found = find_pending_write(result.pos, result.bytes);
+                if (!result.found)
+                {
+                    m_busy = true;
+                    lock.unlock();
+                    {
+                        VOXEL_TRACE_ZONE("ChunkIO::read");
+                        result.found = m_store.read(result.pos, result.bytes);
+                    }
+                    lock.lock();
+                    m_busy = false;
+                }
+
+                (isUrgent ? m_urgentResults : m_loadResults).emplace_back(std::move(result));
+                m_done.notify_all();
+                continue;
+            }
+
+            if (!m_pendingWrites.empty())
+            {
+                auto iterator = m_pendingWrites.begin();
+                const Chunk::ChunkPos pos = Tools::Hash::chunk_pos_from(iterator->first);
+                std::vector<uint8_t> bytes = std::move(iterator->second);
+                m_pendingWrites.erase(iterator);
+
+                // Loads are served by this thread too, so none can read the slot while it is half written.
+                m_busy = true;
+                lock.unlock();
+                {
+                    VOXEL_TRACE_ZONE("ChunkIO::write");
+                    m_store.write(pos, bytes);
+                }
+                lock.lock();
+                m_busy = false;
+
+                m_done.notify_all();
+                continue;
+            }
+
+            if (m_stopping)
+                break;
+        }
+    }
+} //namespace Voxel
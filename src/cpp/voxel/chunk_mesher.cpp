@@ -1,12 +1,14 @@
 #include "hpp/voxel/chunk_mesher.hpp"
 #include "godot_cpp/variant/vector2i.hpp"
-#include "hpp/tools/log_stream.hpp"
-#include "hpp/tools/string.hpp"
+#include "hpp/tools/log.hpp"
+#include "hpp/tools/trace.hpp"
 #include "hpp/voxel/block.hpp"
 #include "hpp/voxel/constants.hpp"
+#include "hpp/voxel/light_engine.hpp"
 #include "hpp/voxel/world.hpp"
-#include <immintrin.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <godot_cpp/classes/mesh.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/standard_material3d.hpp>
@@ -15,24 +17,23 @@
 #include <godot_cpp/variant/aabb.hpp>
 #include <godot_cpp/variant/array.hpp>
 #include <godot_cpp/variant/color.hpp>
-#include <sstream>
+#include <deque>
+#include <limits>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 using namespace godot;
 using namespace Voxel::Resource;
 
-#define DEBUG_VERBOSE
-
 namespace Voxel
 {
-#ifdef DEBUG_VERBOSE
-    static uint32_t num_faces = 0;
-    static uint32_t num_faces_skipped = 0;
-#endif
-
     static uint32_t mesh_count = 0;
     static std::unordered_set<Chunk *> mesh_queue_set;
+    // Meshes built on the CPU that are waiting for upload budget, oldest first.
+    static std::deque<std::pair<Chunk *, ChunkMesher::MeshData>> upload_queue;
+    // Buffers of uploaded meshes, kept with their capacity for the next queued build.
+    static Core::MeshBufferPool mesh_pool;
 
     void ChunkMesher::debug_start_mesh_count()
     {
@@ -44,191 +45,84 @@ namespace Voxel
         return mesh_count;
     }
 
-    static void add_face(
-            PackedVector3Array &vertices,
-            PackedVector3Array &vertex_normals,
-            PackedVector2Array &uvs,
-            PackedInt32Array &indices,
-            const Vector3 &v0,
-            const Vector3 &v1,
-            const Vector3 &v2,
-            const Vector3 &v3,
-            const Vector3 &normal,
-            const Vector2 &uv_base_offset)
+    // Godot's packed arrays take the core buffers as is in single precision builds and are converted element by
+    // element in double precision ones. r_packed keeps its allocation when it is not shared and already large enough.
+    template <class GodotT, class PackedT, class CoreT>
+    static void to_packed(const std::vector<CoreT> &p_buffer, PackedT &r_packed)
     {
-        const int base_index = vertices.size();
-
-        vertices.push_back(v0);
-        vertices.push_back(v1);
-        vertices.push_back(v2);
-        vertices.push_back(v3);
-
-        vertex_normals.push_back(normal);
-        vertex_normals.push_back(normal);
-        vertex_normals.push_back(normal);
-        vertex_normals.push_back(normal);
-
-        const float uv_size = TILE_UV_SIZE;
-        const float margin = 0.001f;
-
-        uvs.push_back(uv_base_offset + Vector2(margin, uv_size - margin));
-        uvs.push_back(uv_base_offset + Vector2(uv_size - margin, uv_size - margin));
-        uvs.push_back(uv_base_offset + Vector2(uv_size - margin, margin));
-        uvs.push_back(uv_base_offset + Vector2(margin, margin));
-
-        // Clockwise winding for Godot
-        indices.push_back(base_index + 0);
-        indices.push_back(base_index + 2);
-        indices.push_back(base_index + 1);
-
-        indices.push_back(base_index + 0);
-        indices.push_back(base_index + 3);
-        indices.push_back(base_index + 2);
-
-#ifdef DEBUG_VERBOSE
-        num_faces++;
-#endif
-    }
-
-    static Vector2 get_tile_uv_offset(Resource::Pallet::BlockTexture type)
-    {
-        int tile_index = static_cast<int>(type);
-
-        if (tile_index < 0 || tile_index >= (ATLAS_TILES_PER_ROW * ATLAS_TILES_PER_COLUMN))
-        {
-            tile_index = 0;
-        }
-
-        int tile_x = tile_index % ATLAS_TILES_PER_ROW;
-        int tile_y = tile_index / ATLAS_TILES_PER_COLUMN;
-
-        return Vector2(
-                static_cast<float>(tile_x) * TILE_UV_SIZE,
-                static_cast<float>(tile_y) * TILE_UV_SIZE);
-    }
-
-    static void draw_face(Chunk *p_chunk,
-                          Chunk *p_neighbor,
-                          ChunkMesher::SurfaceData &p_sd,
-                          const ChunkMesher::FacePoints &p_points,
-                          const Block *p_block,
-                          const int &p_x, const int &p_y, const int &p_z,
-                          const Vector3 &p_offset,
-                          bool p_block_in_chunk)
-    {
-        constexpr uint32_t XZ = CHUNK_AXIS_LENGTH_U;
-        constexpr uint32_t Y = CHUNK_HEIGHT_U;
+        r_packed.resize(static_cast<int64_t>(p_buffer.size()));
+        if (p_buffer.empty())
+            return;
 
-        bool draw_face = false;
-        if (p_block_in_chunk)
+        GodotT *pOut = r_packed.ptrw();
+        if constexpr (sizeof(GodotT) == sizeof(CoreT))
         {
-            draw_face = !p_chunk->get_block_at(p_x + p_offset.x, p_y + p_offset.y, p_z + p_offset.z)->opaque();
-        }
-        else if (p_neighbor)
-        {
-            draw_face = !p_neighbor->get_block_at(p_x, p_y, 0)->opaque();
-#ifdef DEBUG_VERBOSE
-            if (!draw_face)
-                num_faces_skipped++;
-#endif
+            std::memcpy(static_cast<void *>(pOut), p_buffer.data(), p_buffer.size() * sizeof(CoreT));
         }
         else
         {
-            draw_face = true;
-        }
-
-        if (draw_face)
-        {
-            Vector2 uv_offset = get_tile_uv_offset(p_block->get_texture());
-            add_face(p_sd.vertices, p_sd.vertex_normals, p_sd.uvs, p_sd.indices,
-                     p_points.p1, p_points.p2, p_points.p3, p_points.p4,
-                     p_offset, uv_offset);
+            for (size_t i = 0; i < p_buffer.size(); i++)
+            {
+                const float *pIn = reinterpret_cast<const float *>(&p_buffer[i]);
+                for (size_t component = 0; component < sizeof(CoreT) / sizeof(float); component++)
+                    pOut[i][component] = pIn[component];
+            }
         }
     }
 
-    void ChunkMesher::create_mesh(Chunk *p_chunk)
+    size_t ChunkMesher::create_mesh(Chunk *p_chunk)
     {
+        VOXEL_TRACE_ZONE("ChunkMesher::create_mesh");
         godot::Ref<godot::ArrayMesh> &p_mesh = p_chunk->get_mesh();
 
         if (!p_mesh.is_valid())
         {
             p_mesh.instantiate();
-            return;
+            return 0;
         }
 
+        // Meshed and committed right away, so one set of buffers per thread serves every chunk.
+        static thread_local MeshData scratch;
+        build_mesh(p_chunk, scratch);
+        commit_mesh(p_chunk, scratch);
+
+        return scratch.get_byte_size();
+    }
+
+    void ChunkMesher::build_mesh(Chunk *p_chunk, MeshData &r_data)
+    {
+        VOXEL_TRACE_ZONE("ChunkMesher::build_mesh");
         mesh_count++;
-#ifdef DEBUG_VERBOSE
-        num_faces = 0;
-        num_faces_skipped = 0;
-#endif
-        if (p_mesh.is_valid() && p_mesh->get_surface_count() > 0)
-        {
-            p_mesh->clear_surfaces();
-        }
 
-        SurfaceData data[Pallet::TYPE_COUNT];
+        // Sized from the chunk's previous mesh, or counted first for its first one, so the buffers grow at most once.
+        const Core::ChunkView view = p_chunk->get_view();
+        Core::FaceCounts &faceCounts = p_chunk->get_mesh_face_counts();
+        if (faceCounts.get_total() == 0)
+            Core::MeshBuilder::count_faces(view, faceCounts);
 
-        const uint32_t XZ = CHUNK_AXIS_LENGTH_U;
-        const uint32_t Y = CHUNK_HEIGHT_U;
+        r_data.reserve(faceCounts);
+        Core::MeshBuilder::build(view, r_data);
+        faceCounts = r_data.get_face_counts();
+    }
 
-        auto world = p_chunk->get_world();
-        auto chunk_pos = p_chunk->get_pos();
-        auto neighbors = p_chunk->get_neighbors();
+    void ChunkMesher::build_collision_faces(const Chunk *p_chunk, uint32_t p_section, PackedVector3Array &r_faces)
+    {
+        static thread_local std::vector<Core::Float3> faces;
+        faces.clear();
+        Core::MeshBuilder::build_collision(p_chunk->get_view(), p_section, faces);
+        to_packed<Vector3>(faces, r_faces);
+    }
 
-        CubePoints points{};
-        bool block_in_chunk = true;
+    void ChunkMesher::commit_mesh(Chunk *p_chunk, const MeshData &p_data)
+    {
+        VOXEL_TRACE_ZONE("ChunkMesher::commit_mesh");
+        godot::Ref<godot::ArrayMesh> &p_mesh = p_chunk->get_mesh();
+        if (!p_mesh.is_valid())
+            return;
 
-        for (int y = 0; y < Y; y++)
+        if (p_mesh->get_surface_count() > 0)
         {
-            for (int z = 0; z < XZ; z++)
-            {
-                for (int x = 0; x < XZ; x++)
-                {
-                    auto block = p_chunk->get_block_at(x, y, z);
-                    if (!block || !block->is_solid())
-                        continue;
-
-                    auto type = block->get_material_type();
-                    if (type < 0 || type >= Pallet::TYPE_COUNT)
-                    {
-                        Tools::Log::error() << "Attempted to assign unknown material value " << type
-                                            << " to block at " << Tools::String::xyz_to_string(x, y, z)
-                                            << " in chunk " << Tools::String::to_string(chunk_pos) << ".";
-                        type = Pallet::TYPE_UNKNOWN;
-                    }
-
-                    SurfaceData &sd = data[type];
-
-                    const Vector3 o(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
-
-                    points.p000 = o + Vector3(0, 0, 0);
-                    points.p100 = o + Vector3(1, 0, 0);
-                    points.p110 = o + Vector3(1, 1, 0);
-                    points.p010 = o + Vector3(0, 1, 0);
-                    points.p001 = o + Vector3(0, 0, 1);
-                    points.p101 = o + Vector3(1, 0, 1);
-                    points.p111 = o + Vector3(1, 1, 1);
-                    points.p011 = o + Vector3(0, 1, 1);
-
-                    block_in_chunk = z < XZ - 1;
-                    draw_face(p_chunk, neighbors.pos_z, sd, points.pos_z(), block, x, y, z, Vector3(0, 0, 1), block_in_chunk);
-
-                    block_in_chunk = z > 0;
-                    draw_face(p_chunk, neighbors.neg_z, sd, points.neg_z(), block, x, y, z, Vector3(0, 0, -1), block_in_chunk);
-
-                    block_in_chunk = x == XZ - 1;
-                    draw_face(p_chunk, neighbors.pos_x, sd, points.pos_x(), block, x, y, z, Vector3(1, 0, 0), block_in_chunk);
-
-                    block_in_chunk = x > 0;
-                    draw_face(p_chunk, neighbors.neg_x, sd, points.neg_x(), block, x, y, z, Vector3(-1, 0, 0), block_in_chunk);
-
-                    block_in_chunk = y < Y - 1;
-                    draw_face(p_chunk, nullptr, sd, points.pos_y(), block, x, y, z, Vector3(0, 1, 0), block_in_chunk);
-
-                    block_in_chunk = y > 0;
-                    draw_face(p_chunk, nullptr, sd, points.neg_y(), block, x, y, z, Vector3(0, -1, 0), block_in_chunk);
-                }
-            }
+            p_mesh->clear_surfaces();
         }
 
         const int surface_order[] = { Pallet::TYPE_GENERIC, Pallet::TYPE_METAL, Pallet::TYPE_UNKNOWN, Pallet::TYPE_GLASS };
@@ -236,28 +130,45 @@ namespace Voxel
         auto worldPallet = p_chunk->get_world()->get_pallet();
         auto chunkRID = p_chunk->get_rid();
 
-        for (int i = 0; i < Pallet::TYPE_COUNT; i++)
+        std::vector<uint8_t> &surfaceTypes = p_chunk->get_mesh_surface_types();
+        surfaceTypes.clear();
+
+        // Reused for every surface. ArrayMesh copies them into its own format, so they are unshared again after each
+        // surface is added and keep their allocation.
+        static thread_local PackedVector3Array vertices;
+        static thread_local PackedVector3Array normals;
+        static thread_local PackedVector2Array uvs;
+        static thread_local PackedColorArray colors;
+        static thread_local PackedInt32Array indices;
+
+        // Block surfaces in surface_order, then the fluid surface, which is drawn over them.
+        for (int i = 0; i <= Pallet::TYPE_COUNT; i++)
         {
-            int type = surface_order[i];
-            SurfaceData &sd = data[type];
-            if (sd.indices.size() == 0)
+            const bool isFluid = i == Pallet::TYPE_COUNT;
+            int type = isFluid ? Pallet::TYPE_UNKNOWN : surface_order[i];
+            const Core::SurfaceBuffers &sd = isFluid ? p_data.fluid : p_data.surfaces[type];
+            if (sd.indices.empty())
                 continue;
 
+            to_packed<Vector3>(sd.vertices, vertices);
+            to_packed<Vector3>(sd.normals, normals);
+            to_packed<Vector2>(sd.uvs, uvs);
+            to_packed<Color>(sd.colors, colors);
+            to_packed<int32_t>(sd.indices, indices);
+
             Array arrays;
             arrays.resize(Mesh::ARRAY_MAX);
-            arrays[Mesh::ARRAY_VERTEX] = sd.vertices;
-            arrays[Mesh::ARRAY_NORMAL] = sd.vertex_normals;
-            arrays[Mesh::ARRAY_TEX_UV] = sd.uvs;
-            arrays[Mesh::ARRAY_INDEX] = sd.indices;
+            arrays[Mesh::ARRAY_VERTEX] = vertices;
+            arrays[Mesh::ARRAY_NORMAL] = normals;
+            arrays[Mesh::ARRAY_TEX_UV] = uvs;
+            arrays[Mesh::ARRAY_COLOR] = colors;
+            arrays[Mesh::ARRAY_INDEX] = indices;
 
             p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays);
 
-            int surface_idx = p_mesh->get_surface_count() - 1;
-            Ref<StandardMaterial3D> mat = worldPallet->get_material(type);
-            if (mat.is_valid())
-            {
-                p_mesh->surface_set_material(surface_idx, mat);
-            }
+            const uint8_t surfaceType = isFluid ? SURFACE_FLUID : static_cast<uint8_t>(type);
+            surfaceTypes.push_back(surfaceType);
+            p_mesh->surface_set_material(p_mesh->get_surface_count() - 1, get_surface_material(worldPallet, surfaceType));
         }
 
         if (chunkRID.is_valid())
@@ -270,18 +181,130 @@ namespace Voxel
 #ifdef DEBUG_VERBOSE
         if (p_mesh.is_valid() && p_mesh->get_surface_count() > 0)
         {
-            Tools::Log::debug() << "Mesh has " << p_mesh->get_surface_count()
-                                << " surfaces, " << p_mesh->surface_get_array_len(0)
-                                << " vertices, and " << num_faces << " faces for chunk "
-                                << Tools::String::to_string(chunk_pos) << ". "
-                                << num_faces_skipped << " face(s) were skipped due to neighboring chunk's block being opaque.";
+            VOXEL_LOG_DEBUG("Mesh has {} surfaces, {} vertices, and {} faces for chunk {}.",
+                            p_mesh->get_surface_count(), p_mesh->surface_get_array_len(0), p_data.faceCount, p_chunk->get_pos());
         }
 #endif
     }
 
+    void ChunkMesher::apply_materials(Chunk *p_chunk)
+    {
+        godot::Ref<godot::ArrayMesh> &p_mesh = p_chunk->get_mesh();
+        if (!p_mesh.is_valid())
+            return;
+
+        const Ref<Pallet> worldPallet = p_chunk->get_world()->get_pallet();
+        const std::vector<uint8_t> &surfaceTypes = p_chunk->get_mesh_surface_types();
+
+        const int32_t count = std::min(p_mesh->get_surface_count(), static_cast<int32_t>(surfaceTypes.size()));
+        for (int32_t surface = 0; surface < count; surface++)
+            p_mesh->surface_set_material(surface, get_surface_material(worldPallet, surfaceTypes[surface]));
+    }
+
+    Ref<StandardMaterial3D> ChunkMesher::get_surface_material(const Ref<Pallet> &p_pallet, uint8_t p_surfaceType)
+    {
+        if (p_pallet.is_null())
+            return Ref<StandardMaterial3D>();
+
+        return p_surfaceType == SURFACE_FLUID ? p_pallet->get_fluid_material() : p_pallet->get_material(p_surfaceType);
+    }
+
     void ChunkMesher::on_chunk_unload(Chunk *p_chunk)
     {
         mesh_queue_set.erase(p_chunk);
+
+        for (auto iterator = upload_queue.begin(); iterator != upload_queue.end(); ++iterator)
+        {
+            if (iterator->first == p_chunk)
+            {
+                mesh_pool.release(std::move(iterator->second));
+                upload_queue.erase(iterator);
+                break;
+            }
+        }
+    }
+
+    bool ChunkMesher::build_next(godot::Vector2i p_center)
+    {
+        if (mesh_queue_set.empty())
+            return false;
+
+        // The queue is small next to the cost of a build, so it is scanned rather than kept sorted as the center moves.
+        auto nearest = mesh_queue_set.begin();
+        int64_t nearestSq = std::numeric_limits<int64_t>::max();
+        for (auto iterator = mesh_queue_set.begin(); iterator != mesh_queue_set.end(); ++iterator)
+        {
+            if (!*iterator)
+            {
+                nearest = iterator;
+                break;
+            }
+
+            const Chunk::ChunkPos pos = (*iterator)->get_pos();
+            const int64_t dx = pos.x - p_center.x;
+            const int64_t dz = pos.y - p_center.y;
+            if (dx * dx + dz * dz < nearestSq)
+            {
+                nearestSq = dx * dx + dz * dz;
+                nearest = iterator;
+            }
+        }
+
+        Chunk *pChunk = *nearest;
+        mesh_queue_set.erase(nearest);
+
+        if (!pChunk || !pChunk->get_mesh().is_valid())
+            return false;
+
+        // A chunk still waiting on upload budget gets its newer mesh in place so only one upload happens.
+        for (auto &pending : upload_queue)
+        {
+            if (pending.first == pChunk)
+            {
+                build_mesh(pChunk, pending.second);
+                return true;
+            }
+        }
+
+        upload_queue.emplace_back(pChunk, mesh_pool.acquire());
+        build_mesh(pChunk, upload_queue.back().second);
+        return true;
+    }
+
+    bool ChunkMesher::has_pending_upload()
+    {
+        return !upload_queue.empty();
+    }
+
+    size_t ChunkMesher::get_next_upload_size()
+    {
+        return upload_queue.empty() ? 0 : upload_queue.front().second.get_byte_size();
+    }
+
+    size_t ChunkMesher::upload_next()
+    {
+        if (upload_queue.empty())
+            return 0;
+
+        auto pending = std::move(upload_queue.front());
+        upload_queue.pop_front();
+
+        commit_mesh(pending.first, pending.second);
+        const size_t size = pending.second.get_byte_size();
+        mesh_pool.release(std::move(pending.second));
+        return size;
+    }
+
+    bool ChunkMesher::is_queue_empty()
+    {
+        return mesh_queue_set.empty();
+    }
+
+    size_t ChunkMesher::mesh_now(Chunk *p_chunk)
+    {
+        // Anything queued or awaiting upload for this chunk is older than what is about to be committed.
+        on_chunk_unload(p_chunk);
+        return create_mesh(p_chunk);
     }
 
     void ChunkMesher::mesh_queue(Chunk *p_chunk)
@@ -291,12 +314,13 @@ namespace Voxel
 
     void ChunkMesher::mesh_dequeue(ChunkMesher::DequeueQuantity p_quantity)
     {
+        VOXEL_TRACE_ZONE("ChunkMesher::mesh_dequeue");
         int batch_size = p_quantity == ChunkMesher::DEQUEUE_BATCH_ALL ? mesh_queue_set.size() : static_cast<int>(p_quantity);
 
 #ifdef DEBUG_VERBOSE
         int iteration_count = 0;
-        std::stringstream ss;
-        ss << "Chunks remeshed: ";
+        const bool listChunks = Tools::Log::is_enabled(Tools::Log::Level::Debug);
+        std::string remeshed = "Chunks remeshed: ";
 #endif
         size_t remesh_count{};
         std::vector<Chunk *> remeshed_chunks;
@@ -314,8 +338,8 @@ namespace Voxel
             remeshed_chunks.emplace_back(chunk);
 
 #ifdef DEBUG_VERBOSE
-            auto chunk_pos = chunk->get_pos();
-            ss << Tools::String::to_string(chunk_pos) << " ";
+            if (listChunks)
+                Tools::Format::format_to(remeshed, "{} ", chunk->get_pos());
 #endif
 
             remesh_count++;
@@ -330,11 +354,11 @@ namespace Voxel
         }
 
 #ifdef DEBUG_VERBOSE
-        Tools::Log::debug()
-                << "(Chunk mesher) remeshed " << remesh_count
-                << " after checking " << iteration_count << " chunks. The batch size was " << batch_size << ". "
-                << "There are " << mesh_queue_set.size() << " chunks left in the queue.";
-        Tools::Log::debug() << ss.str();
+        VOXEL_LOG_DEBUG("(Chunk mesher) remeshed {} after checking {} chunks. The batch size was {}. There are {} chunks left in "
+                        "the queue.",
+                        remesh_count, iteration_count, batch_size, mesh_queue_set.size());
+        if (listChunks)
+            Tools::Log::write_line(Tools::Log::Level::Debug, std::move(remeshed));
 #endif
     }
 } //namespace Voxel
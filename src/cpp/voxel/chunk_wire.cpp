@@ -0,0 +1,225 @@
+#include "hpp/voxel/chunk_wire.hpp"
+#include "godot_cpp/classes/file_access.hpp"
+#include "hpp/tools/hash.hpp"
+#include "hpp/tools/log.hpp"
+#include "hpp/voxel/chunk_grid.hpp"
+#include "hpp/voxel/constants.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace godot;
+
+namespace Voxel
+{
+    using Core::WireCodec;
+
+    // Type, chunk x, chunk z and body size.
+    static constexpr size_t CHUNK_HEADER_SIZE = 1 + 4 + 4 + 4;
+
+    static PackedByteArray to_packed(const std::vector<uint8_t> &p_bytes)
+    {
+        PackedByteArray packed;
+        packed.resize(static_cast<int64_t>(p_bytes.size()));
+        if (!p_bytes.empty())
+            std::memcpy(packed.ptrw(), p_bytes.data(), p_bytes.size());
+        return packed;
+    }
+
+    PackedByteArray ChunkWire::encode_chunk(const Chunk *p_chunk)
+    {
+        std::vector<uint8_t> body;
+        WireCodec::encode_sections(p_chunk->get_block(0), CHUNK_SECTION_COUNT, body);
+        WireCodec::encode_fluid(p_chunk->get_fluid_data(), body);
+
+        const PackedByteArray compressed = to_packed(body).compress(FileAccess::COMPRESSION_FASTLZ);
+
+        std::vector<uint8_t> header;
+        header.reserve(CHUNK_HEADER_SIZE);
+        header.push_back(PACKET_CHUNK);
+        WireCodec::put_u32(header, static_cast<uint32_t>(p_chunk->get_pos().x));
+        WireCodec::put_u32(header, static_cast<uint32_t>(p_chunk->get_pos().y));
+        WireCodec::put_u32(header, static_cast<uint32_t>(body.size()));
+
+        PackedByteArray packet = to_packed(header);
+        packet.append_array(compressed);
+        return packet;
+    }
+
+    bool ChunkWire::read_chunk_pos(const PackedByteArray &p_packet, Chunk::ChunkPos &r_pos)
+    {
+        const uint8_t *pBytes = p_packet.ptr();
+        if (p_packet.size() < static_cast<int64_t>(CHUNK_HEADER_SIZE) || pBytes[0] != PACKET_CHUNK)
+            return false;
+
+        r_pos = Chunk::ChunkPos(static_cast<int32_t>(WireCodec::get_u32(pBytes + 1)), static_cast<int32_t>(WireCodec::get_u32(pBytes + 5)));
+        return true;
+    }
+
+    bool ChunkWire::decode_chunk(const PackedByteArray &p_packet, Chunk *r_chunk)
+    {
+        Chunk::ChunkPos pos;
+        if (!read_chunk_pos(p_packet, pos))
+            return false;
+
+        const uint32_t bodySize = WireCodec::get_u32(p_packet.ptr() + 9);
+        if (bodySize == 0 || bodySize > WireCodec::MAX_BODY_SIZE)
+        {
+            VOXEL_LOG_ERROR("Chunk packet declares an invalid body size of {} bytes.", bodySize);
+            return false;
+        }
+
+        const PackedByteArray body = p_packet.slice(CHUNK_HEADER_SIZE).decompress(bodySize, FileAccess::COMPRESSION_FASTLZ);
+        const uint8_t *pEnd = body.ptr() + body.size();
+
+        // Whatever follows the sections is the fluid.
+        r_chunk->clear_fluid();
+        const uint8_t *pCursor = nullptr;
+        if (body.size() == static_cast<int64_t>(bodySize))
+            pCursor = WireCodec::decode_sections(body.ptr(), pEnd, CHUNK_SECTION_COUNT, r_chunk->get_block_data());
+        if (!pCursor || (pCursor != pEnd && !WireCodec::decode_fluid(pCursor, pEnd, r_chunk->allocate_fluid_data())))
+        {
+            VOXEL_LOG_ERROR("Chunk packet for {} is corrupt.", pos);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool ChunkWire::decode_deltas(const PackedByteArray &p_packet, std::vector<SectionDelta> &r_deltas)
+    {
+        const uint8_t *pCursor = p_packet.ptr();
+        const uint8_t *pEnd = pCursor + p_packet.size();
+
+        if (pEnd - pCursor < 3 || pCursor[0] != PACKET_DELTA)
+            return false;
+
+        return WireCodec::decode_deltas(pCursor + 3, pEnd, WireCodec::get_u16(pCursor + 1), r_deltas);
+    }
+
+    PackedByteArray ChunkWire::encode_unload(const std::vector<Chunk::ChunkPos> &p_chunks)
+    {
+        const size_t count = std::min<size_t>(p_chunks.size(), 0xFFFF);
+
+        std::vector<uint8_t> bytes;
+        bytes.reserve(3 + count * 8);
+        bytes.push_back(PACKET_UNLOAD);
+        WireCodec::put_u16(bytes, static_cast<uint32_t>(count));
+
+        for (size_t i = 0; i < count; i++)
+        {
+            WireCodec::put_u32(bytes, static_cast<uint32_t>(p_chunks[i].x));
+            WireCodec::put_u32(bytes, static_cast<uint32_t>(p_chunks[i].y));
+        }
+
+        return to_packed(bytes);
+    }
+
+    bool ChunkWire::decode_unload(const PackedByteArray &p_packet, std::vector<Chunk::ChunkPos> &r_chunks)
+    {
+        const uint8_t *pBytes = p_packet.ptr();
+        const int64_t size = p_packet.size();
+        if (size < 3 || pBytes[0] != PACKET_UNLOAD)
+            return false;
+
+        const uint32_t count = WireCodec::get_u16(pBytes + 1);
+        if (size != 3 + static_cast<int64_t>(count) * 8)
+            return false;
+
+        r_chunks.clear();
+        r_chunks.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint8_t *pEntry = pBytes + 3 + static_cast<size_t>(i) * 8;
+            r_chunks.emplace_back(static_cast<int32_t>(WireCodec::get_u32(pEntry)), static_cast<int32_t>(WireCodec::get_u32(pEntry + 4)));
+        }
+
+        return true;
+    }
+
+    ChunkWire::PacketType ChunkWire::get_packet_type(const PackedByteArray &p_packet)
+    {
+        return p_packet.is_empty() ? static_cast<PacketType>(0) : static_cast<PacketType>(p_packet.ptr()[0]);
+    }
+
+    void ChunkWire::DeltaBatch::record_span(const Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+    {
+        const uint32_t section = y / SECTION_AXIS_LENGTH_U;
+        Edits &edits = m_sections[{ Tools::Hash::chunk_pos(p_chunk->get_pos()), section }];
+        if (edits.snapshot)
+            return;
+
+        for (uint32_t x = x0; x <= x1; x++)
+            edits.indices.emplace_back(static_cast<uint16_t>(WireCodec::get_section_index(x, y, z)));
+
+        // Duplicates are only removed on take, so the threshold is checked against the raw count.
+        if (edits.indices.size() > SNAPSHOT_THRESHOLD)
+        {
+            std::sort(edits.indices.begin(), edits.indices.end());
+            edits.indices.erase(std::unique(edits.indices.begin(), edits.indices.end()), edits.indices.end());
+
+            if (edits.indices.size() > SNAPSHOT_THRESHOLD)
+            {
+                edits.snapshot = true;
+                edits.indices.clear();
+                edits.indices.shrink_to_fit();
+            }
+        }
+    }
+
+    void ChunkWire::DeltaBatch::record_fluid(const Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z)
+    {
+        const uint32_t section = y / SECTION_AXIS_LENGTH_U;
+        Edits &edits = m_sections[{ Tools::Hash::chunk_pos(p_chunk->get_pos()), section }];
+        edits.fluidIndices.emplace_back(static_cast<uint16_t>(WireCodec::get_section_index(x, y, z)));
+    }
+
+    PackedByteArray ChunkWire::DeltaBatch::take(const ChunkGrid &p_chunks)
+    {
+        std::vector<uint8_t> bytes;
+        bytes.push_back(PACKET_DELTA);
+        WireCodec::put_u16(bytes, 0);
+
+        uint32_t count = 0;
+        for (auto &kvp : m_sections)
+        {
+            const Chunk::ChunkPos pos = Tools::Hash::chunk_pos_from(kvp.first.first);
+            const Chunk *pChunk = p_chunks.find(pos);
+            if (!pChunk)
+                continue;
+
+            const uint32_t section = kvp.first.second;
+            Edits &edits = kvp.second;
+            const size_t first = static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+
+            if ((edits.snapshot || !edits.indices.empty()) && count < 0xFFFF)
+            {
+                if (!edits.snapshot)
+                {
+                    std::sort(edits.indices.begin(), edits.indices.end());
+                    edits.indices.erase(std::unique(edits.indices.begin(), edits.indices.end()), edits.indices.end());
+                }
+
+                const WireCodec::DeltaMode mode = edits.snapshot ? WireCodec::DELTA_SNAPSHOT : WireCodec::DELTA_SPARSE;
+                WireCodec::encode_delta(pos.x, pos.y, section, pChunk->get_block(first), mode, edits.indices, bytes);
+                count++;
+            }
+
+            // A flood changes the same cells step after step, each is sent once with its latest fluid.
+            if (!edits.fluidIndices.empty() && count < 0xFFFF)
+            {
+                std::sort(edits.fluidIndices.begin(), edits.fluidIndices.end());
+                edits.fluidIndices.erase(std::unique(edits.fluidIndices.begin(), edits.fluidIndices.end()), edits.fluidIndices.end());
+
+                const uint8_t *pFluid = pChunk->get_fluid_data();
+                WireCodec::encode_fluid_delta(pos.x, pos.y, section, pFluid ? pFluid + first : nullptr, edits.fluidIndices, bytes);
+                count++;
+            }
+        }
+
+        bytes[1] = static_cast<uint8_t>(count & 0xFF);
+        bytes[2] = static_cast<uint8_t>((count >> 8) & 0xFF);
+
+        m_sections.clear();
+        return to_packed(bytes);
+    }
+} //namespace Voxel
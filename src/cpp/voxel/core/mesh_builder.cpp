@@ -0,0 +1,546 @@
+#include "hpp/voxel/core/mesh_builder.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/core/fluid.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+namespace Voxel::Core
+{
+    struct FaceDesc
+    {
+        int32_t dx, dy, dz;
+        // Neighbor the face looks into when it leaves the chunk on x or z, SIDE_COUNT for y.
+        ChunkView::Side side;
+        // Cube corners in clockwise order seen from outside.
+        uint8_t corners[4][3];
+    };
+
+    // Same order the faces were always emitted in, which the mesh hash depends on.
+    static constexpr FaceDesc FACES[6] = {
+        { 0, 0, 1, ChunkView::SIDE_POS_Z, { { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } } },
+        { 0, 0, -1, ChunkView::SIDE_NEG_Z, { { 1, 0, 0 }, { 0, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } } },
+        { 1, 0, 0, ChunkView::SIDE_POS_X, { { 1, 0, 1 }, { 1, 0, 0 }, { 1, 1, 0 }, { 1, 1, 1 } } },
+        { -1, 0, 0, ChunkView::SIDE_NEG_X, { { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 }, { 0, 1, 0 } } },
+        { 0, 1, 0, ChunkView::SIDE_COUNT, { { 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 0 } } },
+        { 0, -1, 0, ChunkView::SIDE_COUNT, { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 1 }, { 0, 0, 1 } } },
+    };
+
+    // Faces against unloaded neighbors or the top of the world are treated as open to the sky.
+    static constexpr uint8_t OPEN_SKY = ChunkView::LIGHT_MAX << 4;
+
+    // What lies across a face: the block, or nullptr when that side is outside the world or in an unloaded
+    // neighbor, and the light of that cell.
+    struct Facing
+    {
+        const Block *pBlock;
+        uint8_t light;
+    };
+
+    static Facing get_facing(const ChunkView &p_view, int32_t x, int32_t y, int32_t z, const FaceDesc &p_face)
+    {
+        constexpr int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        constexpr int32_t Y = static_cast<int32_t>(CHUNK_HEIGHT_U);
+
+        const int32_t nx = x + p_face.dx;
+        const int32_t ny = y + p_face.dy;
+        const int32_t nz = z + p_face.dz;
+
+        if (ny < 0 || ny >= Y)
+            return { nullptr, OPEN_SKY };
+
+        if (nx >= 0 && nx < XZ && nz >= 0 && nz < XZ)
+        {
+            const size_t index = get_block_index(nx, ny, nz);
+            return { &p_view.pBlocks[index], p_view.pLight[index] };
+        }
+
+        const Block *pNeighbor = p_view.pNeighborBlocks[p_face.side];
+        if (!pNeighbor)
+            return { nullptr, OPEN_SKY };
+
+        // The face leaves this chunk on x or z, so wrap onto the facing edge of the neighbor.
+        const size_t index = get_block_index(static_cast<uint32_t>(nx) & (XZ - 1), ny, static_cast<uint32_t>(nz) & (XZ - 1));
+        return { &pNeighbor[index], p_view.pNeighborLight[p_face.side][index] };
+    }
+
+    // Fluid across a face, NONE outside the world, in unloaded neighbors and in chunks without fluid.
+    static uint8_t get_facing_fluid(const ChunkView &p_view, int32_t x, int32_t y, int32_t z, const FaceDesc &p_face)
+    {
+        constexpr int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        constexpr int32_t Y = static_cast<int32_t>(CHUNK_HEIGHT_U);
+
+        const int32_t nx = x + p_face.dx;
+        const int32_t ny = y + p_face.dy;
+        const int32_t nz = z + p_face.dz;
+
+        if (ny < 0 || ny >= Y)
+            return Fluid::NONE;
+
+        if (nx >= 0 && nx < XZ && nz >= 0 && nz < XZ)
+            return p_view.pFluid ? p_view.pFluid[get_block_index(nx, ny, nz)] : Fluid::NONE;
+
+        const uint8_t *pNeighbor = p_view.pNeighborFluid[p_face.side];
+        if (!pNeighbor)
+            return Fluid::NONE;
+
+        return pNeighbor[get_block_index(static_cast<uint32_t>(nx) & (XZ - 1), ny, static_cast<uint32_t>(nz) & (XZ - 1))];
+    }
+
+    static constexpr const FaceDesc &FACE_UP = FACES[4];
+
+    // Calls p_visit(x, y, z, fluid, face, facing, height) for every fluid face to draw. A fluid face is hidden by an
+    // opaque block, or by fluid across it that is at least as high.
+    template <class Visitor>
+    static void visit_fluid_faces(const ChunkView &p_view, Visitor &&p_visit)
+    {
+        const int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        const int32_t Y = static_cast<int32_t>(CHUNK_HEIGHT_U);
+
+        for (int32_t y = 0; y < Y; y++)
+        {
+            for (int32_t z = 0; z < XZ; z++)
+            {
+                for (int32_t x = 0; x < XZ; x++)
+                {
+                    const size_t index = get_block_index(x, y, z);
+                    const uint8_t fluid = p_view.pFluid[index];
+                    const uint8_t level = Fluid::get_level(fluid);
+                    if (level == 0 || p_view.pBlocks[index].is_solid())
+                        continue;
+
+                    const bool covered = Fluid::get_level(get_facing_fluid(p_view, x, y, z, FACE_UP)) > 0;
+                    const float height = covered ? 1.0f : static_cast<float>(level) / (Fluid::LEVEL_MAX + 1);
+
+                    for (const FaceDesc &face : FACES)
+                    {
+                        const Facing facing = get_facing(p_view, x, y, z, face);
+                        if (facing.pBlock && facing.pBlock->opaque())
+                            continue;
+
+                        const uint8_t across = Fluid::get_level(get_facing_fluid(p_view, x, y, z, face));
+                        if (across > 0 && (face.dy != 0 || across >= level))
+                            continue;
+
+                        p_visit(x, y, z, fluid, face, facing, height);
+                    }
+                }
+            }
+        }
+    }
+
+    static std::atomic<uint64_t> s_allocations{ 0 };
+
+    struct Capacities
+    {
+        size_t vertices, normals, uvs, colors, indices;
+    };
+
+    static Capacities get_capacities(const SurfaceBuffers &p_surface)
+    {
+        return { p_surface.vertices.capacity(), p_surface.normals.capacity(), p_surface.uvs.capacity(),
+                 p_surface.colors.capacity(), p_surface.indices.capacity() };
+    }
+
+    // Counts the buffers whose storage was reallocated since p_before was taken.
+    static void record_growth(const SurfaceBuffers &p_surface, const Capacities &p_before)
+    {
+        const Capacities after = get_capacities(p_surface);
+        const uint64_t grown = (after.vertices != p_before.vertices) + (after.normals != p_before.normals) +
+                               (after.uvs != p_before.uvs) + (after.colors != p_before.colors) +
+                               (after.indices != p_before.indices);
+        if (grown > 0)
+            s_allocations.fetch_add(grown, std::memory_order_relaxed);
+    }
+
+    static int get_surface_type(const Block &p_block)
+    {
+        const int type = p_block.get_material_type();
+        return type < 0 || type >= BlockTypes::TYPE_COUNT ? static_cast<int>(BlockTypes::TYPE_UNKNOWN) : type;
+    }
+
+    static Float2 get_tile_uv_offset(BlockTypes::BlockTexture p_texture)
+    {
+        int tile_index = static_cast<int>(p_texture);
+        if (tile_index < 0 || tile_index >= (ATLAS_TILES_PER_ROW * ATLAS_TILES_PER_COLUMN))
+            tile_index = 0;
+
+        const int tile_x = tile_index % ATLAS_TILES_PER_ROW;
+        const int tile_y = tile_index / ATLAS_TILES_PER_COLUMN;
+        return { static_cast<float>(tile_x) * TILE_UV_SIZE, static_cast<float>(tile_y) * TILE_UV_SIZE };
+    }
+
+    // Each light level is 80% as bright as the one above it, with a floor so unlit caves aren't pitch black.
+    static float get_light_brightness(uint8_t p_light)
+    {
+        static const struct LightCurve
+        {
+            float levels[ChunkView::LIGHT_MAX + 1];
+
+            LightCurve()
+            {
+                for (int level = 0; level <= ChunkView::LIGHT_MAX; level++)
+                    levels[level] = 0.05f + 0.95f * std::pow(0.8f, static_cast<float>(ChunkView::LIGHT_MAX - level));
+            }
+        } curve;
+
+        return curve.levels[std::max(ChunkView::get_sky(p_light), ChunkView::get_block(p_light))];
+    }
+
+    static void add_face(SurfaceBuffers &r_surface, int32_t x, int32_t y, int32_t z, const FaceDesc &p_face,
+                  Float2 p_uvOffset, float p_brightness)
+    {
+        const int32_t base_index = static_cast<int32_t>(r_surface.vertices.size());
+
+        for (const uint8_t *corner : p_face.corners)
+        {
+            r_surface.vertices.push_back({ static_cast<float>(x + corner[0]),
+                                           static_cast<float>(y + corner[1]),
+                                           static_cast<float>(z + corner[2]) });
+            r_surface.normals.push_back({ static_cast<float>(p_face.dx), static_cast<float>(p_face.dy), static_cast<float>(p_face.dz) });
+            r_surface.colors.push_back({ p_brightness, p_brightness, p_brightness, 1.0f });
+        }
+
+        const float uv_size = TILE_UV_SIZE;
+        const float margin = 0.001f;
+
+        r_surface.uvs.push_back({ p_uvOffset.x + margin, p_uvOffset.y + (uv_size - margin) });
+        r_surface.uvs.push_back({ p_uvOffset.x + (uv_size - margin), p_uvOffset.y + (uv_size - margin) });
+        r_surface.uvs.push_back({ p_uvOffset.x + (uv_size - margin), p_uvOffset.y + margin });
+        r_surface.uvs.push_back({ p_uvOffset.x + margin, p_uvOffset.y + margin });
+
+        // Clockwise winding for Godot
+        const int32_t triangles[6] = { 0, 2, 1, 0, 3, 2 };
+        for (int32_t offset : triangles)
+            r_surface.indices.push_back(base_index + offset);
+    }
+
+    static void add_fluid_face(SurfaceBuffers &r_surface, int32_t x, int32_t y, int32_t z, const FaceDesc &p_face,
+                               float p_height, Float4 p_color)
+    {
+        const int32_t base_index = static_cast<int32_t>(r_surface.vertices.size());
+
+        for (const uint8_t *corner : p_face.corners)
+        {
+            r_surface.vertices.push_back({ static_cast<float>(x + corner[0]),
+                                           static_cast<float>(y) + static_cast<float>(corner[1]) * p_height,
+                                           static_cast<float>(z + corner[2]) });
+            r_surface.normals.push_back({ static_cast<float>(p_face.dx), static_cast<float>(p_face.dy), static_cast<float>(p_face.dz) });
+            r_surface.colors.push_back(p_color);
+        }
+
+        r_surface.uvs.push_back({ 0.0f, 1.0f });
+        r_surface.uvs.push_back({ 1.0f, 1.0f });
+        r_surface.uvs.push_back({ 1.0f, 0.0f });
+        r_surface.uvs.push_back({ 0.0f, 0.0f });
+
+        const int32_t triangles[6] = { 0, 2, 1, 0, 3, 2 };
+        for (int32_t offset : triangles)
+            r_surface.indices.push_back(base_index + offset);
+    }
+
+    // Unlit tint per fluid kind, alpha included. Lava glows, so light only darkens water.
+    static Float4 get_fluid_color(uint8_t p_fluid, float p_brightness)
+    {
+        if (Fluid::get_kind(p_fluid) == Fluid::KIND_LAVA)
+            return { 1.0f, 0.45f, 0.1f, 1.0f };
+
+        return { 0.25f * p_brightness, 0.45f * p_brightness, 0.9f * p_brightness, 0.7f };
+    }
+
+    template <class T>
+    static void hash_buffer(uint64_t &r_hash, const std::vector<T> &p_buffer)
+    {
+        const auto mix = [&r_hash](uint8_t p_byte)
+        {
+            r_hash ^= p_byte;
+            r_hash *= 0x100000001B3ull;
+        };
+
+        const uint64_t count = p_buffer.size();
+        for (uint32_t byte = 0; byte < 8; byte++)
+            mix(static_cast<uint8_t>(count >> (byte * 8)));
+
+        const uint8_t *pBytes = reinterpret_cast<const uint8_t *>(p_buffer.data());
+        for (size_t i = 0; i < p_buffer.size() * sizeof(T); i++)
+            mix(pBytes[i]);
+    }
+
+    uint32_t FaceCounts::get_total() const
+    {
+        uint32_t total = 0;
+        for (uint32_t faces : surfaces)
+            total += faces;
+
+        return total + fluid;
+    }
+
+    void SurfaceBuffers::clear()
+    {
+        vertices.clear();
+        normals.clear();
+        uvs.clear();
+        colors.clear();
+        indices.clear();
+    }
+
+    void SurfaceBuffers::reserve(uint32_t p_faces)
+    {
+        const Capacities before = get_capacities(*this);
+
+        const size_t vertexCount = static_cast<size_t>(p_faces) * 4;
+        vertices.reserve(vertexCount);
+        normals.reserve(vertexCount);
+        uvs.reserve(vertexCount);
+        colors.reserve(vertexCount);
+        indices.reserve(static_cast<size_t>(p_faces) * 6);
+
+        record_growth(*this, before);
+    }
+
+    size_t SurfaceBuffers::get_capacity_byte_size() const
+    {
+        return vertices.capacity() * sizeof(Float3) +
+               normals.capacity() * sizeof(Float3) +
+               uvs.capacity() * sizeof(Float2) +
+               colors.capacity() * sizeof(Float4) +
+               indices.capacity() * sizeof(int32_t);
+    }
+
+    size_t SurfaceBuffers::get_byte_size() const
+    {
+        return vertices.size() * sizeof(Float3) +
+               normals.size() * sizeof(Float3) +
+               uvs.size() * sizeof(Float2) +
+               colors.size() * sizeof(Float4) +
+               indices.size() * sizeof(int32_t);
+    }
+
+    void MeshBuffers::clear()
+    {
+        for (SurfaceBuffers &surface : surfaces)
+            surface.clear();
+        fluid.clear();
+        faceCount = 0;
+    }
+
+    void MeshBuffers::reserve(const FaceCounts &p_faceCounts)
+    {
+        for (int type = 0; type < BlockTypes::TYPE_COUNT; type++)
+            surfaces[type].reserve(p_faceCounts.surfaces[type]);
+        fluid.reserve(p_faceCounts.fluid);
+    }
+
+    FaceCounts MeshBuffers::get_face_counts() const
+    {
+        FaceCounts faceCounts;
+        for (int type = 0; type < BlockTypes::TYPE_COUNT; type++)
+            faceCounts.surfaces[type] = static_cast<uint32_t>(surfaces[type].indices.size() / 6);
+        faceCounts.fluid = static_cast<uint32_t>(fluid.indices.size() / 6);
+
+        return faceCounts;
+    }
+
+    size_t MeshBuffers::get_capacity_byte_size() const
+    {
+        size_t bytes = fluid.get_capacity_byte_size();
+        for (const SurfaceBuffers &surface : surfaces)
+            bytes += surface.get_capacity_byte_size();
+
+        return bytes;
+    }
+
+    size_t MeshBuffers::get_byte_size() const
+    {
+        size_t bytes = fluid.get_byte_size();
+        for (const SurfaceBuffers &surface : surfaces)
+            bytes += surface.get_byte_size();
+
+        return bytes;
+    }
+
+    uint64_t MeshBuffers::get_hash() const
+    {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (const SurfaceBuffers &surface : surfaces)
+        {
+            hash_buffer(hash, surface.vertices);
+            hash_buffer(hash, surface.normals);
+            hash_buffer(hash, surface.uvs);
+            hash_buffer(hash, surface.colors);
+            hash_buffer(hash, surface.indices);
+        }
+
+        // Only hashed when present, so meshes without fluid hash as they did before fluids existed.
+        if (!fluid.indices.empty())
+        {
+            hash_buffer(hash, fluid.vertices);
+            hash_buffer(hash, fluid.normals);
+            hash_buffer(hash, fluid.uvs);
+            hash_buffer(hash, fluid.colors);
+            hash_buffer(hash, fluid.indices);
+        }
+
+        return hash;
+    }
+
+    void MeshBuilder::build(const ChunkView &p_view, MeshBuffers &r_mesh)
+    {
+        r_mesh.clear();
+
+        Capacities before[BlockTypes::TYPE_COUNT];
+        for (int type = 0; type < BlockTypes::TYPE_COUNT; type++)
+            before[type] = get_capacities(r_mesh.surfaces[type]);
+        const Capacities fluidBefore = get_capacities(r_mesh.fluid);
+
+        const int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        const int32_t Y = static_cast<int32_t>(CHUNK_HEIGHT_U);
+
+        for (int32_t y = 0; y < Y; y++)
+        {
+            for (int32_t z = 0; z < XZ; z++)
+            {
+                for (int32_t x = 0; x < XZ; x++)
+                {
+                    const Block &block = p_view.pBlocks[get_block_index(x, y, z)];
+                    if (!block.is_solid())
+                        continue;
+
+                    SurfaceBuffers &surface = r_mesh.surfaces[get_surface_type(block)];
+                    const Float2 uvOffset = get_tile_uv_offset(block.get_texture());
+
+                    for (const FaceDesc &face : FACES)
+                    {
+                        const Facing facing = get_facing(p_view, x, y, z, face);
+                        if (facing.pBlock && facing.pBlock->opaque())
+                            continue;
+
+                        add_face(surface, x, y, z, face, uvOffset, get_light_brightness(facing.light));
+                        r_mesh.faceCount++;
+                    }
+                }
+            }
+        }
+
+        if (p_view.pFluid)
+        {
+            visit_fluid_faces(p_view, [&r_mesh](int32_t x, int32_t y, int32_t z, uint8_t p_fluid, const FaceDesc &p_face,
+                                                const Facing &p_facing, float p_height)
+                              {
+                                  add_fluid_face(r_mesh.fluid, x, y, z, p_face, p_height,
+                                                 get_fluid_color(p_fluid, get_light_brightness(p_facing.light)));
+                                  r_mesh.faceCount++;
+                              });
+        }
+
+        for (int type = 0; type < BlockTypes::TYPE_COUNT; type++)
+            record_growth(r_mesh.surfaces[type], before[type]);
+        record_growth(r_mesh.fluid, fluidBefore);
+    }
+
+    void MeshBuilder::count_faces(const ChunkView &p_view, FaceCounts &r_faceCounts)
+    {
+        r_faceCounts = FaceCounts();
+
+        const int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        const int32_t Y = static_cast<int32_t>(CHUNK_HEIGHT_U);
+
+        for (int32_t y = 0; y < Y; y++)
+        {
+            for (int32_t z = 0; z < XZ; z++)
+            {
+                for (int32_t x = 0; x < XZ; x++)
+                {
+                    const Block &block = p_view.pBlocks[get_block_index(x, y, z)];
+                    if (!block.is_solid())
+                        continue;
+
+                    uint32_t &faces = r_faceCounts.surfaces[get_surface_type(block)];
+                    for (const FaceDesc &face : FACES)
+                    {
+                        const Facing facing = get_facing(p_view, x, y, z, face);
+                        if (!facing.pBlock || !facing.pBlock->opaque())
+                            faces++;
+                    }
+                }
+            }
+        }
+
+        if (p_view.pFluid)
+        {
+            visit_fluid_faces(p_view, [&r_faceCounts](int32_t, int32_t, int32_t, uint8_t, const FaceDesc &, const Facing &, float)
+                              { r_faceCounts.fluid++; });
+        }
+    }
+
+    void MeshBuilder::build_collision(const ChunkView &p_view, uint32_t p_section, std::vector<Float3> &r_faces)
+    {
+        const int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        const int32_t yStart = static_cast<int32_t>(p_section * SECTION_AXIS_LENGTH_U);
+        const int32_t yEnd = yStart + static_cast<int32_t>(SECTION_AXIS_LENGTH_U);
+
+        for (int32_t y = yStart; y < yEnd; y++)
+        {
+            for (int32_t z = 0; z < XZ; z++)
+            {
+                for (int32_t x = 0; x < XZ; x++)
+                {
+                    if (!p_view.pBlocks[get_block_index(x, y, z)].is_solid())
+                        continue;
+
+                    for (const FaceDesc &face : FACES)
+                    {
+                        const Facing facing = get_facing(p_view, x, y, z, face);
+                        if (facing.pBlock && facing.pBlock->is_solid())
+                            continue;
+
+                        Float3 points[4];
+                        for (int i = 0; i < 4; i++)
+                        {
+                            points[i] = { static_cast<float>(x + face.corners[i][0]),
+                                          static_cast<float>(y + face.corners[i][1]),
+                                          static_cast<float>(z + face.corners[i][2]) };
+                        }
+
+                        // Same clockwise winding as the render mesh, so front faces point out of the block.
+                        r_faces.push_back(points[0]);
+                        r_faces.push_back(points[2]);
+                        r_faces.push_back(points[1]);
+
+                        r_faces.push_back(points[0]);
+                        r_faces.push_back(points[3]);
+                        r_faces.push_back(points[2]);
+                    }
+                }
+            }
+        }
+    }
+
+    MeshBuffers MeshBufferPool::acquire()
+    {
+        if (m_spare.empty())
+            return MeshBuffers();
+
+        MeshBuffers buffers = std::move(m_spare.back());
+        m_spare.pop_back();
+        return buffers;
+    }
+
+    void MeshBufferPool::release(MeshBuffers &&p_buffers)
+    {
+        if (m_spare.size() >= MAX_SPARE)
+            return;
+
+        if (m_spare.capacity() < MAX_SPARE)
+            m_spare.reserve(MAX_SPARE);
+
+        p_buffers.clear();
+        m_spare.emplace_back(std::move(p_buffers));
+    }
+
+    uint64_t MeshBuilder::get_allocation_count()
+    {
+        return s_allocations.load(std::memory_order_relaxed);
+    }
+} //namespace Voxel::Core
@@ -0,0 +1,94 @@
+#include "hpp/voxel/core/sky_light.hpp"
+#include "hpp/voxel/core/chunk_view.hpp"
+#include <cstring>
+
+namespace Voxel::Core
+{
+    static constexpr uint32_t XZ = CHUNK_AXIS_LENGTH_U;
+    static constexpr uint8_t LIGHT_MAX = ChunkView::LIGHT_MAX;
+
+    void SkyLight::light_chunk(const Block *p_blocks, uint8_t *r_light, std::vector<uint32_t> &r_queue)
+    {
+        std::memset(r_light, 0, CHUNK_BLOCK_COUNT_MAX);
+        r_queue.clear();
+
+        for (uint32_t z = 0; z < XZ; z++)
+        {
+            for (uint32_t x = 0; x < XZ; x++)
+            {
+                for (int32_t y = static_cast<int32_t>(CHUNK_HEIGHT_U) - 1; y >= 0; y--)
+                {
+                    const size_t index = get_block_index(x, static_cast<uint32_t>(y), z);
+                    if (p_blocks[index].opaque())
+                        break;
+
+                    r_light[index] = LIGHT_MAX << 4;
+                }
+            }
+        }
+
+        static constexpr int32_t STEPS[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, 1, 0 }, { 0, -1, 0 } };
+
+        // Only full cells next to a darker open cell spread. Full cells above and below are full themselves, so only
+        // the sides are checked.
+        for (uint32_t z = 0; z < XZ; z++)
+        {
+            for (uint32_t x = 0; x < XZ; x++)
+            {
+                for (int32_t y = static_cast<int32_t>(CHUNK_HEIGHT_U) - 1; y >= 0; y--)
+                {
+                    const uint32_t index = static_cast<uint32_t>(get_block_index(x, static_cast<uint32_t>(y), z));
+                    if (ChunkView::get_sky(r_light[index]) != LIGHT_MAX)
+                        break;
+
+                    for (uint32_t side = 0; side < 4; side++)
+                    {
+                        const uint32_t nx = x + STEPS[side][0];
+                        const uint32_t nz = z + STEPS[side][2];
+                        if (nx >= XZ || nz >= XZ)
+                            continue;
+
+                        const size_t next = get_block_index(nx, static_cast<uint32_t>(y), nz);
+                        if (!p_blocks[next].opaque() && ChunkView::get_sky(r_light[next]) < LIGHT_MAX)
+                        {
+                            r_queue.push_back(index);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t head = 0; head < r_queue.size(); head++)
+        {
+            const uint32_t index = r_queue[head];
+            const uint8_t level = ChunkView::get_sky(r_light[index]);
+            if (level <= 1)
+                continue;
+
+            uint32_t x, y, z;
+            get_block_position(index, x, y, z);
+
+            for (const int32_t *step : STEPS)
+            {
+                const uint32_t nx = x + step[0];
+                const uint32_t ny = y + step[1];
+                const uint32_t nz = z + step[2];
+                if (nx >= XZ || ny >= CHUNK_HEIGHT_U || nz >= XZ)
+                    continue;
+
+                const uint32_t next = static_cast<uint32_t>(get_block_index(nx, ny, nz));
+                if (p_blocks[next].opaque())
+                    continue;
+
+                // Falling full light stays full, as down an open column.
+                const uint8_t spread = step[1] < 0 && level == LIGHT_MAX ? level : static_cast<uint8_t>(level - 1);
+                if (ChunkView::get_sky(r_light[next]) >= spread)
+                    continue;
+
+                r_light[next] = static_cast<uint8_t>(spread << 4);
+                r_queue.push_back(next);
+            }
+        }
+    }
+} //namespace Voxel::Core
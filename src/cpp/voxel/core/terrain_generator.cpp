@@ -0,0 +1,52 @@
+#include "hpp/voxel/core/terrain_generator.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/core/pcg32.hpp"
+
+namespace Voxel::Core
+{
+    uint64_t TerrainGenerator::get_chunk_seed(int64_t p_seed, int32_t p_chunkX, int32_t p_chunkZ)
+    {
+        // The chunk's grid key (see Tools::Hash::chunk_pos) spread by the golden ratio.
+        const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(p_chunkX)) << 32) | static_cast<uint32_t>(p_chunkZ);
+        return static_cast<uint64_t>(p_seed) ^ (key * 0x9E3779B97F4A7C15ull);
+    }
+
+    uint32_t TerrainGenerator::generate(const GenerationParams &p_params, int32_t p_chunkX, int32_t p_chunkZ, Block *r_blocks)
+    {
+        const uint32_t XZ = CHUNK_AXIS_LENGTH_U;
+        const uint32_t Y = CHUNK_HEIGHT_U;
+
+        // 1 / belowSeaLevel solid vs air at/below sea level, 1 / aboveSeaLevel above
+        const int32_t belowSeaLevel = 5;
+        const int32_t aboveSeaLevel = 100;
+
+        Pcg32 rng(get_chunk_seed(p_params.seed, p_chunkX, p_chunkZ));
+        uint32_t solidSectionMask = 0;
+
+        for (uint32_t y = 0; y < Y; y++)
+        {
+            const int32_t odds = static_cast<int32_t>(y) < p_params.seaLevel ? belowSeaLevel : aboveSeaLevel;
+
+            for (uint32_t z = 0; z < XZ; z++)
+            {
+                for (uint32_t x = 0; x < XZ; x++)
+                {
+                    Block &block = r_blocks[get_block_index(x, y, z)];
+                    block = Block();
+
+                    if (rng.range(1, odds) != 1)
+                        continue;
+
+                    // 0 is for unknown only
+                    const int32_t index = rng.range(1, BlockTypes::TYPE_COUNT - 1);
+                    block.set_material_type(static_cast<BlockTypes::MaterialType>(index));
+                    block.set_solid(true);
+                    block.set_texture(static_cast<BlockTypes::BlockTexture>(index));
+                    solidSectionMask |= 1u << (y / SECTION_AXIS_LENGTH_U);
+                }
+            }
+        }
+
+        return solidSectionMask;
+    }
+} //namespace Voxel::Core
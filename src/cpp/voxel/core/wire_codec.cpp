@@ -0,0 +1,386 @@
+#include "hpp/voxel/core/wire_codec.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/core/fluid.hpp"
+#include <algorithm>
+
+namespace Voxel::Core
+{
+    static inline uint32_t get_index_bits(uint32_t p_paletteSize)
+    {
+        uint32_t bits = 1;
+        while ((1u << bits) < p_paletteSize)
+            bits++;
+        return bits;
+    }
+
+    static bool is_uniform(const Block *p_section)
+    {
+        const int32_t id = p_section[0].to_id();
+        return std::all_of(p_section + 1, p_section + SECTION_BLOCK_COUNT, [id](const Block &p_block)
+                           { return p_block.to_id() == id; });
+    }
+
+    uint32_t WireCodec::get_section_index(uint32_t x, uint32_t y, uint32_t z)
+    {
+        return x + z * SECTION_AXIS_LENGTH_U + (y % SECTION_AXIS_LENGTH_U) * SECTION_AXIS_LENGTH_U * SECTION_AXIS_LENGTH_U;
+    }
+
+    void WireCodec::get_section_position(uint32_t p_index, uint32_t &r_x, uint32_t &r_y, uint32_t &r_z)
+    {
+        r_x = p_index % SECTION_AXIS_LENGTH_U;
+        r_z = (p_index / SECTION_AXIS_LENGTH_U) % SECTION_AXIS_LENGTH_U;
+        r_y = p_index / (SECTION_AXIS_LENGTH_U * SECTION_AXIS_LENGTH_U);
+    }
+
+    void WireCodec::encode_sections(const Block *p_blocks, uint32_t p_count, std::vector<uint8_t> &r_bytes)
+    {
+        // Block id -> palette slot + 1, cleared after each section.
+        uint16_t slots[Block::ID_COUNT] = {};
+        int32_t palette[Block::ID_COUNT];
+        uint32_t paletteSize = 0;
+
+        uint32_t section = 0;
+        while (section < p_count)
+        {
+            const Block *pSection = p_blocks + static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+
+            if (is_uniform(pSection))
+            {
+                uint32_t run = 1;
+                while (section + run < p_count && run < 0xFF)
+                {
+                    const Block *pNext = pSection + static_cast<size_t>(run) * SECTION_BLOCK_COUNT;
+                    if (pNext[0] != pSection[0] || !is_uniform(pNext))
+                        break;
+                    run++;
+                }
+
+                put_u16(r_bytes, 1);
+                put_u16(r_bytes, static_cast<uint32_t>(pSection[0].to_id()));
+                r_bytes.push_back(static_cast<uint8_t>(run));
+                section += run;
+                continue;
+            }
+
+            // Blocks go out in linear order whatever the storage layout, see to_storage_local.
+            paletteSize = 0;
+            for (uint32_t i = 0; i < SECTION_BLOCK_COUNT; i++)
+            {
+                const int32_t id = pSection[to_storage_local(i)].to_id();
+                if (slots[id] == 0)
+                {
+                    palette[paletteSize++] = id;
+                    slots[id] = static_cast<uint16_t>(paletteSize);
+                }
+            }
+
+            put_u16(r_bytes, paletteSize);
+            for (uint32_t i = 0; i < paletteSize; i++)
+                put_u16(r_bytes, static_cast<uint32_t>(palette[i]));
+
+            // Indices are packed least significant bit first.
+            const uint32_t bits = get_index_bits(paletteSize);
+            uint64_t accumulator = 0;
+            uint32_t pending = 0;
+            for (uint32_t i = 0; i < SECTION_BLOCK_COUNT; i++)
+            {
+                accumulator |= static_cast<uint64_t>(slots[pSection[to_storage_local(i)].to_id()] - 1) << pending;
+                pending += bits;
+
+                while (pending >= 8)
+                {
+                    r_bytes.push_back(static_cast<uint8_t>(accumulator & 0xFF));
+                    accumulator >>= 8;
+                    pending -= 8;
+                }
+            }
+
+            if (pending > 0)
+                r_bytes.push_back(static_cast<uint8_t>(accumulator & 0xFF));
+
+            for (uint32_t i = 0; i < paletteSize; i++)
+                slots[palette[i]] = 0;
+
+            section++;
+        }
+    }
+
+    const uint8_t *WireCodec::decode_sections(const uint8_t *p_cursor, const uint8_t *p_end, uint32_t p_count, Block *r_blocks)
+    {
+        Block palette[Block::ID_COUNT];
+
+        uint32_t section = 0;
+        while (section < p_count)
+        {
+            if (p_end - p_cursor < 2)
+                return nullptr;
+
+            const uint32_t paletteSize = get_u16(p_cursor);
+            p_cursor += 2;
+
+            if (paletteSize == 0 || paletteSize > static_cast<uint32_t>(Block::ID_COUNT) ||
+                p_end - p_cursor < static_cast<ptrdiff_t>(paletteSize * 2))
+                return nullptr;
+
+            for (uint32_t i = 0; i < paletteSize; i++, p_cursor += 2)
+            {
+                const int32_t id = static_cast<int32_t>(get_u16(p_cursor));
+                if (id >= Block::ID_COUNT)
+                    return nullptr;
+                palette[i] = Block::from_id(id);
+            }
+
+            Block *pSection = r_blocks + static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+
+            if (paletteSize == 1)
+            {
+                if (p_end - p_cursor < 1)
+                    return nullptr;
+
+                const uint32_t run = *p_cursor++;
+                if (run == 0 || run > p_count - section)
+                    return nullptr;
+
+                std::fill(pSection, pSection + static_cast<size_t>(run) * SECTION_BLOCK_COUNT, palette[0]);
+                section += run;
+                continue;
+            }
+
+            const uint32_t bits = get_index_bits(paletteSize);
+            const size_t packedSize = (static_cast<size_t>(SECTION_BLOCK_COUNT) * bits + 7) / 8;
+            if (static_cast<size_t>(p_end - p_cursor) < packedSize)
+                return nullptr;
+
+            const uint64_t mask = (1ull << bits) - 1;
+            uint64_t accumulator = 0;
+            uint32_t available = 0;
+            for (uint32_t i = 0; i < SECTION_BLOCK_COUNT; i++)
+            {
+                while (available < bits)
+                {
+                    accumulator |= static_cast<uint64_t>(*p_cursor++) << available;
+                    available += 8;
+                }
+
+                const uint32_t slot = static_cast<uint32_t>(accumulator & mask);
+                accumulator >>= bits;
+                available -= bits;
+
+                if (slot >= paletteSize)
+                    return nullptr;
+                pSection[to_storage_local(i)] = palette[slot];
+            }
+
+            section++;
+        }
+
+        return p_cursor;
+    }
+
+    void WireCodec::encode_fluid(const uint8_t *p_fluid, std::vector<uint8_t> &r_bytes)
+    {
+        if (!p_fluid)
+            return;
+
+        bool hasMarker = false;
+        for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; section++)
+        {
+            const uint8_t *pSection = p_fluid + static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+            size_t header = 0;
+            uint32_t runs = 0;
+
+            uint32_t index = 0;
+            while (index < SECTION_BLOCK_COUNT)
+            {
+                const uint8_t fluid = pSection[to_storage_local(index)];
+                if (fluid == 0)
+                {
+                    index++;
+                    continue;
+                }
+
+                uint32_t end = index + 1;
+                while (end < SECTION_BLOCK_COUNT && pSection[to_storage_local(end)] == fluid)
+                    end++;
+
+                if (!hasMarker)
+                {
+                    r_bytes.push_back(FLUID_MARKER);
+                    hasMarker = true;
+                }
+
+                if (runs == 0)
+                {
+                    header = r_bytes.size();
+                    r_bytes.push_back(static_cast<uint8_t>(section));
+                    put_u16(r_bytes, 0);
+                }
+
+                put_u16(r_bytes, index);
+                put_u16(r_bytes, end - index - 1);
+                r_bytes.push_back(fluid);
+                runs++;
+                index = end;
+            }
+
+            if (runs > 0)
+            {
+                r_bytes[header + 1] = static_cast<uint8_t>(runs & 0xFF);
+                r_bytes[header + 2] = static_cast<uint8_t>((runs >> 8) & 0xFF);
+            }
+        }
+    }
+
+    bool WireCodec::decode_fluid(const uint8_t *p_cursor, const uint8_t *p_end, uint8_t *r_fluid)
+    {
+        if (p_cursor == p_end || *p_cursor++ != FLUID_MARKER)
+            return false;
+
+        while (p_end - p_cursor >= 3)
+        {
+            const uint32_t section = p_cursor[0];
+            const uint32_t runs = get_u16(p_cursor + 1);
+            p_cursor += 3;
+
+            if (section >= CHUNK_SECTION_COUNT || p_end - p_cursor < static_cast<ptrdiff_t>(runs * 5))
+                return false;
+
+            uint8_t *pSection = r_fluid + static_cast<size_t>(section) * SECTION_BLOCK_COUNT;
+            for (uint32_t run = 0; run < runs; run++, p_cursor += 5)
+            {
+                const uint32_t start = get_u16(p_cursor);
+                const uint32_t length = get_u16(p_cursor + 2) + 1;
+                if (start >= SECTION_BLOCK_COUNT || length > SECTION_BLOCK_COUNT - start || p_cursor[4] == Fluid::NONE ||
+                    !Fluid::is_valid(p_cursor[4]))
+                    return false;
+
+                for (uint32_t i = start; i < start + length; i++)
+                    pSection[to_storage_local(i)] = p_cursor[4];
+            }
+        }
+
+        return p_cursor == p_end;
+    }
+
+    void WireCodec::encode_delta(int32_t p_chunkX, int32_t p_chunkZ, uint32_t p_section, const Block *p_blocks,
+                                 DeltaMode p_mode, const std::vector<uint16_t> &p_indices, std::vector<uint8_t> &r_bytes)
+    {
+        put_u32(r_bytes, static_cast<uint32_t>(p_chunkX));
+        put_u32(r_bytes, static_cast<uint32_t>(p_chunkZ));
+        r_bytes.push_back(static_cast<uint8_t>(p_section));
+        r_bytes.push_back(p_mode);
+
+        if (p_mode == DELTA_SNAPSHOT)
+        {
+            encode_sections(p_blocks, 1, r_bytes);
+            return;
+        }
+
+        put_u16(r_bytes, static_cast<uint32_t>(p_indices.size()));
+        for (uint16_t index : p_indices)
+        {
+            put_u16(r_bytes, index);
+            put_u16(r_bytes, static_cast<uint32_t>(p_blocks[to_storage_local(index)].to_id()));
+        }
+    }
+
+    void WireCodec::encode_fluid_delta(int32_t p_chunkX, int32_t p_chunkZ, uint32_t p_section, const uint8_t *p_fluid,
+                                       const std::vector<uint16_t> &p_indices, std::vector<uint8_t> &r_bytes)
+    {
+        put_u32(r_bytes, static_cast<uint32_t>(p_chunkX));
+        put_u32(r_bytes, static_cast<uint32_t>(p_chunkZ));
+        r_bytes.push_back(static_cast<uint8_t>(p_section));
+        r_bytes.push_back(DELTA_FLUID);
+
+        put_u16(r_bytes, static_cast<uint32_t>(p_indices.size()));
+        for (uint16_t index : p_indices)
+        {
+            put_u16(r_bytes, index);
+            r_bytes.push_back(p_fluid ? p_fluid[to_storage_local(index)] : 0);
+        }
+    }
+
+    bool WireCodec::decode_deltas(const uint8_t *p_cursor, const uint8_t *p_end, uint32_t p_count, std::vector<SectionDelta> &r_deltas)
+    {
+        // Entries keep their buffers, so decoding batch after batch into the same vector stops allocating.
+        r_deltas.resize(p_count);
+
+        for (uint32_t entry = 0; entry < p_count; entry++)
+        {
+            if (p_end - p_cursor < 10)
+                return false;
+
+            SectionDelta &delta = r_deltas[entry];
+            delta.indices.clear();
+            delta.blocks.clear();
+            delta.fluids.clear();
+            delta.chunkX = static_cast<int32_t>(get_u32(p_cursor));
+            delta.chunkZ = static_cast<int32_t>(get_u32(p_cursor + 4));
+            delta.section = p_cursor[8];
+            delta.mode = static_cast<DeltaMode>(p_cursor[9]);
+            p_cursor += 10;
+
+            if (delta.section >= CHUNK_SECTION_COUNT)
+                return false;
+
+            if (delta.mode == DELTA_SNAPSHOT)
+            {
+                delta.blocks.resize(SECTION_BLOCK_COUNT);
+                p_cursor = decode_sections(p_cursor, p_end, 1, delta.blocks.data());
+                if (!p_cursor)
+                    return false;
+            }
+            else if (delta.mode == DELTA_SPARSE)
+            {
+                if (p_end - p_cursor < 2)
+                    return false;
+
+                const uint32_t changes = get_u16(p_cursor);
+                p_cursor += 2;
+                if (changes > SECTION_BLOCK_COUNT || p_end - p_cursor < static_cast<ptrdiff_t>(changes * 4))
+                    return false;
+
+                delta.indices.reserve(changes);
+                delta.blocks.reserve(changes);
+                for (uint32_t i = 0; i < changes; i++, p_cursor += 4)
+                {
+                    const uint32_t index = get_u16(p_cursor);
+                    const int32_t id = static_cast<int32_t>(get_u16(p_cursor + 2));
+                    if (index >= SECTION_BLOCK_COUNT || id >= Block::ID_COUNT)
+                        return false;
+
+                    delta.indices.emplace_back(static_cast<uint16_t>(index));
+                    delta.blocks.emplace_back(Block::from_id(id));
+                }
+            }
+            else if (delta.mode == DELTA_FLUID)
+            {
+                if (p_end - p_cursor < 2)
+                    return false;
+
+                const uint32_t changes = get_u16(p_cursor);
+                p_cursor += 2;
+                if (changes > SECTION_BLOCK_COUNT || p_end - p_cursor < static_cast<ptrdiff_t>(changes * 3))
+                    return false;
+
+                delta.indices.reserve(changes);
+                delta.fluids.reserve(changes);
+                for (uint32_t i = 0; i < changes; i++, p_cursor += 3)
+                {
+                    const uint32_t index = get_u16(p_cursor);
+                    if (index >= SECTION_BLOCK_COUNT || !Fluid::is_valid(p_cursor[2]))
+                        return false;
+
+                    delta.indices.emplace_back(static_cast<uint16_t>(index));
+                    delta.fluids.emplace_back(p_cursor[2]);
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return p_cursor == p_end;
+    }
+} //namespace Voxel::Core
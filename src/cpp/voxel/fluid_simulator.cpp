@@ -0,0 +1,431 @@
+#include "hpp/voxel/fluid_simulator.hpp"
+#include "hpp/tools/bits.hpp"
+#include "hpp/tools/hash.hpp"
+#include "hpp/tools/trace.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/world.hpp"
+#include <algorithm>
+
+using Voxel::Core::Fluid;
+
+namespace Voxel
+{
+    // Worker threads beside the calling one, when the hardware has them.
+    static constexpr uint32_t MAX_WORKERS = 4;
+
+    static constexpr int32_t HORIZONTAL[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+    struct Cell
+    {
+        uint8_t fluid;
+        bool solid;
+    };
+
+    // Moves (x, z) into the chunk that holds it, one chunk away at most. Null when that chunk isn't loaded.
+    static Chunk *resolve_chunk(Chunk *p_chunk, int32_t &r_x, int32_t &r_z)
+    {
+        constexpr int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+
+        if (r_x < 0)
+        {
+            p_chunk = p_chunk->get_neighbors().neg_x;
+            r_x += XZ;
+        }
+        else if (r_x >= XZ)
+        {
+            p_chunk = p_chunk->get_neighbors().pos_x;
+            r_x -= XZ;
+        }
+
+        if (!p_chunk)
+            return nullptr;
+
+        if (r_z < 0)
+        {
+            p_chunk = p_chunk->get_neighbors().neg_z;
+            r_z += XZ;
+        }
+        else if (r_z >= XZ)
+        {
+            p_chunk = p_chunk->get_neighbors().pos_z;
+            r_z -= XZ;
+        }
+
+        return p_chunk;
+    }
+
+    // The bottom of the world and unloaded chunks hold fluid like solid blocks, the top of the world is open.
+    static Cell read_cell(Chunk *p_chunk, int32_t x, int32_t y, int32_t z)
+    {
+        if (y < 0)
+            return { Fluid::NONE, true };
+        if (y >= static_cast<int32_t>(CHUNK_HEIGHT_U))
+            return { Fluid::NONE, false };
+
+        Chunk *pChunk = resolve_chunk(p_chunk, x, z);
+        if (!pChunk)
+            return { Fluid::NONE, true };
+
+        const size_t index = Core::get_block_index(x, y, z);
+        return { pChunk->get_fluid(index), pChunk->get_block(index)->is_solid() };
+    }
+
+    // The automaton's rule, see FluidSimulator.
+    static uint8_t compute_fluid(Chunk *p_chunk, int32_t x, int32_t y, int32_t z)
+    {
+        const Cell self = read_cell(p_chunk, x, y, z);
+        if (self.solid)
+            return Fluid::NONE;
+        if (Fluid::is_source(self.fluid))
+            return self.fluid;
+
+        uint8_t next = Fluid::NONE;
+        uint8_t nextLevel = 0;
+
+        const Cell above = read_cell(p_chunk, x, y + 1, z);
+        if (Fluid::get_level(above.fluid) > 0)
+        {
+            nextLevel = Fluid::LEVEL_MAX - 1;
+            next = Fluid::make(Fluid::get_kind(above.fluid), nextLevel);
+        }
+
+        for (const int32_t *step : HORIZONTAL)
+        {
+            const Cell side = read_cell(p_chunk, x + step[0], y, z + step[1]);
+            const uint8_t sideLevel = Fluid::get_level(side.fluid);
+            const Fluid::Kind kind = Fluid::get_kind(side.fluid);
+            if (side.solid || sideLevel <= Fluid::get_decay(kind) || sideLevel - Fluid::get_decay(kind) <= nextLevel)
+                continue;
+
+            // Falling fluid doesn't spread until it lands.
+            const Cell below = read_cell(p_chunk, x + step[0], y - 1, z + step[1]);
+            if (!below.solid && !Fluid::is_source(below.fluid))
+                continue;
+
+            nextLevel = static_cast<uint8_t>(sideLevel - Fluid::get_decay(kind));
+            next = Fluid::make(kind, nextLevel);
+        }
+
+        return next;
+    }
+
+    FluidSimulator::~FluidSimulator()
+    {
+        stop_workers();
+    }
+
+    void FluidSimulator::tick(World *p_world, uint64_t p_tick)
+    {
+        if (m_active.empty() || p_tick % TICKS_PER_STEP != 0)
+            return;
+
+        VOXEL_TRACE_ZONE("FluidSimulator::tick");
+
+        gather_jobs(p_tick);
+        if (m_jobCount == 0)
+            return;
+
+        run_jobs();
+        apply_jobs(p_world);
+    }
+
+    bool FluidSimulator::set_fluid(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, uint8_t p_fluid)
+    {
+        const size_t index = p_chunk->get_block_index_local(x, y, z);
+        if (p_fluid != Fluid::NONE && p_chunk->get_block(index)->is_solid())
+            return false;
+
+        if (p_chunk->get_fluid(index) == p_fluid)
+            return true;
+
+        p_chunk->set_fluid(index, p_fluid);
+        p_world->mark_fluid_dirty(p_chunk, x, y, z);
+
+        // The cell itself too, a removed cell refills from its neighbors if they still feed it.
+        activate(p_chunk, x, y, z);
+        activate_dependents(p_chunk, x, y, z);
+        return true;
+    }
+
+    void FluidSimulator::on_span_changed(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+    {
+        const Chunk::Neighbors &neighbors = p_chunk->get_neighbors();
+        const Chunk *nearby[] = { p_chunk, neighbors.pos_x, neighbors.neg_x, neighbors.pos_z, neighbors.neg_z };
+        if (std::none_of(std::begin(nearby), std::end(nearby), [](const Chunk *p_nearby)
+                         { return p_nearby && p_nearby->get_fluid_data(); }))
+            return;
+
+        for (uint32_t x = x0; x <= x1; x++)
+        {
+            activate(p_chunk, x, y, z);
+            activate_dependents(p_chunk, x, y, z);
+        }
+    }
+
+    void FluidSimulator::on_chunk_replaced(Chunk *p_chunk)
+    {
+        constexpr int32_t XZ = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        constexpr int32_t HEIGHT = static_cast<int32_t>(CHUNK_HEIGHT_U);
+
+        // Cells woken before the replacement index fluid that is gone.
+        m_active.erase(Tools::Hash::chunk(p_chunk));
+
+        if (p_chunk->get_fluid_data())
+        {
+            for (uint32_t index = 0; index < CHUNK_BLOCK_COUNT_MAX; index++)
+            {
+                if (p_chunk->get_fluid(index) == Fluid::NONE)
+                    continue;
+
+                uint32_t x, y, z;
+                Core::get_block_position(index, x, y, z);
+                activate(p_chunk, x, y, z);
+                activate_dependents(p_chunk, x, y, z);
+            }
+        }
+
+        // Fluid across the borders rested on cells that changed. Empty cells there only fill from this chunk's fluid,
+        // which woke them above.
+        const Chunk::Neighbors &neighbors = p_chunk->get_neighbors();
+        Chunk *borders[] = { neighbors.pos_x, neighbors.neg_x, neighbors.pos_z, neighbors.neg_z };
+        for (int side = 0; side < 4; side++)
+        {
+            Chunk *pNeighbor = borders[side];
+            if (!pNeighbor || !pNeighbor->get_fluid_data())
+                continue;
+
+            for (int32_t y = 0; y < HEIGHT; y++)
+            {
+                for (int32_t i = 0; i < XZ; i++)
+                {
+                    // The neighbor's edge that faces this chunk.
+                    const int32_t x = side == 0 ? 0 : (side == 1 ? XZ - 1 : i);
+                    const int32_t z = side == 2 ? 0 : (side == 3 ? XZ - 1 : i);
+                    if (pNeighbor->get_fluid(Core::get_block_index(x, y, z)) == Fluid::NONE)
+                        continue;
+
+                    activate(pNeighbor, x, y, z);
+                    activate_dependents(pNeighbor, x, y, z);
+                }
+            }
+        }
+    }
+
+    void FluidSimulator::on_chunk_unload(Chunk *p_chunk)
+    {
+        m_active.erase(Tools::Hash::chunk(p_chunk));
+    }
+
+    size_t FluidSimulator::get_active_cell_count() const
+    {
+        size_t count = 0;
+        for (const auto &kvp : m_active)
+        {
+            for (const std::vector<uint16_t> &cells : kvp.second.cells)
+                count += cells.size();
+        }
+
+        return count;
+    }
+
+    size_t FluidSimulator::get_active_section_count() const
+    {
+        size_t count = 0;
+        for (const auto &kvp : m_active)
+            count += Tools::Bits::count_set_bits(kvp.second.sectionMask);
+
+        return count;
+    }
+
+    void FluidSimulator::activate(Chunk *p_chunk, int32_t x, int32_t y, int32_t z)
+    {
+        if (y < 0 || y >= static_cast<int32_t>(CHUNK_HEIGHT_U))
+            return;
+
+        Chunk *pChunk = resolve_chunk(p_chunk, x, z);
+        if (!pChunk)
+            return;
+
+        const uint32_t section = static_cast<uint32_t>(y) / SECTION_AXIS_LENGTH_U;
+
+        ActiveChunk &active = m_active[Tools::Hash::chunk(pChunk)];
+        active.pChunk = pChunk;
+        active.sectionMask |= 1u << section;
+        active.cells[section].push_back(static_cast<uint16_t>(
+                Core::get_section_local_index(x, static_cast<uint32_t>(y) % SECTION_AXIS_LENGTH_U, z)));
+    }
+
+    void FluidSimulator::activate_dependents(Chunk *p_chunk, int32_t x, int32_t y, int32_t z)
+    {
+        activate(p_chunk, x, y + 1, z);
+        activate(p_chunk, x, y - 1, z);
+
+        for (const int32_t *step : HORIZONTAL)
+        {
+            activate(p_chunk, x + step[0], y, z + step[1]);
+            // Cells beside the one above flow across this one when it holds a source or a block.
+            activate(p_chunk, x + step[0], y + 1, z + step[1]);
+        }
+    }
+
+    void FluidSimulator::gather_jobs(uint64_t p_tick)
+    {
+        m_jobCount = 0;
+
+        for (auto iterator = m_active.begin(); iterator != m_active.end();)
+        {
+            ActiveChunk &active = iterator->second;
+            if (active.pChunk->get_simulation_stamp() != p_tick)
+            {
+                ++iterator;
+                continue;
+            }
+
+            uint32_t mask = active.sectionMask;
+            while (mask != 0)
+            {
+                const uint32_t section = Tools::Bits::count_trailing_zeros(mask);
+                mask &= mask - 1;
+
+                if (m_jobCount == m_jobs.size())
+                    m_jobs.emplace_back();
+
+                Job &job = m_jobs[m_jobCount++];
+                job.pChunk = active.pChunk;
+                job.section = section;
+                job.cells.clear();
+                job.cells.swap(active.cells[section]);
+            }
+
+            iterator = m_active.erase(iterator);
+        }
+    }
+
+    void FluidSimulator::run_jobs()
+    {
+        if (m_jobCount >= PARALLEL_MIN_SECTIONS && m_workers.empty())
+            start_workers();
+
+        if (m_jobCount < PARALLEL_MIN_SECTIONS || m_workers.empty())
+        {
+            for (size_t i = 0; i < m_jobCount; i++)
+                step_section(m_jobs[i]);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_nextJob.store(0, std::memory_order_relaxed);
+            m_busyWorkers = static_cast<uint32_t>(m_workers.size());
+            m_generation++;
+        }
+        m_wake.notify_all();
+
+        // The calling thread takes jobs too instead of only waiting.
+        take_jobs();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]()
+                    { return m_busyWorkers == 0; });
+    }
+
+    void FluidSimulator::apply_jobs(World *p_world)
+    {
+        for (size_t i = 0; i < m_jobCount; i++)
+        {
+            Job &job = m_jobs[i];
+            const uint32_t baseY = job.section * SECTION_AXIS_LENGTH_U;
+
+            for (const Change &change : job.changes)
+            {
+                uint32_t x, y, z;
+                Core::get_section_local_position(change.local, x, y, z);
+                y += baseY;
+
+                job.pChunk->set_fluid(Core::get_block_index(x, y, z), change.fluid);
+                p_world->mark_fluid_dirty(job.pChunk, x, y, z);
+                activate_dependents(job.pChunk, x, y, z);
+            }
+
+            job.changes.clear();
+        }
+    }
+
+    void FluidSimulator::step_section(Job &r_job)
+    {
+        // A cell can be woken by several neighbors at once.
+        std::sort(r_job.cells.begin(), r_job.cells.end());
+        r_job.cells.erase(std::unique(r_job.cells.begin(), r_job.cells.end()), r_job.cells.end());
+
+        const uint32_t baseY = r_job.section * SECTION_AXIS_LENGTH_U;
+
+        for (uint16_t local : r_job.cells)
+        {
+            uint32_t x, y, z;
+            Core::get_section_local_position(local, x, y, z);
+            y += baseY;
+
+            const uint8_t next = compute_fluid(r_job.pChunk, x, y, z);
+            if (next != r_job.pChunk->get_fluid(Core::get_block_index(x, y, z)))
+                r_job.changes.push_back({ local, next });
+        }
+    }
+
+    void FluidSimulator::start_workers()
+    {
+        const uint32_t hardware = std::thread::hardware_concurrency();
+        const uint32_t count = hardware > 1 ? std::min(hardware - 1, MAX_WORKERS) : 0;
+
+        m_stopping = false;
+        for (uint32_t i = 0; i < count; i++)
+            m_workers.emplace_back(&FluidSimulator::run_worker, this, m_generation);
+    }
+
+    void FluidSimulator::stop_workers()
+    {
+        if (m_workers.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_wake.notify_all();
+        for (std::thread &worker : m_workers)
+            worker.join();
+        m_workers.clear();
+    }
+
+    void FluidSimulator::run_worker(uint64_t p_generation)
+    {
+        Tools::Trace::set_thread_name("Fluid worker");
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            m_wake.wait(lock, [this, p_generation]()
+                        { return m_stopping || m_generation != p_generation; });
+            if (m_stopping)
+                return;
+
+            p_generation = m_generation;
+            lock.unlock();
+            take_jobs();
+            lock.lock();
+
+            if (--m_busyWorkers == 0)
+                m_done.notify_one();
+        }
+    }
+
+    void FluidSimulator::take_jobs()
+    {
+        VOXEL_TRACE_ZONE("FluidSimulator::step");
+
+        size_t i;
+        while ((i = m_nextJob.fetch_add(1, std::memory_order_relaxed)) < m_jobCount)
+            step_section(m_jobs[i]);
+    }
+} //namespace Voxel
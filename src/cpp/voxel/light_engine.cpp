@@ -0,0 +1,301 @@
+#include "hpp/voxel/light_engine.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/constants.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/core/sky_light.hpp"
+#include "hpp/voxel/world.hpp"
+#include <algorithm>
+#include <cstdint>
+
+using namespace godot;
+
+namespace Voxel
+{
+    enum Direction
+    {
+        DIR_POS_X = 0,
+        DIR_NEG_X,
+        DIR_POS_Z,
+        DIR_NEG_Z,
+        DIR_POS_Y,
+        DIR_NEG_Y,
+        DIR_COUNT
+    };
+
+    static constexpr uint32_t XZ = CHUNK_AXIS_LENGTH_U;
+    static constexpr uint32_t LAYER = CHUNK_AXIS_LENGTH_U * CHUNK_AXIS_LENGTH_U;
+
+    static uint8_t get_level(const Chunk *p_chunk, uint32_t p_index, LightEngine::Channel p_channel)
+    {
+        const uint8_t light = p_chunk->get_light(p_index);
+        return p_channel == LightEngine::CHANNEL_SKY ? LightEngine::get_sky(light) : LightEngine::get_block(light);
+    }
+
+    // Steps one cell in p_direction, following the neighbor links across chunk borders. Fails at the top and bottom
+    // of the world and into unloaded chunks.
+    static bool step(Chunk *p_chunk, uint32_t p_index, int p_direction, Chunk *&r_chunk, uint32_t &r_index)
+    {
+        uint32_t x, y, z;
+        Core::get_block_position(p_index, x, y, z);
+        const Chunk::Neighbors &neighbors = p_chunk->get_neighbors();
+
+        r_chunk = p_chunk;
+        switch (p_direction)
+        {
+        case DIR_POS_X:
+            if (x == XZ - 1)
+                r_chunk = neighbors.pos_x;
+            x = (x + 1) & (XZ - 1);
+            break;
+        case DIR_NEG_X:
+            if (x == 0)
+                r_chunk = neighbors.neg_x;
+            x = (x - 1) & (XZ - 1);
+            break;
+        case DIR_POS_Z:
+            if (z == XZ - 1)
+                r_chunk = neighbors.pos_z;
+            z = (z + 1) & (XZ - 1);
+            break;
+        case DIR_NEG_Z:
+            if (z == 0)
+                r_chunk = neighbors.neg_z;
+            z = (z - 1) & (XZ - 1);
+            break;
+        case DIR_POS_Y:
+            if (y == CHUNK_HEIGHT_U - 1)
+                return false;
+            y++;
+            break;
+        default:
+            if (y == 0)
+                return false;
+            y--;
+            break;
+        }
+
+        r_index = static_cast<uint32_t>(Core::get_block_index(x, y, z));
+        return r_chunk != nullptr;
+    }
+
+    void LightEngine::set_emission(Resource::Pallet::BlockTexture p_texture, uint8_t p_level)
+    {
+        m_emission[p_texture] = std::min(p_level, LIGHT_MAX);
+        m_hasEmitters = std::any_of(std::begin(m_emission), std::end(m_emission), [](uint8_t p_emission)
+                                    { return p_emission > 0; });
+    }
+
+    void LightEngine::write_level(World *p_world, Chunk *p_chunk, uint32_t p_index, Channel p_channel, uint8_t p_level)
+    {
+        const uint8_t light = p_chunk->get_light(p_index);
+        p_chunk->set_light(p_index, p_channel == CHANNEL_SKY ? static_cast<uint8_t>((light & 0x0F) | (p_level << 4))
+                                                             : static_cast<uint8_t>((light & 0xF0) | p_level));
+
+        if (p_chunk == m_pLighting)
+            return;
+
+        uint32_t x, y, z;
+        Core::get_block_position(p_index, x, y, z);
+        p_world->mark_span_remesh(p_chunk, x, x, y, z);
+    }
+
+    void LightEngine::light_chunk(World *p_world, Chunk *p_chunk)
+    {
+        m_pLighting = p_chunk;
+
+        // The chunk's own sky light first, without the neighbor links.
+        uint8_t *pLight = p_chunk->get_light_data();
+        Core::SkyLight::light_chunk(p_chunk->get_block_data(), pLight, m_skyQueue);
+
+        if (m_hasEmitters)
+        {
+            for (uint32_t index = 0; index < CHUNK_BLOCK_COUNT_MAX; index++)
+            {
+                const uint8_t emission = get_emission(p_chunk->get_block(index));
+                if (emission == 0)
+                    continue;
+
+                pLight[index] |= emission;
+                m_add[CHANNEL_BLOCK].push_back({ p_chunk, index });
+            }
+        }
+
+        // Light exchanges across every border with a loaded neighbor: the neighbor's facing cells flow in and this
+        // chunk's flow out.
+        const Chunk::Neighbors &neighbors = p_chunk->get_neighbors();
+        Chunk *borders[] = { neighbors.pos_x, neighbors.neg_x, neighbors.pos_z, neighbors.neg_z };
+        for (int side = 0; side < 4; side++)
+        {
+            Chunk *pNeighbor = borders[side];
+            if (!pNeighbor)
+                continue;
+
+            for (uint32_t y = 0; y < CHUNK_HEIGHT_U; y++)
+            {
+                for (uint32_t i = 0; i < XZ; i++)
+                {
+                    // The neighbor's edge that faces this chunk, and this chunk's edge facing it.
+                    const uint32_t x = side == 0 ? 0 : (side == 1 ? XZ - 1 : i);
+                    const uint32_t z = side == 2 ? 0 : (side == 3 ? XZ - 1 : i);
+                    const uint32_t index = static_cast<uint32_t>(Core::get_block_index(x, y, z));
+                    const uint32_t own = static_cast<uint32_t>(Core::get_block_index(side < 2 ? XZ - 1 - x : x, y, side < 2 ? z : XZ - 1 - z));
+
+                    const uint8_t light = pNeighbor->get_light(index);
+                    if (get_sky(light) > 1)
+                        m_add[CHANNEL_SKY].push_back({ pNeighbor, index });
+                    if (get_block(light) > 1)
+                        m_add[CHANNEL_BLOCK].push_back({ pNeighbor, index });
+                    if (get_sky(pLight[own]) > 1)
+                        m_add[CHANNEL_SKY].push_back({ p_chunk, own });
+                }
+            }
+        }
+
+        run_add(p_world, CHANNEL_SKY);
+        run_add(p_world, CHANNEL_BLOCK);
+
+        m_pLighting = nullptr;
+    }
+
+    void LightEngine::queue_span(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+    {
+        for (uint32_t x = x0; x <= x1; x++)
+            m_changed.push_back({ p_chunk, static_cast<uint32_t>(p_chunk->get_block_index_local(x, y, z)) });
+    }
+
+    void LightEngine::propagate(World *p_world)
+    {
+        if (m_changed.empty())
+            return;
+
+        for (const Node &node : m_changed)
+        {
+            // Whatever lit the changed cell may no longer apply, so it is cleared and refilled from its surroundings.
+            for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+            {
+                const uint8_t level = get_level(node.pChunk, node.index, static_cast<Channel>(channel));
+                if (level == 0)
+                    continue;
+
+                write_level(p_world, node.pChunk, node.index, static_cast<Channel>(channel), 0);
+                m_remove[channel].push_back({ node.pChunk, node.index, level });
+            }
+
+            const Block *pBlock = node.pChunk->get_block(node.index);
+            const uint8_t emission = get_emission(pBlock);
+            if (emission > 0)
+            {
+                write_level(p_world, node.pChunk, node.index, CHANNEL_BLOCK, emission);
+                m_add[CHANNEL_BLOCK].push_back(node);
+            }
+
+            if (pBlock->opaque())
+                continue;
+
+            for (int direction = 0; direction < DIR_COUNT; direction++)
+            {
+                Chunk *pNext;
+                uint32_t next;
+                if (!step(node.pChunk, node.index, direction, pNext, next))
+                    continue;
+
+                m_add[CHANNEL_SKY].push_back({ pNext, next });
+                m_add[CHANNEL_BLOCK].push_back({ pNext, next });
+            }
+        }
+
+        m_changed.clear();
+
+        for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+        {
+            run_removal(p_world, static_cast<Channel>(channel));
+            run_add(p_world, static_cast<Channel>(channel));
+        }
+    }
+
+    void LightEngine::run_removal(World *p_world, Channel p_channel)
+    {
+        std::vector<RemovalNode> &queue = m_remove[p_channel];
+
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            const RemovalNode node = queue[head];
+
+            for (int direction = 0; direction < DIR_COUNT; direction++)
+            {
+                Chunk *pNext;
+                uint32_t next;
+                if (!step(node.pChunk, node.index, direction, pNext, next))
+                    continue;
+
+                const uint8_t level = get_level(pNext, next, p_channel);
+                if (level == 0)
+                    continue;
+
+                // Dimmer cells were lit through the removed one (as is full sky directly below full sky), brighter
+                // or equal ones have another source and refill the gap.
+                const bool skyColumn = p_channel == CHANNEL_SKY && direction == DIR_NEG_Y && node.level == LIGHT_MAX;
+                if (level < node.level || (skyColumn && level == LIGHT_MAX))
+                {
+                    write_level(p_world, pNext, next, p_channel, 0);
+                    queue.push_back({ pNext, next, level });
+
+                    const uint8_t emission = p_channel == CHANNEL_BLOCK ? get_emission(pNext->get_block(next)) : 0;
+                    if (emission > 0)
+                    {
+                        write_level(p_world, pNext, next, p_channel, emission);
+                        m_add[p_channel].push_back({ pNext, next });
+                    }
+                }
+                else
+                {
+                    m_add[p_channel].push_back({ pNext, next });
+                }
+            }
+        }
+
+        queue.clear();
+    }
+
+    void LightEngine::run_add(World *p_world, Channel p_channel)
+    {
+        std::vector<Node> &queue = m_add[p_channel];
+
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            const Node node = queue[head];
+            const uint8_t level = get_level(node.pChunk, node.index, p_channel);
+            if (level <= 1)
+                continue;
+
+            for (int direction = 0; direction < DIR_COUNT; direction++)
+            {
+                Chunk *pNext;
+                uint32_t next;
+                if (!step(node.pChunk, node.index, direction, pNext, next))
+                    continue;
+
+                if (pNext->get_block(next)->opaque())
+                    continue;
+
+                const bool skyColumn = p_channel == CHANNEL_SKY && direction == DIR_NEG_Y && level == LIGHT_MAX;
+                const uint8_t spread = skyColumn ? LIGHT_MAX : static_cast<uint8_t>(level - 1);
+                if (get_level(pNext, next, p_channel) >= spread)
+                    continue;
+
+                write_level(p_world, pNext, next, p_channel, spread);
+                queue.push_back({ pNext, next });
+            }
+        }
+
+        queue.clear();
+    }
+
+    void LightEngine::on_chunk_unload(Chunk *p_chunk)
+    {
+        auto references = [p_chunk](const Node &p_node)
+        { return p_node.pChunk == p_chunk; };
+
+        m_changed.erase(std::remove_if(m_changed.begin(), m_changed.end(), references), m_changed.end());
+    }
+} //namespace Voxel
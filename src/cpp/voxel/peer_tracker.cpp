@@ -0,0 +1,157 @@
+#include "hpp/voxel/peer_tracker.hpp"
+#include "hpp/tools/hash.hpp"
+#include "hpp/tools/log.hpp"
+#include "hpp/voxel/chunk_grid.hpp"
+#include "hpp/voxel/chunk_wire.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+using namespace godot;
+
+namespace Voxel
+{
+    void PeerTracker::add_peer(int32_t p_peerId, Chunk::ChunkPos p_center, int32_t p_radius, int64_t p_ticket)
+    {
+        Peer peer{};
+        peer.center = p_center;
+        peer.radius = p_radius;
+        peer.ticket = p_ticket;
+        m_peers[p_peerId] = std::move(peer);
+
+        VOXEL_LOG_DEBUG("Tracking peer {} with radius {}.", p_peerId, p_radius);
+    }
+
+    int64_t PeerTracker::remove_peer(int32_t p_peerId)
+    {
+        auto iterator = m_peers.find(p_peerId);
+        if (iterator == m_peers.end())
+            return 0;
+
+        const int64_t ticket = iterator->second.ticket;
+        m_peers.erase(iterator);
+        return ticket;
+    }
+
+    int64_t PeerTracker::get_ticket(int32_t p_peerId) const
+    {
+        auto iterator = m_peers.find(p_peerId);
+        return iterator != m_peers.end() ? iterator->second.ticket : 0;
+    }
+
+    void PeerTracker::set_peer_view(int32_t p_peerId, Chunk::ChunkPos p_center, Vector2 p_viewDirection)
+    {
+        auto iterator = m_peers.find(p_peerId);
+        if (iterator == m_peers.end())
+            return;
+
+        const float length = std::sqrt(p_viewDirection.x * p_viewDirection.x + p_viewDirection.y * p_viewDirection.y);
+        iterator->second.center = p_center;
+        iterator->second.viewDirection = length > 0.0f ? Vector2(p_viewDirection.x / length, p_viewDirection.y / length) : Vector2();
+    }
+
+    void PeerTracker::update(const ChunkGrid &p_chunks, double p_delta)
+    {
+        m_packetCache.clear();
+
+        for (auto &kvp : m_peers)
+            update_peer(kvp.second, p_chunks, p_delta);
+    }
+
+    std::vector<PackedByteArray> PeerTracker::take_packets(int32_t p_peerId)
+    {
+        std::vector<PackedByteArray> packets;
+
+        auto iterator = m_peers.find(p_peerId);
+        if (iterator != m_peers.end())
+            packets.swap(iterator->second.outgoing);
+
+        return packets;
+    }
+
+    size_t PeerTracker::get_sent_count(int32_t p_peerId) const
+    {
+        auto iterator = m_peers.find(p_peerId);
+        return iterator != m_peers.end() ? iterator->second.sent.size() : 0;
+    }
+
+    void PeerTracker::update_peer(Peer &r_peer, const ChunkGrid &p_chunks, double p_delta)
+    {
+        const double rate = static_cast<double>(m_bytesPerSecond);
+        r_peer.budgetBytes = std::min(r_peer.budgetBytes + rate * p_delta, rate * MAX_BURST_SECONDS);
+
+        // One chunk of slack past the radius, so a peer pacing along a chunk border isn't sent the same row again
+        // and again.
+        std::vector<Chunk::ChunkPos> dropped;
+        for (auto iterator = r_peer.sent.begin(); iterator != r_peer.sent.end();)
+        {
+            const Chunk::ChunkPos pos = Tools::Hash::chunk_pos_from(iterator->first);
+            if (std::max(std::abs(pos.x - r_peer.center.x), std::abs(pos.y - r_peer.center.y)) > r_peer.radius + 1)
+            {
+                dropped.emplace_back(pos);
+                iterator = r_peer.sent.erase(iterator);
+            }
+            else
+            {
+                ++iterator;
+            }
+        }
+
+        if (!dropped.empty())
+            r_peer.outgoing.emplace_back(ChunkWire::encode_unload(dropped));
+
+        if (r_peer.budgetBytes <= 0.0)
+            return;
+
+        m_candidates.clear();
+        for (int32_t dz = -r_peer.radius; dz <= r_peer.radius; dz++)
+        {
+            for (int32_t dx = -r_peer.radius; dx <= r_peer.radius; dx++)
+            {
+                const Chunk *pChunk = p_chunks.find(Chunk::ChunkPos(r_peer.center.x + dx, r_peer.center.y + dz));
+                if (!pChunk)
+                    continue;
+
+                // Versions change with every edit or reload, an equal one means the peer's copy is current.
+                auto sent = r_peer.sent.find(Tools::Hash::chunk_pos(pChunk->get_pos()));
+                if (sent != r_peer.sent.end() && sent->second == pChunk->get_content_version())
+                    continue;
+
+                // Chunks behind the peer rank as if up to twice as far away.
+                const float distance = std::sqrt(static_cast<float>(dx * dx + dz * dz));
+                float facing = 0.0f;
+                if (distance > 0.0f)
+                    facing = (r_peer.viewDirection.x * dx + r_peer.viewDirection.y * dz) / distance;
+
+                m_candidates.push_back({ pChunk, distance * (1.5f - 0.5f * facing) });
+            }
+        }
+
+        const size_t count = std::min(MAX_SENDS_PER_PEER, m_candidates.size());
+        std::partial_sort(m_candidates.begin(), m_candidates.begin() + count, m_candidates.end(),
+                          [](const Candidate &p_a, const Candidate &p_b)
+                          { return p_a.score < p_b.score; });
+
+        // The last chunk may overdraw the budget; the debt is paid off before the next send.
+        for (size_t i = 0; i < count && r_peer.budgetBytes > 0.0; i++)
+        {
+            const PackedByteArray &packet = get_chunk_packet(m_candidates[i].pChunk);
+            r_peer.outgoing.emplace_back(packet);
+            r_peer.budgetBytes -= static_cast<double>(packet.size());
+            r_peer.sent[Tools::Hash::chunk_pos(m_candidates[i].pChunk->get_pos())] = m_candidates[i].pChunk->get_content_version();
+        }
+    }
+
+    const PackedByteArray &PeerTracker::get_chunk_packet(const Chunk *p_chunk)
+    {
+        CachedPacket &cached = m_packetCache[Tools::Hash::chunk_pos(p_chunk->get_pos())];
+        if (cached.packet.is_empty() || cached.version != p_chunk->get_content_version())
+        {
+            cached.version = p_chunk->get_content_version();
+            cached.packet = ChunkWire::encode_chunk(p_chunk);
+        }
+
+        return cached.packet;
+    }
+} //namespace Voxel
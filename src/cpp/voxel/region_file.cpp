@@ -0,0 +1,213 @@
+#include "hpp/voxel/region_file.hpp"
+#include "hpp/tools/log.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Voxel
+{
+    static inline uint32_t read_u32(const uint8_t *p_bytes)
+    {
+        return static_cast<uint32_t>(p_bytes[0]) | (static_cast<uint32_t>(p_bytes[1]) << 8) |
+               (static_cast<uint32_t>(p_bytes[2]) << 16) | (static_cast<uint32_t>(p_bytes[3]) << 24);
+    }
+
+    static inline void store_u32(uint8_t *r_bytes, uint32_t p_value)
+    {
+        r_bytes[0] = static_cast<uint8_t>(p_value & 0xFF);
+        r_bytes[1] = static_cast<uint8_t>((p_value >> 8) & 0xFF);
+        r_bytes[2] = static_cast<uint8_t>((p_value >> 16) & 0xFF);
+        r_bytes[3] = static_cast<uint8_t>((p_value >> 24) & 0xFF);
+    }
+
+    bool RegionFile::open(const std::string &p_path)
+    {
+        if (!m_file.open(p_path))
+            return false;
+
+        std::fill(std::begin(m_table), std::end(m_table), 0u);
+        m_usedSectors.assign(HEADER_SECTORS, true);
+        m_freeSectors = 0;
+
+        if (m_file.size() < HEADER_SECTORS * SECTOR_SIZE)
+        {
+            const std::vector<uint8_t> header(HEADER_SECTORS * SECTOR_SIZE, 0);
+            return m_file.write(0, header.data(), header.size());
+        }
+
+        const uint32_t fileSectors = static_cast<uint32_t>(m_file.size() / SECTOR_SIZE);
+        for (uint32_t slot = 0; slot < CHUNK_COUNT; slot++)
+        {
+            const uint32_t entry = read_u32(m_file.data() + slot * sizeof(uint32_t));
+            const uint32_t offset = entry_offset(entry);
+            const uint32_t count = entry_count(entry);
+
+            // Entries pointing outside the file or into the header are dropped rather than trusted.
+            if (entry == 0 || count == 0 || offset < HEADER_SECTORS || offset + count > fileSectors)
+                continue;
+
+            m_table[slot] = entry;
+            if (m_usedSectors.size() < offset + count)
+                m_usedSectors.resize(offset + count, false);
+
+            for (uint32_t sector = offset; sector < offset + count; sector++)
+                m_usedSectors[sector] = true;
+        }
+
+        m_freeSectors = static_cast<uint32_t>(std::count(m_usedSectors.begin(), m_usedSectors.end(), false));
+        return true;
+    }
+
+    void RegionFile::close()
+    {
+        if (!m_file.is_open())
+            return;
+
+        // A quarter of the file being holes is worth one rewrite.
+        if (m_freeSectors > 16 && m_freeSectors * 4 > m_usedSectors.size())
+            compact();
+
+        m_file.resize(m_usedSectors.size() * SECTOR_SIZE);
+        m_file.close();
+    }
+
+    bool RegionFile::read(uint32_t p_slot, const uint8_t *&r_data, size_t &r_size) const
+    {
+        const uint32_t entry = m_table[p_slot];
+        if (entry == 0)
+            return false;
+
+        const uint8_t *pSlot = m_file.data() + static_cast<size_t>(entry_offset(entry)) * SECTOR_SIZE;
+        const size_t size = read_u32(pSlot);
+        if (size + sizeof(uint32_t) > entry_count(entry) * SECTOR_SIZE)
+        {
+            VOXEL_LOG_ERROR("Region slot {} claims {} bytes, more than its sectors hold.", p_slot, size);
+            return false;
+        }
+
+        r_data = pSlot + sizeof(uint32_t);
+        r_size = size;
+        return true;
+    }
+
+    bool RegionFile::write(uint32_t p_slot, const uint8_t *p_data, size_t p_size)
+    {
+        const size_t slotBytes = p_size + sizeof(uint32_t);
+        const uint32_t needed = static_cast<uint32_t>((slotBytes + SECTOR_SIZE - 1) / SECTOR_SIZE);
+        if (needed > MAX_SECTORS_PER_CHUNK)
+        {
+            VOXEL_LOG_ERROR("Chunk payload of {} bytes is too large for a region slot.", p_size);
+            return false;
+        }
+
+        // Reuse the current slot when the payload still fits, giving back any sectors it no longer needs.
+        const uint32_t entry = m_table[p_slot];
+        uint32_t offset;
+        if (entry != 0 && entry_count(entry) >= needed)
+        {
+            offset = entry_offset(entry);
+            release(offset + needed, entry_count(entry) - needed);
+        }
+        else
+        {
+            if (entry != 0)
+                release(entry_offset(entry), entry_count(entry));
+
+            offset = allocate(needed);
+        }
+
+        uint8_t length[sizeof(uint32_t)];
+        store_u32(length, static_cast<uint32_t>(p_size));
+
+        const size_t position = static_cast<size_t>(offset) * SECTOR_SIZE;
+        if (!m_file.write(position, length, sizeof(length)) || !m_file.write(position + sizeof(length), p_data, p_size))
+            return false;
+
+        return write_entry(p_slot, (offset << 8) | needed);
+    }
+
+    uint32_t RegionFile::allocate(uint32_t p_count)
+    {
+        // First fit among the holes, otherwise append.
+        if (m_freeSectors >= p_count)
+        {
+            uint32_t run = 0;
+            for (uint32_t sector = HEADER_SECTORS; sector < m_usedSectors.size(); sector++)
+            {
+                run = m_usedSectors[sector] ? 0 : run + 1;
+                if (run < p_count)
+                    continue;
+
+                const uint32_t offset = sector + 1 - p_count;
+                std::fill(m_usedSectors.begin() + offset, m_usedSectors.begin() + offset + p_count, true);
+                m_freeSectors -= p_count;
+                return offset;
+            }
+        }
+
+        const uint32_t offset = static_cast<uint32_t>(m_usedSectors.size());
+        m_usedSectors.resize(offset + p_count, true);
+        return offset;
+    }
+
+    void RegionFile::release(uint32_t p_offset, uint32_t p_count)
+    {
+        for (uint32_t sector = p_offset; sector < p_offset + p_count; sector++)
+            m_usedSectors[sector] = false;
+
+        m_freeSectors += p_count;
+
+        // Trailing holes are simply cut off the end of the file.
+        while (m_usedSectors.size() > HEADER_SECTORS && !m_usedSectors.back())
+        {
+            m_usedSectors.pop_back();
+            m_freeSectors--;
+        }
+    }
+
+    bool RegionFile::write_entry(uint32_t p_slot, uint32_t p_entry)
+    {
+        m_table[p_slot] = p_entry;
+
+        uint8_t bytes[sizeof(uint32_t)];
+        store_u32(bytes, p_entry);
+        return m_file.write(p_slot * sizeof(uint32_t), bytes, sizeof(bytes));
+    }
+
+    void RegionFile::compact()
+    {
+        std::vector<uint32_t> slots;
+        for (uint32_t slot = 0; slot < CHUNK_COUNT; slot++)
+        {
+            if (m_table[slot] != 0)
+                slots.push_back(slot);
+        }
+
+        std::sort(slots.begin(), slots.end(), [this](uint32_t a, uint32_t b)
+                  { return entry_offset(m_table[a]) < entry_offset(m_table[b]); });
+
+        // Slide every slot down to the end of the previous one. Slots only move towards the start of the file, so a
+        // slot never overwrites one that hasn't moved yet.
+        std::vector<uint8_t> buffer;
+        uint32_t cursor = HEADER_SECTORS;
+        for (uint32_t slot : slots)
+        {
+            const uint32_t offset = entry_offset(m_table[slot]);
+            const uint32_t count = entry_count(m_table[slot]);
+
+            if (offset != cursor)
+            {
+                const uint8_t *pSource = m_file.data() + static_cast<size_t>(offset) * SECTOR_SIZE;
+                buffer.assign(pSource, pSource + count * SECTOR_SIZE);
+                m_file.write(static_cast<size_t>(cursor) * SECTOR_SIZE, buffer.data(), buffer.size());
+                write_entry(slot, (cursor << 8) | count);
+            }
+
+            cursor += count;
+        }
+
+        m_usedSectors.assign(cursor, true);
+        m_freeSectors = 0;
+    }
+} //namespace Voxel
@@ -0,0 +1,123 @@
+#include "hpp/voxel/region_store.hpp"
+#include "hpp/tools/hash.hpp"
+#include "hpp/tools/log.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace Voxel
+{
+    Chunk::ChunkPos RegionStore::get_region_pos(Chunk::ChunkPos p_chunkPos)
+    {
+        return Chunk::ChunkPos(p_chunkPos.x >> RegionFile::REGION_SHIFT, p_chunkPos.y >> RegionFile::REGION_SHIFT);
+    }
+
+    uint32_t RegionStore::get_slot(Chunk::ChunkPos p_chunkPos)
+    {
+        const uint32_t x = static_cast<uint32_t>(p_chunkPos.x) & (RegionFile::REGION_AXIS - 1);
+        const uint32_t z = static_cast<uint32_t>(p_chunkPos.y) & (RegionFile::REGION_AXIS - 1);
+        return x + z * RegionFile::REGION_AXIS;
+    }
+
+    void RegionStore::set_directory(const std::string &p_directory)
+    {
+        close_all();
+        m_directory = p_directory;
+
+        if (m_directory.empty())
+            return;
+
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        if (error)
+        {
+            VOXEL_LOG_ERROR("Failed to create save directory {}: {}.", m_directory, error.message());
+            m_directory.clear();
+        }
+    }
+
+    RegionFile *RegionStore::get_region(Chunk::ChunkPos p_regionPos, bool p_create)
+    {
+        const uint64_t key = Tools::Hash::chunk_pos(p_regionPos);
+        auto iterator = m_regions.find(key);
+        if (iterator != m_regions.end())
+        {
+            iterator->second.lastUse = ++m_useCounter;
+            return iterator->second.pFile.get();
+        }
+
+        const std::filesystem::path path = std::filesystem::path(m_directory) /
+                                           ("r." + std::to_string(p_regionPos.x) + "." + std::to_string(p_regionPos.y) + ".vxr");
+
+        std::error_code error;
+        if (!p_create && !std::filesystem::exists(path, error))
+            return nullptr;
+
+        if (m_regions.size() >= MAX_OPEN_REGIONS)
+        {
+            auto oldest = m_regions.begin();
+            for (auto candidate = m_regions.begin(); candidate != m_regions.end(); ++candidate)
+            {
+                if (candidate->second.lastUse < oldest->second.lastUse)
+                    oldest = candidate;
+            }
+
+            oldest->second.pFile->close();
+            m_regions.erase(oldest);
+        }
+
+        auto pFile = std::make_unique<RegionFile>();
+        if (!pFile->open(path.string()))
+            return nullptr;
+
+        RegionFile *pRegion = pFile.get();
+        m_regions.emplace(key, OpenRegion{ std::move(pFile), ++m_useCounter });
+        return pRegion;
+    }
+
+    bool RegionStore::read(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &r_bytes)
+    {
+        if (!is_enabled())
+            return false;
+
+        RegionFile *pRegion = get_region(get_region_pos(p_chunkPos), false);
+        if (!pRegion)
+            return false;
+
+        const uint8_t *pData;
+        size_t size;
+        if (!pRegion->read(get_slot(p_chunkPos), pData, size))
+            return false;
+
+        // The mapping moves when the region grows, so the payload is copied out before it crosses threads.
+        r_bytes.assign(pData, pData + size);
+        return true;
+    }
+
+    bool RegionStore::write(Chunk::ChunkPos p_chunkPos, const std::vector<uint8_t> &p_bytes)
+    {
+        if (!is_enabled())
+            return false;
+
+        RegionFile *pRegion = get_region(get_region_pos(p_chunkPos), true);
+        if (!pRegion)
+            return false;
+
+        if (!pRegion->write(get_slot(p_chunkPos), p_bytes.data(), p_bytes.size()))
+        {
+            VOXEL_LOG_ERROR("Failed to save chunk {}.", p_chunkPos);
+            return false;
+        }
+
+        return true;
+    }
+
+    void RegionStore::close_all()
+    {
+        for (auto &kvp : m_regions)
+            kvp.second.pFile->close();
+
+        m_regions.clear();
+    }
+} //namespace Voxel
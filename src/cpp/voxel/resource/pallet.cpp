@@ -4,7 +4,7 @@
 #include "godot_cpp/classes/resource_loader.hpp"
 #include "godot_cpp/classes/standard_material3d.hpp"
 #include "godot_cpp/classes/texture.hpp"
-#include "hpp/tools/log_stream.hpp"
+#include "hpp/tools/log.hpp"
 #include "hpp/tools/material.hpp"
 
 using namespace godot;
@@ -41,6 +41,11 @@ namespace Voxel::Resource
         ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "metal_material", PROPERTY_HINT_RESOURCE_TYPE, "StandardMaterial3D"),
                      "set_metal_material", "get_metal_material");
 
+        ClassDB::bind_method(D_METHOD("get_fluid_material"), &Pallet::get_fluid_material);
+        ClassDB::bind_method(D_METHOD("set_fluid_material", "m"), &Pallet::set_fluid_material);
+        ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "fluid_material", PROPERTY_HINT_RESOURCE_TYPE, "StandardMaterial3D"),
+                     "set_fluid_material", "get_fluid_material");
+
         ClassDB::bind_method(D_METHOD("get_atlas"), &Pallet::get_atlas);
         ClassDB::bind_method(D_METHOD("set_atlas", "p_atlas"), &Pallet::set_atlas);
         ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "atlas", PROPERTY_HINT_RESOURCE_TYPE, "Texture"), "set_atlas", "get_atlas");
@@ -51,7 +56,7 @@ namespace Voxel::Resource
         if (p_type >= 0 && p_type < TYPE_COUNT)
             return m_materials[p_type];
 
-        Tools::Log::error() << "Invalid material type:" << p_type;
+        VOXEL_LOG_ERROR("Invalid material type {}.", p_type);
 
         return m_materials[TYPE_UNKNOWN];
     }
@@ -77,6 +82,19 @@ namespace Voxel::Resource
         m_materials[TYPE_METAL]->set_albedo(Color(1.f, 1.f, 1.f));
         m_materials[TYPE_METAL]->set_metallic(1.f);
 
+        // Baked voxel light arrives as vertex color and darkens the albedo.
+        for (int i = TYPE_GENERIC; i < TYPE_COUNT; ++i)
+            m_materials[i]->set_flag(BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
+
+        // Untextured, the vertex color carries both the fluid's tint and its light. Seen from inside the fluid too.
+        m_fluidMaterial = m_materials[TYPE_UNKNOWN]->duplicate();
+        m_fluidMaterial->set_name("Fluid");
+        m_fluidMaterial->set_albedo(Color(1.f, 1.f, 1.f));
+        m_fluidMaterial->set_transparency(BaseMaterial3D::TRANSPARENCY_ALPHA);
+        m_fluidMaterial->set_cull_mode(BaseMaterial3D::CULL_DISABLED);
+        m_fluidMaterial->set_flag(BaseMaterial3D::FLAG_ALBEDO_FROM_VERTEX_COLOR, true);
+        m_fluidMaterial->set_flag(BaseMaterial3D::FLAG_DONT_RECEIVE_SHADOWS, true);
+
         String atlas_path = "res://textures/voxel_atlas.png";
 
         ResourceLoader *loader = ResourceLoader::get_singleton();
@@ -86,18 +104,18 @@ namespace Voxel::Resource
         {
             if (!FileAccess::file_exists(atlas_path))
             {
-                Tools::Log::error() << "File does NOT exist at: " << atlas_path.ascii().ptr();
+                VOXEL_LOG_ERROR("File does NOT exist at: {}", atlas_path.utf8().get_data());
             }
             else
             {
-                Tools::Log::error() << "File exists but failed to load as resource at: " << atlas_path.ptr()
-                                    << " (likely import failure or invalid format)";
+                VOXEL_LOG_ERROR("File exists but failed to load as resource at: {} (likely import failure or invalid format)",
+                                atlas_path.utf8().get_data());
             }
         }
         else
         {
-            Tools::Log::debug() << "Successfully loaded atlas: " << atlas_path.ptr()
-                                << " (type: " << m_atlas->get_class().ascii().ptr() << ")";
+            VOXEL_LOG_DEBUG("Successfully loaded atlas: {} (type: {})",
+                            atlas_path.utf8().get_data(), m_atlas->get_class().utf8().get_data());
         }
 
         apply_atlas_to_materials();
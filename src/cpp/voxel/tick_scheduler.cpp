@@ -0,0 +1,168 @@
+#include "hpp/voxel/tick_scheduler.hpp"
+#include "hpp/tools/bits.hpp"
+#include "hpp/tools/hash.hpp"
+#include "hpp/tools/log.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/constants.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include "hpp/voxel/world.hpp"
+
+using namespace Voxel::Resource;
+
+namespace Voxel
+{
+    void TickScheduler::set_random_tick_handler(Pallet::BlockTexture p_texture, BlockHandler p_handler)
+    {
+        if (p_texture < 0 || p_texture >= Pallet::TEXTURE_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to set a random tick handler for unknown block texture {}.", p_texture);
+            return;
+        }
+
+        if (m_randomHandlers[p_texture] && !p_handler)
+            m_randomHandlerCount--;
+        else if (!m_randomHandlers[p_texture] && p_handler)
+            m_randomHandlerCount++;
+
+        m_randomHandlers[p_texture] = p_handler;
+    }
+
+    void TickScheduler::set_scheduled_update_handler(Pallet::BlockTexture p_texture, BlockHandler p_handler)
+    {
+        if (p_texture < 0 || p_texture >= Pallet::TEXTURE_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to set a scheduled update handler for unknown block texture {}.", p_texture);
+            return;
+        }
+
+        m_scheduledHandlers[p_texture] = p_handler;
+    }
+
+    void TickScheduler::schedule(godot::Vector2i p_chunkPos, uint32_t p_blockIndex, uint32_t p_delayTicks)
+    {
+        m_scheduled.push(ScheduledUpdate{ m_tick + godot::MAX(p_delayTicks, 1u), p_chunkPos, p_blockIndex });
+    }
+
+    void TickScheduler::tick(World *p_world, const std::vector<Chunk *> &p_simulatedChunks)
+    {
+        m_tick++;
+
+        // The whole tick is one edit, so every changed chunk is remeshed once at the end of it.
+        p_world->begin_edit();
+
+        for (Chunk *pChunk : p_simulatedChunks)
+        {
+            if (!m_parked.empty())
+                restore_parked(pChunk);
+
+            if (m_randomTickSpeed > 0 && pChunk->get_tickable_section_mask() != 0)
+                run_random_ticks(p_world, pChunk);
+        }
+
+        run_scheduled_updates(p_world);
+
+        p_world->commit_edit();
+    }
+
+    void TickScheduler::on_chunk_unload(Chunk *p_chunk)
+    {
+        m_parked.erase(Tools::Hash::chunk(p_chunk));
+    }
+
+    void TickScheduler::run_random_ticks(World *p_world, Chunk *p_chunk)
+    {
+        uint32_t mask = p_chunk->get_tickable_section_mask();
+
+        while (mask != 0)
+        {
+            const uint32_t section = Tools::Bits::count_trailing_zeros(mask);
+            mask &= mask - 1;
+
+            ChunkSection &sectionData = p_chunk->get_section(section);
+
+            // Rolling stride over the tickable list: every entry is visited once per (count / speed) ticks.
+            uint32_t budget = godot::MIN(m_randomTickSpeed, static_cast<uint32_t>(sectionData.tickable.size()));
+            while (budget-- > 0 && !sectionData.tickable.empty())
+            {
+                if (sectionData.tickCursor >= sectionData.tickable.size())
+                    sectionData.tickCursor = 0;
+
+                const uint16_t local = sectionData.tickable[sectionData.tickCursor];
+                uint32_t x, y, z;
+                Core::get_section_local_position(local, x, y, z);
+                y += section * SECTION_AXIS_LENGTH_U;
+
+                Block *pBlock = p_chunk->get_block_mutable(x, y, z);
+                if (!is_tickable(pBlock))
+                {
+                    // Changed since it was listed; drop it here instead of searching the list on every edit.
+                    sectionData.remove_tickable_at(sectionData.tickCursor);
+                    continue;
+                }
+
+                if (m_randomHandlers[pBlock->get_texture()](p_world, p_chunk, x, y, z, pBlock))
+                    mark_changed(p_world, p_chunk, x, y, z);
+
+                sectionData.tickCursor++;
+            }
+
+            if (sectionData.tickable.empty())
+                p_chunk->set_section_tickable(section, false);
+        }
+    }
+
+    void TickScheduler::run_scheduled_updates(World *p_world)
+    {
+        while (!m_scheduled.empty() && m_scheduled.top().dueTick <= m_tick)
+        {
+            const ScheduledUpdate update = m_scheduled.top();
+            m_scheduled.pop();
+
+            // Updates for unloaded chunks are dropped, ones outside the simulation distance wait until it returns.
+            Chunk *pChunk = p_world->try_get_chunk(update.chunkPos);
+            if (!pChunk)
+                continue;
+
+            if (pChunk->get_simulation_stamp() != m_tick)
+            {
+                m_parked[Tools::Hash::chunk(pChunk)].emplace_back(update);
+                continue;
+            }
+
+            uint32_t x, y, z;
+            Core::get_block_position(update.blockIndex, x, y, z);
+
+            Block *pBlock = pChunk->get_block_mutable(x, y, z);
+            if (!pBlock || pBlock->get_texture() >= Pallet::TEXTURE_COUNT)
+                continue;
+
+            BlockHandler handler = m_scheduledHandlers[pBlock->get_texture()];
+            if (handler && handler(p_world, pChunk, x, y, z, pBlock))
+                mark_changed(p_world, pChunk, x, y, z);
+        }
+    }
+
+    void TickScheduler::restore_parked(Chunk *p_chunk)
+    {
+        auto iterator = m_parked.find(Tools::Hash::chunk(p_chunk));
+        if (iterator == m_parked.end())
+            return;
+
+        for (ScheduledUpdate &update : iterator->second)
+        {
+            update.dueTick = m_tick;
+            m_scheduled.push(update);
+        }
+
+        m_parked.erase(iterator);
+    }
+
+    void TickScheduler::mark_changed(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z)
+    {
+        if (p_chunk->get_block_at(x, y, z)->is_solid())
+            p_chunk->mark_section_solid(y / SECTION_AXIS_LENGTH_U);
+
+        p_chunk->update_tickable(x, y, z);
+        p_world->mark_block_dirty(p_chunk, x, y, z);
+    }
+} //namespace Voxel
@@ -0,0 +1,148 @@
+#include "hpp/voxel/voxel_raycast.hpp"
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/chunk_grid.hpp"
+#include "hpp/voxel/constants.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+using namespace godot;
+
+namespace Voxel
+{
+    bool VoxelRaycast::cast(const ChunkGrid &p_chunks, Vector3 p_origin, Vector3 p_direction, float p_maxDistance,
+                            Hit &r_hit)
+    {
+        const float length = std::sqrt(p_direction.x * p_direction.x + p_direction.y * p_direction.y +
+                                       p_direction.z * p_direction.z);
+        if (!(length > 0.f) || !(p_maxDistance >= 0.f))
+            return false;
+
+        constexpr float INF = std::numeric_limits<float>::infinity();
+        constexpr int32_t SECTION = static_cast<int32_t>(SECTION_AXIS_LENGTH_U);
+        constexpr int32_t HEIGHT = static_cast<int32_t>(CHUNK_HEIGHT_U);
+
+        const float origin[3] = { p_origin.x, p_origin.y, p_origin.z };
+        const float dir[3] = { p_direction.x / length, p_direction.y / length, p_direction.z / length };
+
+        int32_t cell[3];
+        int32_t step[3];
+        float tMax[3];
+        float tDelta[3];
+        for (int i = 0; i < 3; i++)
+        {
+            cell[i] = static_cast<int32_t>(std::floor(origin[i]));
+
+            if (dir[i] > 0.f)
+            {
+                step[i] = 1;
+                tDelta[i] = 1.f / dir[i];
+                tMax[i] = (static_cast<float>(cell[i]) + 1.f - origin[i]) * tDelta[i];
+            }
+            else if (dir[i] < 0.f)
+            {
+                step[i] = -1;
+                tDelta[i] = -1.f / dir[i];
+                tMax[i] = (origin[i] - static_cast<float>(cell[i])) * tDelta[i];
+            }
+            else
+            {
+                step[i] = 0;
+                tDelta[i] = INF;
+                tMax[i] = INF;
+            }
+        }
+
+        float t = 0.f;
+        int enterAxis = -1;
+
+        while (t <= p_maxDistance)
+        {
+            // Above or below the world and moving away from it, nothing left to hit.
+            if ((cell[1] < 0 && step[1] <= 0) || (cell[1] >= HEIGHT && step[1] >= 0))
+                return false;
+
+            const Chunk *pChunk = nullptr;
+            if (cell[1] >= 0 && cell[1] < HEIGHT)
+            {
+                pChunk = p_chunks.find(Chunk::ChunkPos(cell[0] >> CHUNK_AXIS_SHIFT, cell[2] >> CHUNK_AXIS_SHIFT));
+                if (pChunk && !(pChunk->get_solid_section_mask() & (1u << (static_cast<uint32_t>(cell[1]) / SECTION_AXIS_LENGTH_U))))
+                    pChunk = nullptr;
+            }
+
+            if (pChunk)
+            {
+                const Block *pBlock = pChunk->get_block_at(static_cast<uint32_t>(cell[0]) & (CHUNK_AXIS_LENGTH_U - 1),
+                                                           static_cast<uint32_t>(cell[1]),
+                                                           static_cast<uint32_t>(cell[2]) & (CHUNK_AXIS_LENGTH_U - 1));
+
+                if (pBlock->is_solid())
+                {
+                    r_hit.block = Vector3i(cell[0], cell[1], cell[2]);
+                    r_hit.normal = Vector3i();
+                    if (enterAxis >= 0)
+                        r_hit.normal[enterAxis] = -step[enterAxis];
+                    r_hit.distance = t;
+                    r_hit.id = pBlock->to_id();
+                    return true;
+                }
+
+                enterAxis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+                t = tMax[enterAxis];
+                cell[enterAxis] += step[enterAxis];
+                tMax[enterAxis] += tDelta[enterAxis];
+                continue;
+            }
+
+            // Nothing solid in this section: jump straight to the cell where the ray leaves it. An axis needs
+            // 'remaining' crossings to leave, the axis that needs the least time exits and the others advance by the
+            // crossings they make before that.
+            int32_t remaining[3];
+            float tExit = INF;
+            int exitAxis = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                if (step[i] == 0)
+                {
+                    remaining[i] = 0;
+                    continue;
+                }
+
+                const int32_t sectionMin = cell[i] & ~(SECTION - 1);
+                remaining[i] = step[i] > 0 ? sectionMin + SECTION - cell[i] : cell[i] - sectionMin + 1;
+
+                const float tAxis = tMax[i] + static_cast<float>(remaining[i] - 1) * tDelta[i];
+                if (tAxis < tExit)
+                {
+                    tExit = tAxis;
+                    exitAxis = i;
+                }
+            }
+
+            if (tExit == INF)
+                return false;
+
+            for (int i = 0; i < 3; i++)
+            {
+                if (step[i] == 0 || tMax[i] > tExit)
+                    continue;
+
+                int32_t crossings = remaining[i];
+                if (i != exitAxis)
+                {
+                    crossings = static_cast<int32_t>(std::floor((tExit - tMax[i]) / tDelta[i])) + 1;
+                    crossings = crossings < remaining[i] - 1 ? crossings : remaining[i] - 1;
+                }
+
+                cell[i] += step[i] * crossings;
+                tMax[i] += static_cast<float>(crossings) * tDelta[i];
+            }
+
+            t = tExit;
+            enterAxis = exitAxis;
+        }
+
+        return false;
+    }
+} //namespace Voxel
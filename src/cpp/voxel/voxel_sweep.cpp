@@ -0,0 +1,150 @@
+#include "hpp/voxel/voxel_sweep.hpp"
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/chunk_grid.hpp"
+#include "hpp/voxel/constants.hpp"
+#include <cmath>
+#include <cstdint>
+
+using namespace godot;
+
+namespace Voxel
+{
+    // Keeps boxes that rest exactly on a block face from counting that block as overlapped.
+    static constexpr float SKIN = 1e-4f;
+
+    // Solid lookups for one sweep. Neighboring cells nearly always share a chunk, so the last chunk is cached.
+    class SolidSampler
+    {
+    public:
+        explicit SolidSampler(const ChunkGrid &p_chunks) : m_chunks(p_chunks) {}
+
+        bool is_solid(int32_t x, int32_t y, int32_t z)
+        {
+            if (y < 0 || y >= static_cast<int32_t>(CHUNK_HEIGHT_U))
+                return false;
+
+            const Chunk::ChunkPos pos(x >> CHUNK_AXIS_SHIFT, z >> CHUNK_AXIS_SHIFT);
+            if (!m_hasCached || pos != m_cachedPos)
+            {
+                m_pCached = m_chunks.find(pos);
+                m_cachedPos = pos;
+                m_hasCached = true;
+            }
+
+            if (!m_pCached)
+                return true;
+
+            if (!(m_pCached->get_solid_section_mask() & (1u << (static_cast<uint32_t>(y) / SECTION_AXIS_LENGTH_U))))
+                return false;
+
+            return m_pCached->get_block_at(static_cast<uint32_t>(x) & (CHUNK_AXIS_LENGTH_U - 1),
+                                           static_cast<uint32_t>(y),
+                                           static_cast<uint32_t>(z) & (CHUNK_AXIS_LENGTH_U - 1))
+                    ->is_solid();
+        }
+
+    private:
+        const ChunkGrid &m_chunks;
+        const Chunk *m_pCached = nullptr;
+        Chunk::ChunkPos m_cachedPos;
+        bool m_hasCached = false;
+    };
+
+    static inline int32_t cell_floor(float p_value)
+    {
+        return static_cast<int32_t>(std::floor(p_value));
+    }
+
+    // Whether the axis-aligned layer of cells at p_layer on p_axis, across the box's extent on the other two axes,
+    // holds a solid block.
+    static bool layer_is_solid(SolidSampler &p_sampler, int p_axis, int32_t p_layer, const float p_min[3], const float p_max[3])
+    {
+        const int a = (p_axis + 1) % 3;
+        const int b = (p_axis + 2) % 3;
+
+        const int32_t aStart = cell_floor(p_min[a] + SKIN);
+        const int32_t aEnd = cell_floor(p_max[a] - SKIN);
+        const int32_t bStart = cell_floor(p_min[b] + SKIN);
+        const int32_t bEnd = cell_floor(p_max[b] - SKIN);
+
+        int32_t cell[3];
+        cell[p_axis] = p_layer;
+        for (int32_t j = bStart; j <= bEnd; j++)
+        {
+            cell[b] = j;
+            for (int32_t i = aStart; i <= aEnd; i++)
+            {
+                cell[a] = i;
+                if (p_sampler.is_solid(cell[0], cell[1], cell[2]))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Moves the box along one axis, stopping flush against the first solid layer. Returns true when blocked.
+    static bool sweep_axis(SolidSampler &p_sampler, int p_axis, float p_motion, float r_min[3], float r_max[3])
+    {
+        if (p_motion == 0.f)
+            return false;
+
+        float allowed = p_motion;
+        bool blocked = false;
+
+        if (p_motion > 0.f)
+        {
+            const int32_t first = cell_floor(r_max[p_axis] - SKIN) + 1;
+            const int32_t last = cell_floor(r_max[p_axis] + p_motion - SKIN);
+            for (int32_t layer = first; layer <= last; layer++)
+            {
+                if (layer_is_solid(p_sampler, p_axis, layer, r_min, r_max))
+                {
+                    allowed = std::fmax(0.f, static_cast<float>(layer) - r_max[p_axis]);
+                    blocked = true;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            const int32_t first = cell_floor(r_min[p_axis] + SKIN) - 1;
+            const int32_t last = cell_floor(r_min[p_axis] + p_motion + SKIN);
+            for (int32_t layer = first; layer >= last; layer--)
+            {
+                if (layer_is_solid(p_sampler, p_axis, layer, r_min, r_max))
+                {
+                    allowed = std::fmin(0.f, static_cast<float>(layer + 1) - r_min[p_axis]);
+                    blocked = true;
+                    break;
+                }
+            }
+        }
+
+        r_min[p_axis] += allowed;
+        r_max[p_axis] += allowed;
+        return blocked;
+    }
+
+    uint32_t VoxelSweep::move(const ChunkGrid &p_chunks, Vector3 &r_center, Vector3 p_halfExtents, Vector3 p_motion)
+    {
+        float min[3] = { r_center.x - p_halfExtents.x, r_center.y - p_halfExtents.y, r_center.z - p_halfExtents.z };
+        float max[3] = { r_center.x + p_halfExtents.x, r_center.y + p_halfExtents.y, r_center.z + p_halfExtents.z };
+
+        SolidSampler sampler(p_chunks);
+        uint32_t contacts = CONTACT_NONE;
+
+        if (sweep_axis(sampler, 1, p_motion.y, min, max))
+            contacts |= p_motion.y < 0.f ? CONTACT_FLOOR : CONTACT_CEILING;
+
+        if (sweep_axis(sampler, 0, p_motion.x, min, max))
+            contacts |= CONTACT_WALL_X;
+
+        if (sweep_axis(sampler, 2, p_motion.z, min, max))
+            contacts |= CONTACT_WALL_Z;
+
+        r_center = Vector3(min[0] + p_halfExtents.x, min[1] + p_halfExtents.y, min[2] + p_halfExtents.z);
+        return contacts;
+    }
+} //namespace Voxel
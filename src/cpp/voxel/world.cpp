@@ -1,48 +1,1107 @@
 #include "hpp/voxel/world.hpp"
+#include "godot_cpp/classes/camera3d.hpp"
+#include "godot_cpp/classes/performance.hpp"
+#include "godot_cpp/classes/project_settings.hpp"
+#include "godot_cpp/classes/time.hpp"
 #include "godot_cpp/classes/timer.hpp"
+#include "godot_cpp/classes/viewport.hpp"
 #include "godot_cpp/core/class_db.hpp"
 #include "godot_cpp/core/memory.hpp"
+#include "godot_cpp/core/object.hpp"
 #include "godot_cpp/templates/hashfuncs.hpp"
 #include "godot_cpp/variant/callable.hpp"
 #include "godot_cpp/variant/vector2i.hpp"
 #include "godot_cpp/variant/vector3i.hpp"
 #include "hpp/tools/hash.hpp"
 #include "hpp/tools/log.hpp"
-#include "hpp/tools/log_stream.hpp"
-#include "hpp/tools/string.hpp"
+#include "hpp/tools/trace.hpp"
 #include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/chunk_io.hpp"
 #include "hpp/voxel/chunk_mesher.hpp"
+#include "hpp/voxel/chunk_wire.hpp"
 #include "hpp/voxel/constants.hpp"
+#include "hpp/voxel/voxel_raycast.hpp"
+#include "hpp/voxel/voxel_sweep.hpp"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <limits>
 #include <sstream>
+#include <vector>
 
 using namespace godot;
-
-#define DEBUG_VERBOSE
+using namespace Voxel::Resource;
 
 namespace Voxel
 {
+    // Performance monitor id -> the trace zone whose milliseconds per frame it shows.
+    static const char *const TRACE_MONITORS[][2] = {
+        { "Voxel/Frame (ms)", "World::process" },
+        { "Voxel/Generate (ms)", "Chunk::generate_blocks" },
+        { "Voxel/Load (ms)", "Chunk::load_blocks" },
+        { "Voxel/Save (ms)", "Chunk::save" },
+        { "Voxel/Mesh build (ms)", "ChunkMesher::build_mesh" },
+        { "Voxel/Mesh upload (ms)", "ChunkMesher::commit_mesh" },
+        { "Voxel/Tick (ms)", "World::tick" },
+        { "Voxel/Fluids (ms)", "FluidSimulator::tick" },
+        { "Voxel/Colliders (ms)", "World::update_colliders" },
+        { "Voxel/Disk read (ms)", "ChunkIO::read" },
+        { "Voxel/Disk write (ms)", "ChunkIO::write" },
+    };
+
     void World::_ready()
     {
         default_pallet();
         default_generation_settings();
         build_debounce_timer();
         subscribe_to_signals();
+        open_save_directory();
 
+        set_notify_transform(true);
         generate_spawn();
+        set_process(true);
+        set_physics_process(true);
+    }
+
+    Core::GenerationParams World::get_generation_params() const
+    {
+        Core::GenerationParams params;
+        params.seed = m_seed;
+        if (m_generationSettings.is_valid())
+            params.seaLevel = static_cast<int32_t>(m_generationSettings->get_sea_level());
+        return params;
+    }
+
+    uint64_t World::get_generation_hash() const
+    {
+        // Bump when the generator changes what it produces, saved edits recorded against the old output are dropped.
+        constexpr uint32_t GENERATOR_VERSION = 1;
+
+        // FNV-1a over exactly what get_generation_params() hands the generator, so settings it never reads don't
+        // invalidate saved edits.
+        const Core::GenerationParams params = get_generation_params();
+        uint64_t hash = 0xCBF29CE484222325ull;
+        const auto mix = [&hash](uint64_t p_value)
+        {
+            for (uint32_t byte = 0; byte < 8; byte++)
+            {
+                hash ^= (p_value >> (byte * 8)) & 0xFF;
+                hash *= 0x100000001B3ull;
+            }
+        };
+
+        mix(GENERATOR_VERSION);
+        mix(static_cast<uint64_t>(params.seed));
+        mix(static_cast<uint32_t>(params.seaLevel));
+
+        return hash;
+    }
+
+    void World::_enter_tree()
+    {
+        Tools::Trace::set_thread_name("Main");
+        add_trace_monitors();
+    }
+
+    void World::_exit_tree()
+    {
+        remove_trace_monitors();
+
+        // Chunks aren't nodes, so nothing else frees them. Tickets survive and stream them back if re-entered.
+        unload_world();
+        queue_ticketed_chunks();
+        // Barrier for everything unload_world just handed off.
+        m_io.flush();
+    }
+
+    void World::_notification(int p_what)
+    {
+        if (p_what == NOTIFICATION_TRANSFORM_CHANGED)
+        {
+            const Transform3D worldTransform = get_global_transform();
+            m_chunks.for_each([&worldTransform](Chunk *p_chunk)
+                              { p_chunk->sync_instance_transform(worldTransform); });
+        }
     }
 
-    void World::set_generation_rng()
+    void World::_process(double p_delta)
     {
-        if (m_worldGenRNG.is_null() || !m_worldGenRNG.is_valid())
+        // The monitors read the totals of the frame this closes. One World ends the frame for all of them.
+        if (m_hasTraceMonitors)
+            Tools::Trace::end_frame();
+
+        VOXEL_TRACE_ZONE("World::process");
+
+        m_saveAccumulator += p_delta;
+        if (m_saveInterval > 0.0 && m_saveAccumulator >= m_saveInterval)
         {
-            m_worldGenRNG.instantiate();
+            m_saveAccumulator = 0.0;
+            queue_modified_saves();
         }
 
-        m_worldGenRNG->set_seed(m_seed);
+        integrate_streaming();
+
+        if (m_peers.get_peer_count() > 0)
+        {
+            VOXEL_TRACE_ZONE("PeerTracker::update");
+            m_peers.update(m_chunks, p_delta);
+        }
     }
 
-    void World::_exit_tree() {}
+    void World::integrate_streaming()
+    {
+        VOXEL_TRACE_ZONE("World::integrate_streaming");
+        Time *pTime = Time::get_singleton();
+
+        FrameBudget budget{};
+        budget.startUsec = pTime->get_ticks_usec();
+        budget.timeUsec = static_cast<uint64_t>(m_streamingBudgetMs * 1000.0);
+        budget.uploadBytes = static_cast<size_t>(m_uploadBudgetKb) * 1024u;
+
+        // Unloads first, they only free memory and make room for what comes after.
+        while (!m_pendingUnloads.empty() && can_afford(budget, STEP_UNLOAD))
+        {
+            const uint64_t stepStart = pTime->get_ticks_usec();
+            unload_next_pending_chunk();
+            record_step(budget, STEP_UNLOAD, stepStart);
+        }
+
+        if (m_io.is_running())
+        {
+            // Reads run ahead on the I/O worker. Only decoding, or generating a chunk that was never saved, costs
+            // main thread time.
+            if (!m_pendingLoads.empty())
+                request_pending_loads();
+
+            ChunkIO::LoadResult result;
+            while (!m_loadRequests.empty() && can_afford(budget, STEP_GENERATE) && m_io.poll_load(result))
+            {
+                const uint64_t key = Tools::Hash::chunk_pos(result.pos);
+                m_loadRequests.erase(key);
+
+                // Released by its tickets while the read was in flight.
+                if (m_pendingLoads.erase(key) == 0)
+                    continue;
+
+                const uint64_t stepStart = pTime->get_ticks_usec();
+                generate_new_chunk(result.pos.x, result.pos.y, result.found ? &result.bytes : nullptr);
+                record_step(budget, STEP_GENERATE, stepStart);
+            }
+        }
+        else if (!m_pendingLoads.empty())
+        {
+            std::vector<uint64_t> loads;
+            order_pending_loads(MAX_LOADS_PER_FRAME, loads);
+
+            for (uint64_t key : loads)
+            {
+                if (!can_afford(budget, STEP_GENERATE))
+                    break;
+
+                const uint64_t stepStart = pTime->get_ticks_usec();
+                m_pendingLoads.erase(key);
+                const Chunk::ChunkPos pos = Tools::Hash::chunk_pos_from(key);
+                generate_new_chunk(pos.x, pos.y);
+                record_step(budget, STEP_GENERATE, stepStart);
+            }
+        }
+
+        if (!m_staleChunks.empty())
+        {
+            if (get_camera_chunk_pos() != m_staleSortCenter)
+                sort_stale_chunks();
+
+            // Regenerated chunks commit their mesh immediately, so they share the upload budget too.
+            while (!m_staleChunks.empty() && can_afford(budget, STEP_REGENERATE) &&
+                   (budget.uploadedBytes == 0 || budget.uploadedBytes < budget.uploadBytes))
+            {
+                const uint64_t stepStart = pTime->get_ticks_usec();
+                budget.uploadedBytes += regenerate_next_stale_chunk();
+                record_step(budget, STEP_REGENERATE, stepStart);
+            }
+
+            if (m_staleChunks.empty())
+                Tools::Log::debug("Progressive rebuild finished.");
+        }
+
+        // Chunks unloaded before their turn were saved on the way out. The rest wait for a later frame while the
+        // worker is behind on writes.
+        // Overlay saves regenerate their baseline on this thread, so they are timed as their own step. Until one has
+        // been measured its estimate starts from the generation it repeats rather than from zero, or the first burst
+        // of saves would overrun the frame.
+        const StreamingStep saveStep = m_saveMode == SAVE_EDITS ? STEP_SAVE_OVERLAY : STEP_SAVE;
+        if (saveStep == STEP_SAVE_OVERLAY && m_stepCostUsec[STEP_SAVE_OVERLAY] == 0.0)
+            m_stepCostUsec[STEP_SAVE_OVERLAY] = m_stepCostUsec[STEP_GENERATE];
+        while (!m_saveQueue.empty() && !m_io.is_write_queue_full() && can_afford(budget, saveStep))
+        {
+            const uint64_t stepStart = pTime->get_ticks_usec();
+            Chunk *pChunk = m_chunks.find(Tools::Hash::chunk_pos_from(m_saveQueue.back()));
+            m_saveQueue.pop_back();
+
+            if (pChunk)
+                pChunk->save(m_io);
+            record_step(budget, saveStep, stepStart);
+        }
+
+        // Nearest to the camera first, so the chunks around the viewer don't wait behind distant ones.
+        const Chunk::ChunkPos meshCenter = ChunkMesher::is_queue_empty() ? Chunk::ChunkPos() : get_camera_chunk_pos();
+        while (!ChunkMesher::is_queue_empty() && can_afford(budget, STEP_MESH))
+        {
+            const uint64_t stepStart = pTime->get_ticks_usec();
+            ChunkMesher::build_next(meshCenter);
+            record_step(budget, STEP_MESH, stepStart);
+        }
+
+        // Built meshes that don't fit this frame's upload budget wait, in order, for the next one.
+        while (ChunkMesher::has_pending_upload() && can_afford(budget, STEP_UPLOAD))
+        {
+            const size_t bytes = ChunkMesher::get_next_upload_size();
+            if (budget.uploadedBytes > 0 && budget.uploadedBytes + bytes > budget.uploadBytes)
+                break;
+
+            const uint64_t stepStart = pTime->get_ticks_usec();
+            budget.uploadedBytes += ChunkMesher::upload_next();
+            record_step(budget, STEP_UPLOAD, stepStart);
+        }
+    }
+
+    void World::_physics_process(double p_delta)
+    {
+        constexpr double TICK_INTERVAL = 1.0 / TICKS_PER_SECOND;
+
+        update_colliders();
+
+        m_tickAccumulator += p_delta;
+
+        uint32_t ticks = 0;
+        while (m_tickAccumulator >= TICK_INTERVAL && ticks < MAX_TICKS_PER_FRAME)
+        {
+            run_tick();
+            m_tickAccumulator -= TICK_INTERVAL;
+            ticks++;
+        }
+
+        // Drop the backlog after a hitch instead of spiraling to catch up on it.
+        if (ticks == MAX_TICKS_PER_FRAME)
+            m_tickAccumulator = 0.0;
+    }
+
+    void World::run_tick()
+    {
+        VOXEL_TRACE_ZONE("World::tick");
+
+        // Stamp the chunks within simulation distance of any ticket, once each, even where tickets overlap.
+        const uint64_t stamp = m_tickScheduler.get_tick() + 1;
+        m_simulatedChunks.clear();
+
+        for (const auto &kvp : m_tickets)
+        {
+            const Chunk::ChunkPos center = kvp.second.center;
+            const int32_t radius = godot::MIN(m_simulationDistance, kvp.second.radius);
+
+            for (int x = center.x - radius; x <= center.x + radius; x++)
+            {
+                for (int z = center.y - radius; z <= center.y + radius; z++)
+                {
+                    Chunk *pChunk = m_chunks.find(Chunk::ChunkPos(x, z));
+                    if (!pChunk || pChunk->get_simulation_stamp() == stamp)
+                        continue;
+
+                    pChunk->set_simulation_stamp(stamp);
+                    m_simulatedChunks.emplace_back(pChunk);
+                }
+            }
+        }
+
+        m_tickScheduler.tick(this, m_simulatedChunks);
+
+        begin_edit();
+        m_fluids.tick(this, m_tickScheduler.get_tick());
+        commit_edit();
+    }
+
+    void World::set_random_tick_handler(int32_t p_texture, const godot::Callable &p_handler)
+    {
+        if (p_texture < 0 || p_texture >= Pallet::TEXTURE_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to set a random tick handler for unknown texture {}.", p_texture);
+            return;
+        }
+
+        const bool wasTickable = m_randomTickHandlers[p_texture].is_valid();
+        m_randomTickHandlers[p_texture] = p_handler;
+        m_tickScheduler.set_random_tick_handler(static_cast<Pallet::BlockTexture>(p_texture),
+                                                p_handler.is_valid() ? &World::run_random_tick_handler : nullptr);
+
+        // Tickable lists are built when blocks load or change, so loaded chunks have to pick up the new texture.
+        if (wasTickable != p_handler.is_valid())
+        {
+            m_chunks.for_each([](Chunk *p_chunk)
+                              { p_chunk->rebuild_tickable_sections(); });
+        }
+    }
+
+    void World::set_scheduled_update_handler(int32_t p_texture, const godot::Callable &p_handler)
+    {
+        if (p_texture < 0 || p_texture >= Pallet::TEXTURE_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to set a scheduled update handler for unknown texture {}.", p_texture);
+            return;
+        }
+
+        m_scheduledUpdateHandlers[p_texture] = p_handler;
+        m_tickScheduler.set_scheduled_update_handler(static_cast<Pallet::BlockTexture>(p_texture),
+                                                     p_handler.is_valid() ? &World::run_scheduled_update_handler : nullptr);
+    }
+
+    bool World::run_random_tick_handler(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, Block *p_block)
+    {
+        return p_world->call_block_handler(p_world->m_randomTickHandlers[p_block->get_texture()], p_chunk, x, y, z, p_block);
+    }
+
+    bool World::run_scheduled_update_handler(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, Block *p_block)
+    {
+        return p_world->call_block_handler(p_world->m_scheduledUpdateHandlers[p_block->get_texture()], p_chunk, x, y, z, p_block);
+    }
+
+    bool World::call_block_handler(const godot::Callable &p_handler, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z,
+                                   Block *p_block)
+    {
+        const Chunk::ChunkPos chunkPos = p_chunk->get_pos();
+        const Vector3i blockPos(chunkPos.x * static_cast<int32_t>(CHUNK_AXIS_LENGTH_U) + static_cast<int32_t>(x),
+                                static_cast<int32_t>(y),
+                                chunkPos.y * static_cast<int32_t>(CHUNK_AXIS_LENGTH_U) + static_cast<int32_t>(z));
+
+        const int32_t id = p_block->to_id();
+        const Variant result = p_handler.call(blockPos, id);
+        if (result.get_type() != Variant::INT)
+            return false;
+
+        const int32_t nextId = result;
+        if (nextId == id)
+            return false;
+
+        if (nextId < Block::ID_AIR || nextId >= Block::ID_COUNT)
+        {
+            VOXEL_LOG_ERROR("Block handler at {} returned unknown block id {}.", blockPos, nextId);
+            return false;
+        }
+
+        *p_block = Block::from_id(nextId);
+        return true;
+    }
+
+    void World::set_light_emission(int32_t p_texture, int32_t p_level)
+    {
+        if (p_texture < 0 || p_texture >= Pallet::TEXTURE_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to set light emission for unknown texture {}.", p_texture);
+            return;
+        }
+
+        m_lightEngine.set_emission(static_cast<Pallet::BlockTexture>(p_texture),
+                                   static_cast<uint8_t>(godot::CLAMP(p_level, 0, static_cast<int32_t>(LightEngine::LIGHT_MAX))));
+    }
+
+    void World::add_collision_body(Node3D *p_body)
+    {
+        if (!p_body)
+            return;
+
+        const uint64_t id = p_body->get_instance_id();
+        if (std::find(m_collisionBodies.begin(), m_collisionBodies.end(), id) == m_collisionBodies.end())
+            m_collisionBodies.emplace_back(id);
+    }
+
+    void World::remove_collision_body(Node3D *p_body)
+    {
+        if (!p_body)
+            return;
+
+        auto iterator = std::find(m_collisionBodies.begin(), m_collisionBodies.end(), p_body->get_instance_id());
+        if (iterator != m_collisionBodies.end())
+            m_collisionBodies.erase(iterator);
+    }
+
+    void World::update_colliders()
+    {
+        VOXEL_TRACE_ZONE("World::update_colliders");
+
+        // Freed bodies are dropped here rather than requiring scripts to untrack them.
+        std::vector<Chunk::ChunkPos> centers;
+        centers.reserve(m_collisionBodies.size());
+        for (size_t i = 0; i < m_collisionBodies.size();)
+        {
+            Node3D *pBody = Object::cast_to<Node3D>(ObjectDB::get_instance(m_collisionBodies[i]));
+            if (!pBody)
+            {
+                m_collisionBodies[i] = m_collisionBodies.back();
+                m_collisionBodies.pop_back();
+                continue;
+            }
+
+            centers.emplace_back(to_chunk_pos(pBody->get_global_position()));
+            i++;
+        }
+
+        const int32_t radius = m_collisionRadius;
+        auto is_near_body = [&centers, radius](Chunk::ChunkPos p_pos)
+        {
+            for (const Chunk::ChunkPos &center : centers)
+            {
+                if (std::abs(p_pos.x - center.x) <= radius && std::abs(p_pos.y - center.y) <= radius)
+                    return true;
+            }
+
+            return false;
+        };
+
+        for (size_t i = 0; i < m_collidingChunks.size();)
+        {
+            Chunk *pChunk = m_collidingChunks[i];
+            if (is_near_body(pChunk->get_pos()))
+            {
+                i++;
+                continue;
+            }
+
+            pChunk->disable_collision();
+            m_collidingChunks[i] = m_collidingChunks.back();
+            m_collidingChunks.pop_back();
+        }
+
+        for (const Chunk::ChunkPos &center : centers)
+        {
+            for (int32_t z = center.y - radius; z <= center.y + radius; z++)
+            {
+                for (int32_t x = center.x - radius; x <= center.x + radius; x++)
+                {
+                    Chunk *pChunk = m_chunks.find(Chunk::ChunkPos(x, z));
+                    if (!pChunk || pChunk->has_collision())
+                        continue;
+
+                    pChunk->enable_collision();
+                    m_collidingChunks.emplace_back(pChunk);
+                }
+            }
+        }
+
+        // Empty sections cost nothing to rebuild, so only sections that produced faces count against the budget.
+        uint32_t rebuilt = 0;
+        for (Chunk *pChunk : m_collidingChunks)
+        {
+            ChunkCollider *pCollider = pChunk->get_collider();
+            while (pCollider->has_dirty_sections() && rebuilt < MAX_COLLISION_SECTIONS_PER_FRAME)
+            {
+                if (pCollider->rebuild_next_section() > 0)
+                    rebuilt++;
+            }
+
+            if (rebuilt == MAX_COLLISION_SECTIONS_PER_FRAME)
+                break;
+        }
+    }
+
+    void World::schedule_block_update(godot::Vector3i p_blockPos, int32_t p_delayTicks)
+    {
+        if (p_blockPos.y < 0 || p_blockPos.y >= static_cast<int32_t>(CHUNK_HEIGHT_U))
+            return;
+
+        const Chunk::ChunkPos chunkPos(p_blockPos.x >> CHUNK_AXIS_SHIFT, p_blockPos.z >> CHUNK_AXIS_SHIFT);
+        const uint32_t x = static_cast<uint32_t>(p_blockPos.x) & (CHUNK_AXIS_LENGTH_U - 1);
+        const uint32_t z = static_cast<uint32_t>(p_blockPos.z) & (CHUNK_AXIS_LENGTH_U - 1);
+
+        const uint32_t index = static_cast<uint32_t>(Core::get_block_index(x, static_cast<uint32_t>(p_blockPos.y), z));
+        m_tickScheduler.schedule(chunkPos, index, static_cast<uint32_t>(godot::MAX(p_delayTicks, 1)));
+    }
+
+    bool World::place_fluid_source(godot::Vector3i p_blockPos, int32_t p_kind)
+    {
+        if (p_kind < 0 || p_kind >= Core::Fluid::KIND_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to place unknown fluid kind {}.", p_kind);
+            return false;
+        }
+
+        uint32_t x, y, z;
+        Chunk *pChunk = find_block_chunk(p_blockPos, x, y, z);
+        if (!pChunk)
+            return false;
+
+        begin_edit();
+        const bool placed = m_fluids.set_fluid(this, pChunk, x, y, z, Core::Fluid::make_source(static_cast<Core::Fluid::Kind>(p_kind)));
+        commit_edit();
+        return placed;
+    }
+
+    bool World::remove_fluid(godot::Vector3i p_blockPos)
+    {
+        uint32_t x, y, z;
+        Chunk *pChunk = find_block_chunk(p_blockPos, x, y, z);
+        if (!pChunk)
+            return false;
+
+        begin_edit();
+        m_fluids.set_fluid(this, pChunk, x, y, z, Core::Fluid::NONE);
+        commit_edit();
+        return true;
+    }
+
+    int32_t World::get_fluid_level(godot::Vector3i p_blockPos) const
+    {
+        uint32_t x, y, z;
+        Chunk *pChunk = find_block_chunk(p_blockPos, x, y, z);
+
+        return pChunk ? Core::Fluid::get_level(pChunk->get_fluid(pChunk->get_block_index_local(x, y, z))) : -1;
+    }
+
+    Dictionary World::raycast(godot::Vector3 p_origin, godot::Vector3 p_direction, float p_maxDistance) const
+    {
+        Dictionary result;
+
+        VoxelRaycast::Hit hit;
+        if (!VoxelRaycast::cast(m_chunks, p_origin, p_direction, p_maxDistance, hit))
+            return result;
+
+        result["position"] = hit.block;
+        result["normal"] = hit.normal;
+        result["distance"] = hit.distance;
+        result["id"] = hit.id;
+        return result;
+    }
+
+    PackedFloat32Array World::raycast_batch(const PackedVector3Array &p_rays, float p_maxDistance) const
+    {
+        PackedFloat32Array distances;
+        if (p_rays.size() % 2 != 0)
+        {
+            VOXEL_LOG_ERROR("Attempted to cast a batch of {} ray vectors, expected origin/direction pairs.",
+                            p_rays.size());
+            return distances;
+        }
+
+        const int64_t count = p_rays.size() / 2;
+        distances.resize(count);
+
+        const Vector3 *pRays = p_rays.ptr();
+        float *pDistances = distances.ptrw();
+
+        VoxelRaycast::Hit hit;
+        for (int64_t i = 0; i < count; i++)
+        {
+            const bool blocked = VoxelRaycast::cast(m_chunks, pRays[i * 2], pRays[i * 2 + 1], p_maxDistance, hit);
+            pDistances[i] = blocked ? hit.distance : -1.f;
+        }
+
+        return distances;
+    }
+
+    Dictionary World::move_aabbs(const PackedVector3Array &p_centers, const PackedVector3Array &p_sizes,
+                                 const PackedVector3Array &p_velocities, float p_delta) const
+    {
+        Dictionary result;
+
+        const int64_t count = p_centers.size();
+        const bool sharedSize = p_sizes.size() == 1;
+        if (p_velocities.size() != count || (!sharedSize && p_sizes.size() != count))
+        {
+            VOXEL_LOG_ERROR("Attempted to move {} boxes with {} sizes and {} velocities.",
+                            count, p_sizes.size(), p_velocities.size());
+            return result;
+        }
+
+        PackedVector3Array positions = p_centers;
+        PackedInt32Array contacts;
+        contacts.resize(count);
+
+        Vector3 *pPositions = positions.ptrw();
+        int32_t *pContacts = contacts.ptrw();
+        const Vector3 *pSizes = p_sizes.ptr();
+        const Vector3 *pVelocities = p_velocities.ptr();
+
+        for (int64_t i = 0; i < count; i++)
+        {
+            const Vector3 halfExtents = pSizes[sharedSize ? 0 : i] * 0.5f;
+            pContacts[i] = static_cast<int32_t>(VoxelSweep::move(m_chunks, pPositions[i], halfExtents, pVelocities[i] * p_delta));
+        }
+
+        result["positions"] = positions;
+        result["contacts"] = contacts;
+        return result;
+    }
+
+    int32_t World::make_block_id(int32_t p_material, int32_t p_texture)
+    {
+        if (p_material < 0 || p_material >= Pallet::TYPE_COUNT || p_texture < 0 || p_texture >= Pallet::TEXTURE_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to make a block id from unknown material {} and texture {}.",
+                            p_material, p_texture);
+            return Block::ID_NONE;
+        }
+
+        return Block::make_id(static_cast<Pallet::MaterialType>(p_material), static_cast<Pallet::BlockTexture>(p_texture));
+    }
+
+    Chunk *World::find_block_chunk(godot::Vector3i p_blockPos, uint32_t &r_x, uint32_t &r_y, uint32_t &r_z) const
+    {
+        if (p_blockPos.y < 0 || p_blockPos.y >= static_cast<int32_t>(CHUNK_HEIGHT_U))
+            return nullptr;
+
+        r_x = static_cast<uint32_t>(p_blockPos.x) & (CHUNK_AXIS_LENGTH_U - 1);
+        r_y = static_cast<uint32_t>(p_blockPos.y);
+        r_z = static_cast<uint32_t>(p_blockPos.z) & (CHUNK_AXIS_LENGTH_U - 1);
+
+        return m_chunks.find(Chunk::ChunkPos(p_blockPos.x >> CHUNK_AXIS_SHIFT, p_blockPos.z >> CHUNK_AXIS_SHIFT));
+    }
+
+    int32_t World::get_block(godot::Vector3i p_blockPos) const
+    {
+        uint32_t x, y, z;
+        Chunk *pChunk = find_block_chunk(p_blockPos, x, y, z);
+
+        return pChunk ? pChunk->get_block_at(x, y, z)->to_id() : Block::ID_NONE;
+    }
+
+    void World::set_block(godot::Vector3i p_blockPos, int32_t p_id)
+    {
+        fill_box(p_blockPos, p_blockPos, p_id);
+    }
+
+    void World::begin_edit()
+    {
+        m_editDepth++;
+    }
+
+    void World::commit_edit()
+    {
+        if (m_editDepth == 0)
+        {
+            Tools::Log::warn("Attempted to commit a block edit that was never begun.");
+            return;
+        }
+
+        if (--m_editDepth == 0)
+            flush_dirty_chunks();
+    }
+
+    template <class ShapeFn, class WriteFn>
+    int32_t World::apply_spans(godot::Vector3i p_min, godot::Vector3i p_max, ShapeFn &&p_shape, WriteFn &&p_write)
+    {
+        constexpr int32_t L = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+
+        p_min.y = godot::MAX(p_min.y, 0);
+        p_max.y = godot::MIN(p_max.y, static_cast<int32_t>(CHUNK_HEIGHT_U) - 1);
+        if (p_min.x > p_max.x || p_min.y > p_max.y || p_min.z > p_max.z)
+            return 0;
+
+        begin_edit();
+
+        int32_t count = 0;
+        for (int32_t cz = p_min.z >> CHUNK_AXIS_SHIFT; cz <= p_max.z >> CHUNK_AXIS_SHIFT; cz++)
+        {
+            for (int32_t cx = p_min.x >> CHUNK_AXIS_SHIFT; cx <= p_max.x >> CHUNK_AXIS_SHIFT; cx++)
+            {
+                Chunk *pChunk = m_chunks.find(Chunk::ChunkPos(cx, cz));
+                if (!pChunk)
+                    continue;
+
+                const int32_t chunkX = cx * L;
+                const int32_t chunkZ = cz * L;
+                const int32_t xStart = godot::MAX(p_min.x, chunkX);
+                const int32_t xEnd = godot::MIN(p_max.x, chunkX + L - 1);
+                const int32_t zStart = godot::MAX(p_min.z, chunkZ);
+                const int32_t zEnd = godot::MIN(p_max.z, chunkZ + L - 1);
+
+                for (int32_t y = p_min.y; y <= p_max.y; y++)
+                {
+                    for (int32_t z = zStart; z <= zEnd; z++)
+                    {
+                        // The shape narrows the row to its own span, which is then clipped to this chunk.
+                        int32_t x0 = xStart;
+                        int32_t x1 = xEnd;
+                        if (!p_shape(y, z, x0, x1))
+                            continue;
+
+                        x0 = godot::MAX(x0, xStart);
+                        x1 = godot::MIN(x1, xEnd);
+                        if (x0 > x1)
+                            continue;
+
+                        const uint32_t lx0 = static_cast<uint32_t>(x0 - chunkX);
+                        const uint32_t lx1 = static_cast<uint32_t>(x1 - chunkX);
+                        const uint32_t lz = static_cast<uint32_t>(z - chunkZ);
+
+                        const uint32_t written = p_write(pChunk, lx0, lx1, static_cast<uint32_t>(y), lz);
+                        if (written > 0)
+                        {
+                            mark_span_dirty(pChunk, lx0, lx1, static_cast<uint32_t>(y), lz);
+                            count += static_cast<int32_t>(written);
+                        }
+                    }
+                }
+            }
+        }
+
+        commit_edit();
+        return count;
+    }
+
+    int32_t World::fill_box(godot::Vector3i p_from, godot::Vector3i p_to, int32_t p_id)
+    {
+        if (p_id < Block::ID_AIR || p_id >= Block::ID_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to fill blocks with unknown block id {}.", p_id);
+            return 0;
+        }
+
+        const Block block = Block::from_id(p_id);
+        const Vector3i min(godot::MIN(p_from.x, p_to.x), godot::MIN(p_from.y, p_to.y), godot::MIN(p_from.z, p_to.z));
+        const Vector3i max(godot::MAX(p_from.x, p_to.x), godot::MAX(p_from.y, p_to.y), godot::MAX(p_from.z, p_to.z));
+
+        return apply_spans(
+                min, max,
+                [](int32_t, int32_t, int32_t &, int32_t &)
+                { return true; },
+                [&block](Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+                {
+                    p_chunk->fill_span(x0, x1, y, z, block);
+                    return x1 - x0 + 1;
+                });
+    }
+
+    int32_t World::fill_sphere(godot::Vector3i p_center, float p_radius, int32_t p_id)
+    {
+        if (p_id < Block::ID_AIR || p_id >= Block::ID_COUNT || p_radius < 0.f)
+        {
+            VOXEL_LOG_ERROR("Attempted to fill a sphere with block id {} and radius {}.", p_id, p_radius);
+            return 0;
+        }
+
+        const Block block = Block::from_id(p_id);
+        const int32_t extent = static_cast<int32_t>(std::ceil(p_radius));
+        const float radiusSq = p_radius * p_radius;
+        const Vector3i min(p_center.x - extent, p_center.y - extent, p_center.z - extent);
+        const Vector3i max(p_center.x + extent, p_center.y + extent, p_center.z + extent);
+
+        return apply_spans(
+                min, max,
+                [&p_center, radiusSq](int32_t y, int32_t z, int32_t &r_x0, int32_t &r_x1)
+                {
+                    const float dy = static_cast<float>(y - p_center.y);
+                    const float dz = static_cast<float>(z - p_center.z);
+                    const float remaining = radiusSq - dy * dy - dz * dz;
+                    if (remaining < 0.f)
+                        return false;
+
+                    const int32_t half = static_cast<int32_t>(std::sqrt(remaining));
+                    r_x0 = p_center.x - half;
+                    r_x1 = p_center.x + half;
+                    return true;
+                },
+                [&block](Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+                {
+                    p_chunk->fill_span(x0, x1, y, z, block);
+                    return x1 - x0 + 1;
+                });
+    }
+
+    int32_t World::fill_cylinder(godot::Vector3i p_baseCenter, float p_radius, int32_t p_height, int32_t p_id)
+    {
+        if (p_id < Block::ID_AIR || p_id >= Block::ID_COUNT || p_radius < 0.f || p_height <= 0)
+        {
+            VOXEL_LOG_ERROR("Attempted to fill a cylinder with block id {}, radius {} and height {}.",
+                            p_id, p_radius, p_height);
+            return 0;
+        }
+
+        const Block block = Block::from_id(p_id);
+        const int32_t extent = static_cast<int32_t>(std::ceil(p_radius));
+        const float radiusSq = p_radius * p_radius;
+        const Vector3i min(p_baseCenter.x - extent, p_baseCenter.y, p_baseCenter.z - extent);
+        const Vector3i max(p_baseCenter.x + extent, p_baseCenter.y + p_height - 1, p_baseCenter.z + extent);
+
+        return apply_spans(
+                min, max,
+                [&p_baseCenter, radiusSq](int32_t, int32_t z, int32_t &r_x0, int32_t &r_x1)
+                {
+                    const float dz = static_cast<float>(z - p_baseCenter.z);
+                    const float remaining = radiusSq - dz * dz;
+                    if (remaining < 0.f)
+                        return false;
+
+                    const int32_t half = static_cast<int32_t>(std::sqrt(remaining));
+                    r_x0 = p_baseCenter.x - half;
+                    r_x1 = p_baseCenter.x + half;
+                    return true;
+                },
+                [&block](Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+                {
+                    p_chunk->fill_span(x0, x1, y, z, block);
+                    return x1 - x0 + 1;
+                });
+    }
+
+    int32_t World::replace_blocks(godot::Vector3i p_from, godot::Vector3i p_to, int32_t p_fromId, int32_t p_toId)
+    {
+        if (p_fromId < Block::ID_AIR || p_fromId >= Block::ID_COUNT || p_toId < Block::ID_AIR || p_toId >= Block::ID_COUNT)
+        {
+            VOXEL_LOG_ERROR("Attempted to replace block id {} with {}.", p_fromId, p_toId);
+            return 0;
+        }
+
+        const Block from = Block::from_id(p_fromId);
+        const Block to = Block::from_id(p_toId);
+        const Vector3i min(godot::MIN(p_from.x, p_to.x), godot::MIN(p_from.y, p_to.y), godot::MIN(p_from.z, p_to.z));
+        const Vector3i max(godot::MAX(p_from.x, p_to.x), godot::MAX(p_from.y, p_to.y), godot::MAX(p_from.z, p_to.z));
+
+        return apply_spans(
+                min, max,
+                [](int32_t, int32_t, int32_t &, int32_t &)
+                { return true; },
+                [&from, &to](Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+                { return p_chunk->replace_span(x0, x1, y, z, from, to); });
+    }
+
+    bool World::get_region_bounds(const AABB &p_region, Vector3i &r_min, Vector3i &r_size) const
+    {
+        const Vector3 end = p_region.get_end();
+        r_min = Vector3i(static_cast<int32_t>(std::floor(p_region.position.x)),
+                         static_cast<int32_t>(std::floor(p_region.position.y)),
+                         static_cast<int32_t>(std::floor(p_region.position.z)));
+        r_size = Vector3i(static_cast<int32_t>(std::ceil(end.x)) - r_min.x,
+                          static_cast<int32_t>(std::ceil(end.y)) - r_min.y,
+                          static_cast<int32_t>(std::ceil(end.z)) - r_min.z);
+
+        if (r_size.x <= 0 || r_size.y <= 0 || r_size.z <= 0)
+            return false;
+
+        const int64_t count = static_cast<int64_t>(r_size.x) * r_size.y * r_size.z;
+        if (count > MAX_REGION_BLOCKS)
+        {
+            VOXEL_LOG_ERROR("Attempted to access a region of {} blocks, the limit is {}.", count, MAX_REGION_BLOCKS);
+            return false;
+        }
+
+        return true;
+    }
+
+    PackedInt32Array World::read_region(const AABB &p_region) const
+    {
+        PackedInt32Array ids;
+
+        Vector3i min, size;
+        if (!get_region_bounds(p_region, min, size))
+            return ids;
+
+        ids.resize(static_cast<int64_t>(size.x) * size.y * size.z);
+        ids.fill(Block::ID_NONE);
+        int32_t *pIds = ids.ptrw();
+
+        constexpr int32_t L = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        const Vector3i max = min + size - Vector3i(1, 1, 1);
+        const int32_t yStart = godot::MAX(min.y, 0);
+        const int32_t yEnd = godot::MIN(max.y, static_cast<int32_t>(CHUNK_HEIGHT_U) - 1);
+        const int64_t rowStride = size.x;
+        const int64_t layerStride = static_cast<int64_t>(size.x) * size.z;
+
+        for (int32_t cz = min.z >> CHUNK_AXIS_SHIFT; cz <= max.z >> CHUNK_AXIS_SHIFT; cz++)
+        {
+            for (int32_t cx = min.x >> CHUNK_AXIS_SHIFT; cx <= max.x >> CHUNK_AXIS_SHIFT; cx++)
+            {
+                const Chunk *pChunk = m_chunks.find(Chunk::ChunkPos(cx, cz));
+                if (!pChunk)
+                    continue;
+
+                const int32_t x0 = godot::MAX(min.x, cx * L);
+                const int32_t x1 = godot::MIN(max.x, cx * L + L - 1);
+                const int32_t z0 = godot::MAX(min.z, cz * L);
+                const int32_t z1 = godot::MIN(max.z, cz * L + L - 1);
+
+                for (int32_t y = yStart; y <= yEnd; y++)
+                {
+                    for (int32_t z = z0; z <= z1; z++)
+                    {
+                        const uint32_t localX0 = static_cast<uint32_t>(x0 - cx * L);
+                        const uint32_t localZ = static_cast<uint32_t>(z - cz * L);
+                        int32_t *pOut = pIds + (y - min.y) * layerStride + (z - min.z) * rowStride + (x0 - min.x);
+
+                        // Looked up per block, rows along x are only contiguous in the linear layout.
+                        for (int32_t x = 0; x <= x1 - x0; x++)
+                            pOut[x] = pChunk->get_block_at(localX0 + static_cast<uint32_t>(x), static_cast<uint32_t>(y), localZ)->to_id();
+                    }
+                }
+            }
+        }
+
+        return ids;
+    }
+
+    int32_t World::write_region(const AABB &p_region, const PackedInt32Array &p_ids)
+    {
+        Vector3i min, size;
+        if (!get_region_bounds(p_region, min, size))
+            return 0;
+
+        const int64_t count = static_cast<int64_t>(size.x) * size.y * size.z;
+        if (p_ids.size() != count)
+        {
+            VOXEL_LOG_ERROR("Attempted to write {} block ids to a region of {} blocks.", p_ids.size(), count);
+            return 0;
+        }
+
+        const int32_t *pIds = p_ids.ptr();
+        for (int64_t i = 0; i < count; i++)
+        {
+            if (pIds[i] < Block::ID_NONE || pIds[i] >= Block::ID_COUNT)
+            {
+                VOXEL_LOG_ERROR("Attempted to write unknown block id {} at region index {}.", pIds[i], i);
+                return 0;
+            }
+        }
+
+        constexpr int32_t L = static_cast<int32_t>(CHUNK_AXIS_LENGTH_U);
+        const int64_t rowStride = size.x;
+        const int64_t layerStride = static_cast<int64_t>(size.x) * size.z;
+
+        return apply_spans(
+                min, min + size - Vector3i(1, 1, 1),
+                [](int32_t, int32_t, int32_t &, int32_t &)
+                { return true; },
+                [&](Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+                {
+                    const Chunk::ChunkPos pos = p_chunk->get_pos();
+                    const int32_t *pIn = pIds + (static_cast<int32_t>(y) - min.y) * layerStride +
+                                         (pos.y * L + static_cast<int32_t>(z) - min.z) * rowStride +
+                                         (pos.x * L + static_cast<int32_t>(x0) - min.x);
+
+                    // ID_NONE entries keep the block already there, so the row is still written in one copy.
+                    Block row[CHUNK_AXIS_LENGTH_U];
+                    uint32_t written = 0;
+                    for (uint32_t i = 0; i <= x1 - x0; i++)
+                    {
+                        if (pIn[i] == Block::ID_NONE)
+                        {
+                            row[i] = *p_chunk->get_block_at(x0 + i, y, z);
+                            continue;
+                        }
+
+                        row[i] = Block::from_id(pIn[i]);
+                        written++;
+                    }
+
+                    if (written > 0)
+                        p_chunk->write_span(x0, x1, y, z, row);
+
+                    return written;
+                });
+    }
+
+    void World::mark_span_dirty(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z)
+    {
+        p_chunk->set_modified(true);
+        // Deltas bring every peer's copy up to date, only edits that aren't replicated make it stale.
+        if (m_replicateEdits)
+            m_deltaBatch.record_span(p_chunk, x0, x1, y, z);
+        else
+            p_chunk->set_content_version(next_content_version());
+        m_lightEngine.queue_span(p_chunk, x0, x1, y, z);
+        m_fluids.on_span_changed(p_chunk, x0, x1, y, z);
+        mark_span_remesh(p_chunk, x0, x1, y, z, true);
+
+        if (m_editDepth == 0)
+            flush_dirty_chunks();
+    }
+
+    void World::mark_fluid_dirty(Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z)
+    {
+        p_chunk->set_modified(true);
+        if (m_replicateEdits)
+            m_deltaBatch.record_fluid(p_chunk, x, y, z);
+        else
+            p_chunk->set_content_version(next_content_version());
+        mark_span_remesh(p_chunk, x, x, y, z);
+    }
+
+    void World::mark_span_remesh(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, bool p_geometry)
+    {
+        const uint32_t section = y / SECTION_AXIS_LENGTH_U;
+        const uint32_t sectionY = y % SECTION_AXIS_LENGTH_U;
+
+        // Light changes only touch the render mesh, block changes also touch collision shapes.
+        auto mark = [this, p_geometry](Chunk *p_target, uint32_t p_section)
+        {
+            mark_section_dirty(p_target, p_section);
+            if (p_geometry)
+                p_target->mark_collision_dirty(1u << p_section);
+        };
+
+        mark(p_chunk, section);
+
+        // Faces on a section or chunk border are shared with the section or chunk on the other side.
+        if (sectionY == 0 && section > 0)
+            mark(p_chunk, section - 1);
+        if (sectionY == SECTION_AXIS_LENGTH_U - 1 && section < CHUNK_SECTION_COUNT - 1)
+            mark(p_chunk, section + 1);
+
+        const Chunk::Neighbors &neighbors = p_chunk->get_neighbors();
+        if (x0 == 0 && neighbors.neg_x)
+            mark(neighbors.neg_x, section);
+        if (x1 == CHUNK_AXIS_LENGTH_U - 1 && neighbors.pos_x)
+            mark(neighbors.pos_x, section);
+        if (z == 0 && neighbors.neg_z)
+            mark(neighbors.neg_z, section);
+        if (z == CHUNK_AXIS_LENGTH_U - 1 && neighbors.pos_z)
+            mark(neighbors.pos_z, section);
+    }
+
+    void World::mark_section_dirty(Chunk *p_chunk, uint32_t p_section)
+    {
+        if (p_chunk->get_dirty_section_mask() == 0)
+            m_dirtyChunks.emplace_back(p_chunk);
+
+        p_chunk->mark_section_dirty(p_section);
+    }
+
+    void World::flush_dirty_chunks()
+    {
+        VOXEL_TRACE_ZONE("World::flush_dirty_chunks");
+
+        // Relighting dirties the sections whose light changed, so it runs before the remesh list is drained.
+        m_lightEngine.propagate(this);
+
+        if (m_dirtyChunks.empty())
+            return;
+
+        for (Chunk *pChunk : m_dirtyChunks)
+        {
+            ChunkMesher::mesh_queue(pChunk);
+            pChunk->clear_dirty_sections();
+        }
+
+        VOXEL_LOG_DEBUG("Block edits queued {} chunk remesh(es).", m_dirtyChunks.size());
+        m_dirtyChunks.clear();
+    }
+
+    bool World::can_afford(const FrameBudget &p_budget, StreamingStep p_step) const
+    {
+        // One step always runs so streaming can't stall on a step that is larger than the whole budget.
+        if (p_budget.steps == 0)
+            return true;
+
+        const uint64_t elapsed = Time::get_singleton()->get_ticks_usec() - p_budget.startUsec;
+        return elapsed + static_cast<uint64_t>(m_stepCostUsec[p_step]) <= p_budget.timeUsec;
+    }
+
+    void World::record_step(FrameBudget &r_budget, StreamingStep p_step, uint64_t p_stepStartUsec)
+    {
+        const double measured = static_cast<double>(Time::get_singleton()->get_ticks_usec() - p_stepStartUsec);
+
+        // Moving average, so one slow chunk doesn't freeze a step type but a trend of them is respected.
+        m_stepCostUsec[p_step] = m_stepCostUsec[p_step] * 0.75 + measured * 0.25;
+        r_budget.steps++;
+    }
 
     void World::_bind_methods()
     {
@@ -73,9 +1132,160 @@ namespace Voxel
         ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "settings", PROPERTY_HINT_RESOURCE_TYPE, "GenerationSettings"),
                      "set_settings", "get_settings");
 
-        ClassDB::bind_method(D_METHOD("request_rebuild"), &World::request_rebuild);
-        ClassDB::bind_method(D_METHOD("rebuild"), &World::rebuild);
-        ClassDB::bind_method(D_METHOD("rebuild_debounce_timer"), &World::rebuild_debounce_timer);
+        ClassDB::bind_method(D_METHOD("get_simulation_distance"), &World::get_simulation_distance);
+        ClassDB::bind_method(D_METHOD("set_simulation_distance", "v"), &World::set_simulation_distance);
+        ss.str("");
+        ss << "0," << SIMULATION_DISTANCE_MAX << ",suffix:Chunks";
+        ADD_PROPERTY(PropertyInfo(Variant::INT, "simulation_distance", PROPERTY_HINT_RANGE, ss.str().c_str()),
+                     "set_simulation_distance", "get_simulation_distance");
+
+        ClassDB::bind_method(D_METHOD("get_random_tick_speed"), &World::get_random_tick_speed);
+        ClassDB::bind_method(D_METHOD("set_random_tick_speed", "v"), &World::set_random_tick_speed);
+        ADD_PROPERTY(PropertyInfo(Variant::INT, "random_tick_speed", PROPERTY_HINT_RANGE, "0,64,1"),
+                     "set_random_tick_speed", "get_random_tick_speed");
+
+        ClassDB::bind_method(D_METHOD("set_light_emission", "texture", "level"), &World::set_light_emission);
+        ClassDB::bind_method(D_METHOD("set_random_tick_handler", "texture", "handler"), &World::set_random_tick_handler);
+        ClassDB::bind_method(D_METHOD("set_scheduled_update_handler", "texture", "handler"), &World::set_scheduled_update_handler);
+        ClassDB::bind_method(D_METHOD("schedule_block_update", "block_position", "delay_ticks"), &World::schedule_block_update);
+        ClassDB::bind_method(D_METHOD("place_fluid_source", "block_position", "kind"), &World::place_fluid_source);
+        ClassDB::bind_method(D_METHOD("remove_fluid", "block_position"), &World::remove_fluid);
+        ClassDB::bind_method(D_METHOD("get_fluid_level", "block_position"), &World::get_fluid_level);
+        ClassDB::bind_method(D_METHOD("get_active_fluid_cell_count"), &World::get_active_fluid_cell_count);
+
+        ClassDB::bind_method(D_METHOD("get_save_path"), &World::get_save_path);
+        ClassDB::bind_method(D_METHOD("set_save_path", "path"), &World::set_save_path);
+        ADD_PROPERTY(PropertyInfo(Variant::STRING, "save_path"), "set_save_path", "get_save_path");
+        ClassDB::bind_method(D_METHOD("get_replicate_edits"), &World::get_replicate_edits);
+        ClassDB::bind_method(D_METHOD("set_replicate_edits", "enabled"), &World::set_replicate_edits);
+        ADD_PROPERTY(PropertyInfo(Variant::BOOL, "replicate_edits"), "set_replicate_edits", "get_replicate_edits");
+        ClassDB::bind_method(D_METHOD("encode_chunk_packet", "chunk_pos"), &World::encode_chunk_packet);
+        ClassDB::bind_method(D_METHOD("apply_chunk_packet", "packet"), &World::apply_chunk_packet);
+        ClassDB::bind_method(D_METHOD("take_block_deltas"), &World::take_block_deltas);
+        ClassDB::bind_method(D_METHOD("apply_block_deltas", "packet"), &World::apply_block_deltas);
+        ClassDB::bind_method(D_METHOD("apply_packet", "packet"), &World::apply_packet);
+
+        ClassDB::bind_method(D_METHOD("add_peer", "peer_id", "position", "radius"), &World::add_peer);
+        ClassDB::bind_method(D_METHOD("update_peer", "peer_id", "position", "view_direction"), &World::update_peer);
+        ClassDB::bind_method(D_METHOD("remove_peer", "peer_id"), &World::remove_peer);
+        ClassDB::bind_method(D_METHOD("take_peer_packets", "peer_id"), &World::take_peer_packets);
+        ClassDB::bind_method(D_METHOD("get_peer_chunk_count", "peer_id"), &World::get_peer_chunk_count);
+        ClassDB::bind_method(D_METHOD("get_peer_bandwidth_kb"), &World::get_peer_bandwidth_kb);
+        ClassDB::bind_method(D_METHOD("set_peer_bandwidth_kb", "kb"), &World::set_peer_bandwidth_kb);
+        ADD_PROPERTY(PropertyInfo(Variant::INT, "peer_bandwidth_kb"), "set_peer_bandwidth_kb", "get_peer_bandwidth_kb");
+
+        ClassDB::bind_method(D_METHOD("get_save_mode"), &World::get_save_mode);
+        ClassDB::bind_method(D_METHOD("set_save_mode", "mode"), &World::set_save_mode);
+        ADD_PROPERTY(PropertyInfo(Variant::INT, "save_mode", PROPERTY_HINT_ENUM, "Full,Edits"), "set_save_mode", "get_save_mode");
+        ClassDB::bind_method(D_METHOD("get_save_interval"), &World::get_save_interval);
+        ClassDB::bind_method(D_METHOD("set_save_interval", "seconds"), &World::set_save_interval);
+        ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "save_interval"), "set_save_interval", "get_save_interval");
+        ClassDB::bind_method(D_METHOD("save_world"), &World::save_world);
+
+        ClassDB::bind_method(D_METHOD("get_collision_radius"), &World::get_collision_radius);
+        ClassDB::bind_method(D_METHOD("set_collision_radius", "v"), &World::set_collision_radius);
+        ss.str("");
+        ss << "0," << COLLISION_RADIUS_MAX << ",suffix:Chunks";
+        ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_radius", PROPERTY_HINT_RANGE, ss.str().c_str()),
+                     "set_collision_radius", "get_collision_radius");
+        ClassDB::bind_method(D_METHOD("add_collision_body", "body"), &World::add_collision_body);
+        ClassDB::bind_method(D_METHOD("remove_collision_body", "body"), &World::remove_collision_body);
+        ClassDB::bind_method(D_METHOD("get_collision_chunk_count"), &World::get_collision_chunk_count);
+
+        ClassDB::bind_method(D_METHOD("raycast", "origin", "direction", "max_distance"), &World::raycast);
+        ClassDB::bind_method(D_METHOD("raycast_batch", "rays", "max_distance"), &World::raycast_batch);
+        ClassDB::bind_method(D_METHOD("move_aabbs", "centers", "sizes", "velocities", "delta"), &World::move_aabbs);
+        ClassDB::bind_integer_constant(get_class_static(), "", "SAVE_FULL", SAVE_FULL);
+        ClassDB::bind_integer_constant(get_class_static(), "", "SAVE_EDITS", SAVE_EDITS);
+        ClassDB::bind_integer_constant(get_class_static(), "", "CONTACT_NONE", VoxelSweep::CONTACT_NONE);
+        ClassDB::bind_integer_constant(get_class_static(), "", "CONTACT_FLOOR", VoxelSweep::CONTACT_FLOOR);
+        ClassDB::bind_integer_constant(get_class_static(), "", "CONTACT_CEILING", VoxelSweep::CONTACT_CEILING);
+        ClassDB::bind_integer_constant(get_class_static(), "", "CONTACT_WALL_X", VoxelSweep::CONTACT_WALL_X);
+        ClassDB::bind_integer_constant(get_class_static(), "", "CONTACT_WALL_Z", VoxelSweep::CONTACT_WALL_Z);
+        ClassDB::bind_integer_constant(get_class_static(), "", "FLUID_WATER", Core::Fluid::KIND_WATER);
+        ClassDB::bind_integer_constant(get_class_static(), "", "FLUID_LAVA", Core::Fluid::KIND_LAVA);
+        ClassDB::bind_integer_constant(get_class_static(), "", "FLUID_LEVEL_MAX", Core::Fluid::LEVEL_MAX);
+
+        ClassDB::bind_static_method(get_class_static(), D_METHOD("make_block_id", "material", "texture"), &World::make_block_id);
+        ClassDB::bind_method(D_METHOD("get_block", "block_position"), &World::get_block);
+        ClassDB::bind_method(D_METHOD("set_block", "block_position", "id"), &World::set_block);
+        ClassDB::bind_method(D_METHOD("begin_edit"), &World::begin_edit);
+        ClassDB::bind_method(D_METHOD("commit_edit"), &World::commit_edit);
+        ClassDB::bind_method(D_METHOD("fill_box", "from", "to", "id"), &World::fill_box);
+        ClassDB::bind_method(D_METHOD("fill_sphere", "center", "radius", "id"), &World::fill_sphere);
+        ClassDB::bind_method(D_METHOD("fill_cylinder", "base_center", "radius", "height", "id"), &World::fill_cylinder);
+        ClassDB::bind_method(D_METHOD("read_region", "region"), &World::read_region);
+        ClassDB::bind_method(D_METHOD("write_region", "region", "ids"), &World::write_region);
+        ClassDB::bind_method(D_METHOD("replace_blocks", "from", "to", "from_id", "to_id"), &World::replace_blocks);
+
+        ClassDB::bind_method(D_METHOD("get_streaming_budget_ms"), &World::get_streaming_budget_ms);
+        ClassDB::bind_method(D_METHOD("set_streaming_budget_ms", "v"), &World::set_streaming_budget_ms);
+        ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "streaming_budget_ms", PROPERTY_HINT_RANGE, "0.1,16.6,0.1,suffix:ms"),
+                     "set_streaming_budget_ms", "get_streaming_budget_ms");
+
+        ClassDB::bind_method(D_METHOD("get_upload_budget_kb"), &World::get_upload_budget_kb);
+        ClassDB::bind_method(D_METHOD("set_upload_budget_kb", "v"), &World::set_upload_budget_kb);
+        ADD_PROPERTY(PropertyInfo(Variant::INT, "upload_budget_kb", PROPERTY_HINT_RANGE, "64,65536,1,suffix:KiB"),
+                     "set_upload_budget_kb", "get_upload_budget_kb");
+
+        ClassDB::bind_method(D_METHOD("add_ticket", "position", "radius", "priority"), &World::add_ticket);
+        ClassDB::bind_method(D_METHOD("move_ticket", "id", "position"), &World::move_ticket);
+        ClassDB::bind_method(D_METHOD("remove_ticket", "id"), &World::remove_ticket);
+        ClassDB::bind_method(D_METHOD("has_ticket", "id"), &World::has_ticket);
+        ClassDB::bind_method(D_METHOD("get_loaded_chunk_count"), &World::get_loaded_chunk_count);
+        ClassDB::bind_method(D_METHOD("get_pending_chunk_count"), &World::get_pending_chunk_count);
+        ClassDB::bind_method(D_METHOD("get_mesh_allocation_count"), &World::get_mesh_allocation_count);
+
+        ClassDB::bind_method(D_METHOD("get_tracing"), &World::get_tracing);
+        ClassDB::bind_method(D_METHOD("set_tracing", "v"), &World::set_tracing);
+        ADD_PROPERTY(PropertyInfo(Variant::BOOL, "tracing"), "set_tracing", "get_tracing");
+        ClassDB::bind_method(D_METHOD("save_trace", "path"), &World::save_trace);
+        ClassDB::bind_method(D_METHOD("clear_trace"), &World::clear_trace);
+        ClassDB::bind_method(D_METHOD("get_trace_msec", "zone"), &World::get_trace_msec);
+
+        ClassDB::bind_method(D_METHOD("request_rebuild"), &World::request_rebuild);
+        ClassDB::bind_method(D_METHOD("refresh_materials"), &World::refresh_materials);
+        ClassDB::bind_method(D_METHOD("rebuild"), &World::rebuild);
+        ClassDB::bind_method(D_METHOD("rebuild_debounce_timer"), &World::rebuild_debounce_timer);
+    }
+
+    bool World::save_trace(const String &p_path) const
+    {
+        const String path = ProjectSettings::get_singleton()->globalize_path(p_path);
+        return Tools::Trace::write_chrome_json(path.utf8().get_data());
+    }
+
+    double World::get_trace_msec(const String &p_zone) const
+    {
+        return Tools::Trace::get_frame_msec(p_zone.utf8().get_data());
+    }
+
+    void World::add_trace_monitors()
+    {
+        Performance *pPerformance = Performance::get_singleton();
+        if (m_hasTraceMonitors || pPerformance->has_custom_monitor(TRACE_MONITORS[0][0]))
+            return;
+
+        for (const auto &monitor : TRACE_MONITORS)
+        {
+            Array arguments;
+            arguments.push_back(String(monitor[1]));
+            pPerformance->add_custom_monitor(monitor[0], Callable(this, "get_trace_msec"), arguments);
+        }
+
+        m_hasTraceMonitors = true;
+    }
+
+    void World::remove_trace_monitors()
+    {
+        if (!m_hasTraceMonitors)
+            return;
+
+        Performance *pPerformance = Performance::get_singleton();
+        for (const auto &monitor : TRACE_MONITORS)
+            pPerformance->remove_custom_monitor(monitor[0]);
+
+        m_hasTraceMonitors = false;
     }
 
     void World::build_debounce_timer()
@@ -115,10 +1325,53 @@ namespace Voxel
     {
         m_pDebounceTimer->connect("timeout", Callable(this, "rebuild"));
         m_generationSettings->connect("changed", Callable(this, "request_rebuild"));
+        m_pallet->connect("changed", Callable(this, "refresh_materials"));
+        m_isSubscribed = true;
 
         Tools::Log::debug("World subscribed to signal(s).");
     }
 
+    void World::set_settings(const godot::Ref<Resource::GenerationSettings> &g)
+    {
+        const Callable onChanged(this, "request_rebuild");
+
+        if (m_isSubscribed && m_generationSettings.is_valid() && m_generationSettings->is_connected("changed", onChanged))
+            m_generationSettings->disconnect("changed", onChanged);
+
+        m_generationSettings = g;
+
+        if (m_isSubscribed && m_generationSettings.is_valid())
+            m_generationSettings->connect("changed", onChanged);
+
+        request_rebuild();
+    }
+
+    void World::set_pallet(const godot::Ref<Resource::Pallet> &p)
+    {
+        const Callable onChanged(this, "refresh_materials");
+
+        if (m_isSubscribed && m_pallet.is_valid() && m_pallet->is_connected("changed", onChanged))
+            m_pallet->disconnect("changed", onChanged);
+
+        m_pallet = p;
+
+        if (m_isSubscribed && m_pallet.is_valid())
+            m_pallet->connect("changed", onChanged);
+
+        refresh_materials();
+    }
+
+    void World::refresh_materials()
+    {
+        VOXEL_TRACE_ZONE("World::refresh_materials");
+
+        m_chunks.for_each([this](Chunk *p_chunk)
+                          {
+                              p_chunk->set_pallet(m_pallet);
+                              ChunkMesher::apply_materials(p_chunk);
+                          });
+    }
+
     void World::request_rebuild()
     {
         if (!is_inside_tree())
@@ -135,97 +1388,671 @@ namespace Voxel
             m_pDebounceTimer->start();
         }
 
+        // Whatever is left of a rebuild in progress was made for settings that no longer apply.
+        if (!m_staleChunks.empty())
+        {
+            VOXEL_LOG_DEBUG("Abandoned {} chunk(s) of the rebuild in progress.", m_staleChunks.size());
+            m_staleChunks.clear();
+        }
+
         Tools::Log::debug("World rebuild requested!");
     }
 
     void World::rebuild()
     {
-        unload_world();
-        generate_spawn();
+        // Chunks stay loaded and keep their old meshes. Those built with other generation settings are regenerated in
+        // place over the following frames, nearest the camera first. Settings the generator doesn't read leave every
+        // chunk as it is.
+        ensure_spawn_ticket();
+
+        const uint64_t generationHash = get_generation_hash();
+        m_staleChunks.clear();
+        m_chunks.for_each([this, generationHash](Chunk *p_chunk)
+                          {
+                              if (p_chunk->get_generation_hash() != generationHash)
+                                  m_staleChunks.emplace_back(Tools::Hash::chunk(p_chunk));
+                          });
+
+        sort_stale_chunks();
+
+        VOXEL_LOG_DEBUG("World rebuild executed! {} chunk(s) queued for regeneration.", m_staleChunks.size());
+    }
+
+    Chunk::ChunkPos World::get_camera_chunk_pos() const
+    {
+        Viewport *pViewport = get_viewport();
+        Camera3D *pCamera = pViewport ? pViewport->get_camera_3d() : nullptr;
+
+        return pCamera ? to_chunk_pos(pCamera->get_global_position()) : Chunk::ChunkPos(0, 0);
+    }
+
+    void World::sort_stale_chunks()
+    {
+        m_staleSortCenter = get_camera_chunk_pos();
+        const Chunk::ChunkPos center = m_staleSortCenter;
+
+        // Farthest first so the nearest chunk is always popped off the back.
+        std::sort(m_staleChunks.begin(), m_staleChunks.end(), [center](uint64_t a, uint64_t b)
+                  {
+                      const Chunk::ChunkPos posA = Tools::Hash::chunk_pos_from(a);
+                      const Chunk::ChunkPos posB = Tools::Hash::chunk_pos_from(b);
+                      const int64_t ax = posA.x - center.x, az = posA.y - center.y;
+                      const int64_t bx = posB.x - center.x, bz = posB.y - center.y;
+                      return ax * ax + az * az > bx * bx + bz * bz;
+                  });
+    }
+
+    size_t World::regenerate_next_stale_chunk()
+    {
+        VOXEL_TRACE_ZONE("World::regenerate_next_stale_chunk");
+
+        while (!m_staleChunks.empty())
+        {
+            const uint64_t key = m_staleChunks.back();
+            m_staleChunks.pop_back();
+
+            // Unloaded by its tickets, or already streamed in with the current settings.
+            Chunk *pChunk = m_chunks.find(Tools::Hash::chunk_pos_from(key));
+            if (!pChunk || pChunk->get_generation_hash() == get_generation_hash())
+                continue;
+
+            // Edits are saved against the chunk's old baseline first, where they wait in case the settings change
+            // back. Without a save directory they would be lost, so the chunk keeps its old blocks instead.
+            pChunk->save(m_io);
+            if (pChunk->is_modified())
+                continue;
+
+            // A full save holds every block, it is what the chunk is whatever the settings. An overlay only loads over
+            // the baseline it was recorded against, otherwise the chunk is generated.
+            reload_blocks(pChunk);
 
-        Tools::Log::debug("World rebuild executed!");
+            // Replace the old mesh in the same frame the new blocks exist so the swap is never visible.
+            return ChunkMesher::mesh_now(pChunk);
+        }
+
+        return 0;
+    }
+
+    void World::generate_new_chunk(int x, int z, const std::vector<uint8_t> *p_saved)
+    {
+        Chunk *pChunk = create_chunk(x, z);
+
+        // Decoding a saved chunk is much cheaper than generating it again.
+        if (!p_saved || !pChunk->load_blocks(p_saved->data(), p_saved->size()))
+            pChunk->generate_blocks();
+    }
+
+    void World::reload_blocks(Chunk *p_chunk)
+    {
+        std::vector<uint8_t> saved;
+        if (!m_io.load_now(p_chunk->get_pos(), saved) || !p_chunk->load_blocks(saved.data(), saved.size()))
+            p_chunk->generate_blocks();
     }
 
-    void World::generate_new_chunk(int x, int z)
+    Chunk *World::create_chunk(int x, int z)
     {
         Chunk *pChunk = memnew(Chunk);
         pChunk->set_world_position(this, x * CHUNK_AXIS_LENGTH_U, z * CHUNK_AXIS_LENGTH_U);
         pChunk->set_pallet(m_pallet);
 
-        m_chunks.emplace(Tools::Hash::chunk(pChunk), pChunk);
+        m_chunks.insert(pChunk);
 
 #ifdef DEBUG_VERBOSE
         auto chunkPos = pChunk->get_pos();
         auto tryGetChunk = try_get_chunk(chunkPos);
 
         if (tryGetChunk)
-            Tools::Log::debug() << "Verified chunk at " << Tools::String::to_string(chunkPos) << " added to world.";
+            VOXEL_LOG_DEBUG("Verified chunk at {} added to world.", chunkPos);
         else
-            Tools::Log::error() << "Failed to add chunk at " << Tools::String::to_string(chunkPos) << " to world!";
+            VOXEL_LOG_ERROR("Failed to add chunk at {} to world!", chunkPos);
 #endif
 
-        pChunk->set_name("Chunk_" + itos(x) + "_" + itos(z));
-
-        add_child(pChunk);
-        pChunk->set_owner(this);
-
-        pChunk->generate_blocks();
+        pChunk->initialize();
+        return pChunk;
     }
 
     void World::generate_spawn()
     {
-        set_generation_rng();
+        ensure_spawn_ticket();
 
-        Tools::Log::debug() << "Building spawn...";
+        Tools::Log::debug("Building spawn...");
 
         ChunkMesher::debug_start_mesh_count();
 
         uint32_t count = 0;
 
-        std::stringstream ss;
-        ss << "Created chunks: ";
+        const bool listChunks = Tools::Log::is_enabled(Tools::Log::Level::Debug);
+        std::string created = "Created chunks: ";
 
+        // The spawn ticket only queued these; spawn is built synchronously so it is never seen half loaded.
+        std::vector<uint8_t> saved;
         for (int x = -m_spawnRadius; x <= m_spawnRadius; x++)
         {
             for (int z = -m_spawnRadius; z <= m_spawnRadius; z++)
             {
                 auto chunk_pos = Chunk::ChunkPos(x, z);
-                ss << Tools::String::to_string(chunk_pos) << " ";
-                generate_new_chunk(x, z);
+                if (m_pendingLoads.erase(Tools::Hash::chunk_pos(chunk_pos)) == 0)
+                    continue;
+
+                if (listChunks)
+                    Tools::Format::format_to(created, "{} ", chunk_pos);
+                generate_new_chunk(x, z, m_io.load_now(chunk_pos, saved) ? &saved : nullptr);
                 count++;
             }
         }
 
-        Tools::Log::debug() << ss.str();
+        if (listChunks)
+            Tools::Log::write_line(Tools::Log::Level::Debug, std::move(created));
 
-        Tools::Log::debug() << "(Re)meshing generated chunks...";
+        Tools::Log::debug("(Re)meshing generated chunks...");
         ChunkMesher::mesh_dequeue(ChunkMesher::DEQUEUE_BATCH_ALL);
-        Tools::Log::debug() << "Finished spawn chunk meshing. " << ChunkMesher::debug_end_mesh_count() << " mesh(es) were generated.";
+        VOXEL_LOG_DEBUG("Finished spawn chunk meshing. {} mesh(es) were generated.",
+                        ChunkMesher::debug_end_mesh_count());
+
+        VOXEL_LOG_DEBUG("Spawn complete. {} chunks generated.", count);
+    }
+
+    Chunk::ChunkPos World::to_chunk_pos(godot::Vector3 p_position) const
+    {
+        const Vector3 local = is_inside_tree() ? get_global_transform().xform_inv(p_position) : p_position;
+
+        return Chunk::ChunkPos(static_cast<int32_t>(std::floor(local.x / CHUNK_AXIS_LENGTH_F)),
+                               static_cast<int32_t>(std::floor(local.z / CHUNK_AXIS_LENGTH_F)));
+    }
+
+    int64_t World::add_ticket(godot::Vector3 p_position, int32_t p_radius, int32_t p_priority)
+    {
+        return add_ticket_at(to_chunk_pos(p_position), p_radius, p_priority);
+    }
+
+    int64_t World::add_ticket_at(Chunk::ChunkPos p_center, int32_t p_radius, int32_t p_priority)
+    {
+        Ticket ticket{};
+        ticket.center = p_center;
+        ticket.radius = godot::CLAMP(p_radius, 0, static_cast<int32_t>(SIMULATION_DISTANCE_MAX));
+        ticket.priority = p_priority;
+
+        const int64_t id = m_nextTicketId++;
+        m_tickets.emplace(id, ticket);
+        acquire_ticket_area(ticket);
+
+        VOXEL_LOG_DEBUG("Added chunk ticket {} at {} with radius {} and priority {}.",
+                        id, ticket.center, ticket.radius, ticket.priority);
+
+        return id;
+    }
+
+    void World::move_ticket(int64_t p_id, godot::Vector3 p_position)
+    {
+        auto iterator = m_tickets.find(p_id);
+        if (iterator == m_tickets.end())
+        {
+            VOXEL_LOG_WARN("Attempted to move chunk ticket {} but it doesn't exist.", p_id);
+            return;
+        }
+
+        const Chunk::ChunkPos center = to_chunk_pos(p_position);
+        if (center == iterator->second.center)
+            return;
+
+        // Acquire before releasing so chunks shared by the old and new area never drop to zero references.
+        const Ticket previous = iterator->second;
+        iterator->second.center = center;
+        acquire_ticket_area(iterator->second);
+        release_ticket_area(previous);
+    }
+
+    void World::remove_ticket(int64_t p_id)
+    {
+        auto iterator = m_tickets.find(p_id);
+        if (iterator == m_tickets.end())
+        {
+            VOXEL_LOG_WARN("Attempted to remove chunk ticket {} but it doesn't exist.", p_id);
+            return;
+        }
+
+        const Ticket ticket = iterator->second;
+        m_tickets.erase(iterator);
+        release_ticket_area(ticket);
+
+        if (p_id == m_spawnTicket)
+            m_spawnTicket = 0;
+
+        VOXEL_LOG_DEBUG("Removed chunk ticket {}.", p_id);
+    }
+
+    void World::ensure_spawn_ticket()
+    {
+        if (m_spawnTicket != 0)
+        {
+            auto iterator = m_tickets.find(m_spawnTicket);
+            if (iterator != m_tickets.end() && iterator->second.radius == m_spawnRadius)
+                return;
+
+            remove_ticket(m_spawnTicket);
+        }
+
+        // Spawn outranks every loader so it is always finished first.
+        m_spawnTicket = add_ticket_at(Chunk::ChunkPos(0, 0), m_spawnRadius, std::numeric_limits<int32_t>::max());
+    }
+
+    void World::acquire_ticket_area(const Ticket &p_ticket)
+    {
+        for (int x = p_ticket.center.x - p_ticket.radius; x <= p_ticket.center.x + p_ticket.radius; x++)
+        {
+            for (int z = p_ticket.center.y - p_ticket.radius; z <= p_ticket.center.y + p_ticket.radius; z++)
+            {
+                const Chunk::ChunkPos pos(x, z);
+                const uint64_t key = Tools::Hash::chunk_pos(pos);
+
+                if (m_ticketRefs[key]++ == 0 && !m_chunks.contains(pos))
+                    m_pendingLoads.emplace(key);
+            }
+        }
+    }
+
+    void World::release_ticket_area(const Ticket &p_ticket)
+    {
+        for (int x = p_ticket.center.x - p_ticket.radius; x <= p_ticket.center.x + p_ticket.radius; x++)
+        {
+            for (int z = p_ticket.center.y - p_ticket.radius; z <= p_ticket.center.y + p_ticket.radius; z++)
+            {
+                const Chunk::ChunkPos pos(x, z);
+                const uint64_t key = Tools::Hash::chunk_pos(pos);
+
+                auto iterator = m_ticketRefs.find(key);
+                if (iterator == m_ticketRefs.end() || --iterator->second > 0)
+                    continue;
+
+                m_ticketRefs.erase(iterator);
+                m_pendingLoads.erase(key);
+
+                if (m_chunks.contains(pos))
+                    m_pendingUnloads.emplace_back(key);
+            }
+        }
+    }
+
+    void World::queue_ticketed_chunks()
+    {
+        for (const auto &kvp : m_ticketRefs)
+        {
+            if (!m_chunks.contains(Tools::Hash::chunk_pos_from(kvp.first)))
+                m_pendingLoads.emplace(kvp.first);
+        }
+    }
+
+    bool World::unload_next_pending_chunk()
+    {
+        while (!m_pendingUnloads.empty())
+        {
+            const uint64_t key = m_pendingUnloads.front();
+            m_pendingUnloads.pop_front();
+
+            // A ticket may have covered the chunk again before its unload came up.
+            if (m_ticketRefs.find(key) != m_ticketRefs.end())
+                continue;
 
-        Tools::Log::debug() << "Spawn complete. " << count << " chunks generated.";
+            Chunk *pChunk = m_chunks.find(Tools::Hash::chunk_pos_from(key));
+            if (!pChunk)
+                continue;
+
+            // Border faces toward this chunk become visible once it is gone.
+            pChunk->remesh_neighbors();
+            unload_chunk(pChunk);
+            return true;
+        }
+
+        return false;
+    }
+
+    void World::order_pending_loads(size_t p_max, std::vector<uint64_t> &r_keys) const
+    {
+        r_keys.clear();
+
+        if (m_pendingLoads.empty() || p_max == 0)
+            return;
+
+        struct LoadCandidate
+        {
+            uint64_t key;
+            int32_t priority;
+            int64_t distanceSq;
+        };
+
+        std::vector<LoadCandidate> candidates;
+        candidates.reserve(m_pendingLoads.size());
+
+        for (uint64_t key : m_pendingLoads)
+        {
+            const Chunk::ChunkPos pos = Tools::Hash::chunk_pos_from(key);
+
+            // Rank each chunk by the most important ticket covering it, then by closeness to that ticket.
+            LoadCandidate candidate{ key, std::numeric_limits<int32_t>::min(), std::numeric_limits<int64_t>::max() };
+            for (const auto &kvp : m_tickets)
+            {
+                const Ticket &ticket = kvp.second;
+                const int64_t dx = pos.x - ticket.center.x;
+                const int64_t dz = pos.y - ticket.center.y;
+
+                if (std::abs(dx) > ticket.radius || std::abs(dz) > ticket.radius)
+                    continue;
+
+                const int64_t distanceSq = dx * dx + dz * dz;
+                if (ticket.priority > candidate.priority ||
+                    (ticket.priority == candidate.priority && distanceSq < candidate.distanceSq))
+                {
+                    candidate.priority = ticket.priority;
+                    candidate.distanceSq = distanceSq;
+                }
+            }
+
+            candidates.emplace_back(candidate);
+        }
+
+        const auto more_important = [](const LoadCandidate &a, const LoadCandidate &b)
+        {
+            if (a.priority != b.priority)
+                return a.priority > b.priority;
+            return a.distanceSq < b.distanceSq;
+        };
+
+        const size_t count = std::min(p_max, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), more_important);
+
+        r_keys.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            r_keys.emplace_back(candidates[i].key);
     }
 
     void World::unload_chunk(Chunk *p_chunk)
     {
+        VOXEL_TRACE_ZONE("World::unload_chunk");
+
         if (p_chunk)
         {
             p_chunk->unload();
-            remove_child(p_chunk);
-            m_chunks.erase(Tools::Hash::chunk(p_chunk));
+            m_tickScheduler.on_chunk_unload(p_chunk);
+            m_lightEngine.on_chunk_unload(p_chunk);
+            m_fluids.on_chunk_unload(p_chunk);
+
+            if (p_chunk->has_collision())
+                m_collidingChunks.erase(std::find(m_collidingChunks.begin(), m_collidingChunks.end(), p_chunk));
+
+            if (p_chunk->get_dirty_section_mask() != 0)
+                m_dirtyChunks.erase(std::find(m_dirtyChunks.begin(), m_dirtyChunks.end(), p_chunk));
+            m_chunks.erase(p_chunk);
             memdelete(p_chunk);
         }
     }
 
+    PackedByteArray World::encode_chunk_packet(Vector2i p_chunkPos) const
+    {
+        const Chunk *pChunk = m_chunks.find(p_chunkPos);
+        return pChunk ? ChunkWire::encode_chunk(pChunk) : PackedByteArray();
+    }
+
+    bool World::apply_chunk_packet(const PackedByteArray &p_packet)
+    {
+        Chunk::ChunkPos pos;
+        if (!ChunkWire::read_chunk_pos(p_packet, pos))
+        {
+            Tools::Log::error("Not a chunk packet.");
+            return false;
+        }
+
+        // Replicated chunks replace whatever was generated or streamed for that position.
+        m_pendingLoads.erase(Tools::Hash::chunk_pos(pos));
+
+        Chunk *pChunk = m_chunks.find(pos);
+        const bool isNew = pChunk == nullptr;
+        if (isNew)
+            pChunk = create_chunk(pos.x, pos.y);
+
+        if (!ChunkWire::decode_chunk(p_packet, pChunk))
+        {
+            // A half decoded chunk would be garbage, but an existing one may have been partly overwritten already. It
+            // goes back to its save rather than fresh terrain, which a full save would write over the saved chunk.
+            if (isNew)
+                unload_chunk(pChunk);
+            else
+                reload_blocks(pChunk);
+            return false;
+        }
+
+        pChunk->finish_load();
+        return true;
+    }
+
+    PackedByteArray World::take_block_deltas()
+    {
+        if (m_deltaBatch.is_empty())
+            return PackedByteArray();
+
+        return m_deltaBatch.take(m_chunks);
+    }
+
+    int32_t World::apply_block_deltas(const PackedByteArray &p_packet)
+    {
+        std::vector<ChunkWire::SectionDelta> deltas;
+        if (!ChunkWire::decode_deltas(p_packet, deltas))
+        {
+            Tools::Log::error("Block delta packet is corrupt.");
+            return 0;
+        }
+
+        int32_t count = 0;
+        begin_edit();
+
+        for (const ChunkWire::SectionDelta &delta : deltas)
+        {
+            // Deltas for chunks this peer doesn't have are meaningless, it gets the whole chunk when it streams in.
+            Chunk *pChunk = m_chunks.find(Chunk::ChunkPos(delta.chunkX, delta.chunkZ));
+            if (!pChunk)
+                continue;
+
+            const uint32_t baseY = delta.section * SECTION_AXIS_LENGTH_U;
+            uint32_t x, y, z;
+
+            if (delta.mode == Core::WireCodec::DELTA_SNAPSHOT)
+            {
+                // Snapshots are decoded in storage order, applied one x row at a time.
+                Block row[SECTION_AXIS_LENGTH_U];
+                for (y = 0; y < SECTION_AXIS_LENGTH_U; y++)
+                {
+                    for (z = 0; z < SECTION_AXIS_LENGTH_U; z++)
+                    {
+                        for (x = 0; x < SECTION_AXIS_LENGTH_U; x++)
+                            row[x] = delta.blocks[Core::get_section_local_index(x, y, z)];
+
+                        pChunk->write_span(0, SECTION_AXIS_LENGTH_U - 1, baseY + y, z, row);
+                        mark_span_dirty(pChunk, 0, SECTION_AXIS_LENGTH_U - 1, baseY + y, z);
+                    }
+                }
+
+                count += static_cast<int32_t>(SECTION_BLOCK_COUNT);
+                continue;
+            }
+
+            // Fluid is written as sent, the sender's simulation already moved it.
+            if (delta.mode == Core::WireCodec::DELTA_FLUID)
+            {
+                for (size_t i = 0; i < delta.indices.size(); i++)
+                {
+                    Core::WireCodec::get_section_position(delta.indices[i], x, y, z);
+                    pChunk->set_fluid(pChunk->get_block_index_local(x, baseY + y, z), delta.fluids[i]);
+                    mark_fluid_dirty(pChunk, x, baseY + y, z);
+                }
+
+                count += static_cast<int32_t>(delta.indices.size());
+                continue;
+            }
+
+            for (size_t i = 0; i < delta.indices.size(); i++)
+            {
+                Core::WireCodec::get_section_position(delta.indices[i], x, y, z);
+                pChunk->write_span(x, x, baseY + y, z, &delta.blocks[i]);
+                mark_block_dirty(pChunk, x, baseY + y, z);
+            }
+
+            count += static_cast<int32_t>(delta.indices.size());
+        }
+
+        commit_edit();
+        return count;
+    }
+
+    bool World::apply_packet(const PackedByteArray &p_packet)
+    {
+        switch (ChunkWire::get_packet_type(p_packet))
+        {
+        case ChunkWire::PACKET_CHUNK:
+            return apply_chunk_packet(p_packet);
+        case ChunkWire::PACKET_DELTA:
+            return apply_block_deltas(p_packet) > 0;
+        case ChunkWire::PACKET_UNLOAD:
+        {
+            std::vector<Chunk::ChunkPos> chunks;
+            if (!ChunkWire::decode_unload(p_packet, chunks))
+                return false;
+
+            // Chunks a local ticket still covers stay, the others unload as if their last ticket had gone.
+            for (Chunk::ChunkPos pos : chunks)
+            {
+                const uint64_t key = Tools::Hash::chunk_pos(pos);
+                if (m_chunks.contains(pos) && m_ticketRefs.find(key) == m_ticketRefs.end())
+                    m_pendingUnloads.emplace_back(key);
+            }
+            return true;
+        }
+        default:
+            VOXEL_LOG_ERROR("Unknown packet type {}.", static_cast<int>(ChunkWire::get_packet_type(p_packet)));
+            return false;
+        }
+    }
+
+    void World::add_peer(int32_t p_peerId, Vector3 p_position, int32_t p_radius)
+    {
+        if (m_peers.has_peer(p_peerId))
+            remove_peer(p_peerId);
+
+        // The ticket keeps the peer's area loaded on the server, the tracker decides what of it the peer is sent.
+        const int64_t ticket = add_ticket(p_position, p_radius, 0);
+        m_peers.add_peer(p_peerId, to_chunk_pos(p_position), m_tickets[ticket].radius, ticket);
+    }
+
+    void World::update_peer(int32_t p_peerId, Vector3 p_position, Vector3 p_viewDirection)
+    {
+        const int64_t ticket = m_peers.get_ticket(p_peerId);
+        if (ticket == 0)
+        {
+            VOXEL_LOG_WARN("Attempted to update peer {} but it isn't tracked.", p_peerId);
+            return;
+        }
+
+        move_ticket(ticket, p_position);
+
+        const Vector3 direction = is_inside_tree() ? get_global_transform().basis.xform_inv(p_viewDirection) : p_viewDirection;
+        m_peers.set_peer_view(p_peerId, to_chunk_pos(p_position), Vector2(direction.x, direction.z));
+    }
+
+    void World::remove_peer(int32_t p_peerId)
+    {
+        const int64_t ticket = m_peers.remove_peer(p_peerId);
+        if (ticket != 0)
+            remove_ticket(ticket);
+    }
+
+    Array World::take_peer_packets(int32_t p_peerId)
+    {
+        Array packets;
+        for (PackedByteArray &packet : m_peers.take_packets(p_peerId))
+            packets.push_back(packet);
+
+        return packets;
+    }
+
+    void World::set_save_path(const String &p_path)
+    {
+        m_savePath = p_path;
+
+        if (is_inside_tree())
+            open_save_directory();
+    }
+
+    void World::open_save_directory()
+    {
+        // Restarting the worker writes out what the old directory still had queued and drops unfinished loads.
+        m_loadRequests.clear();
+
+        if (m_savePath.is_empty())
+        {
+            m_io.start(std::string());
+            return;
+        }
+
+        const String directory = ProjectSettings::get_singleton()->globalize_path(m_savePath);
+        m_io.start(directory.utf8().get_data());
+    }
+
+    void World::request_pending_loads()
+    {
+        std::vector<uint64_t> loads;
+        order_pending_loads(MAX_LOADS_PER_FRAME, loads);
+
+        for (uint64_t key : loads)
+        {
+            if (m_loadRequests.count(key) != 0)
+                continue;
+
+            // The queue is bounded. Whatever doesn't fit is ranked again next frame.
+            if (!m_io.request_load(Tools::Hash::chunk_pos_from(key)))
+                break;
+
+            m_loadRequests.insert(key);
+        }
+    }
+
+    void World::queue_modified_saves()
+    {
+        // The previous interval's chunks are still being handed off.
+        if (!m_io.is_running() || !m_saveQueue.empty())
+            return;
+
+        m_chunks.for_each([this](Chunk *p_chunk)
+                          {
+                              if (p_chunk->is_modified())
+                                  m_saveQueue.emplace_back(Tools::Hash::chunk_pos(p_chunk->get_pos()));
+                          });
+    }
+
+    int32_t World::save_world()
+    {
+        int32_t count = 0;
+        m_chunks.for_each([this, &count](Chunk *p_chunk)
+                          {
+                              if (p_chunk->save(m_io))
+                                  count++;
+                          });
+
+        VOXEL_LOG_DEBUG("Handed {} modified chunk(s) to the I/O worker.", count);
+        return count;
+    }
+
     void World::unload_world()
     {
+        std::vector<Chunk *> chunks;
+        chunks.reserve(m_chunks.size());
+        m_chunks.for_each([&chunks](Chunk *p_chunk)
+                          { chunks.emplace_back(p_chunk); });
+
         int count = 0;
-        while (!m_chunks.empty())
+        for (Chunk *pChunk : chunks)
         {
-            auto kvp = m_chunks.begin();
-            unload_chunk(kvp->second);
+            unload_chunk(pChunk);
             count++;
         }
 
-        Tools::Log::debug() << "Unloaded " << count << " chunk(s) during world " << this << " unload.";
+        VOXEL_LOG_DEBUG("Unloaded {} chunk(s) during world {} unload.", count, this);
     }
 } //namespace Voxel
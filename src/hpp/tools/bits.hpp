@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Tools
+{
+    class Bits
+    {
+    public:
+        // Index of the lowest set bit. p_value must not be zero.
+        static inline uint32_t count_trailing_zeros(uint32_t p_value)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, p_value);
+            return static_cast<uint32_t>(index);
+#else
+            return static_cast<uint32_t>(__builtin_ctz(p_value));
+#endif
+        }
+
+        static inline uint32_t count_set_bits(uint32_t p_value)
+        {
+#if defined(_MSC_VER)
+            return static_cast<uint32_t>(__popcnt(p_value));
+#else
+            return static_cast<uint32_t>(__builtin_popcount(p_value));
+#endif
+        }
+    };
+} //namespace Tools
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "godot_cpp/variant/vector2i.hpp"
+#include "godot_cpp/variant/vector3.hpp"
+#include "godot_cpp/variant/vector3i.hpp"
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// fmt-style formatting without streams: each {} in the format string is replaced by the next argument, {{ and }} are
+// literal braces. Supports integers, floating point, bools, strings, pointers and the Godot vector types.
+namespace Tools::Format
+{
+    template <class T>
+    inline std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>> append(std::string &r_out, T p_value)
+    {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), p_value);
+        r_out.append(buffer, result.ptr);
+    }
+
+    template <class T>
+    inline std::enable_if_t<std::is_floating_point_v<T>> append(std::string &r_out, T p_value)
+    {
+        char buffer[32];
+        const int length = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(p_value));
+        if (length > 0)
+            r_out.append(buffer, static_cast<size_t>(length) < sizeof(buffer) ? static_cast<size_t>(length) : sizeof(buffer) - 1);
+    }
+
+    template <class T>
+    inline std::enable_if_t<std::is_enum_v<T>> append(std::string &r_out, T p_value)
+    {
+        append(r_out, static_cast<std::underlying_type_t<T>>(p_value));
+    }
+
+    inline void append(std::string &r_out, bool p_value) { r_out.append(p_value ? "true" : "false"); }
+    inline void append(std::string &r_out, char p_value) { r_out.push_back(p_value); }
+    inline void append(std::string &r_out, const char *p_value) { r_out.append(p_value ? p_value : "(null)"); }
+    inline void append(std::string &r_out, std::string_view p_value) { r_out.append(p_value); }
+    inline void append(std::string &r_out, const std::string &p_value) { r_out.append(p_value); }
+
+    inline void append(std::string &r_out, const void *p_value)
+    {
+        char buffer[24];
+        const int length = std::snprintf(buffer, sizeof(buffer), "%p", p_value);
+        if (length > 0)
+            r_out.append(buffer, static_cast<size_t>(length) < sizeof(buffer) ? static_cast<size_t>(length) : sizeof(buffer) - 1);
+    }
+
+    inline void append(std::string &r_out, const godot::Vector2i &p_value)
+    {
+        r_out.push_back('(');
+        append(r_out, p_value.x);
+        r_out.append(", ");
+        append(r_out, p_value.y);
+        r_out.push_back(')');
+    }
+
+    inline void append(std::string &r_out, const godot::Vector3i &p_value)
+    {
+        r_out.push_back('(');
+        append(r_out, p_value.x);
+        r_out.append(", ");
+        append(r_out, p_value.y);
+        r_out.append(", ");
+        append(r_out, p_value.z);
+        r_out.push_back(')');
+    }
+
+    inline void append(std::string &r_out, const godot::Vector3 &p_value)
+    {
+        r_out.push_back('(');
+        append(r_out, p_value.x);
+        r_out.append(", ");
+        append(r_out, p_value.y);
+        r_out.append(", ");
+        append(r_out, p_value.z);
+        r_out.push_back(')');
+    }
+
+    // Copies literal text up to the next {} and returns the position after it, or npos when there is none.
+    inline size_t append_literal(std::string &r_out, std::string_view p_format)
+    {
+        size_t i = 0;
+        while (i < p_format.size())
+        {
+            const char c = p_format[i];
+            const bool hasNext = i + 1 < p_format.size();
+
+            if (c == '{' && hasNext && p_format[i + 1] == '}')
+                return i + 2;
+
+            // Escaped braces.
+            if ((c == '{' || c == '}') && hasNext && p_format[i + 1] == c)
+                i++;
+
+            r_out.push_back(c);
+            i++;
+        }
+
+        return std::string_view::npos;
+    }
+
+    // Placeholders without an argument are kept as written.
+    inline void format_to(std::string &r_out, std::string_view p_format)
+    {
+        size_t next = append_literal(r_out, p_format);
+        while (next != std::string_view::npos)
+        {
+            r_out.append("{}");
+            p_format = p_format.substr(next);
+            next = append_literal(r_out, p_format);
+        }
+    }
+
+    template <class T, class... Args>
+    inline void format_to(std::string &r_out, std::string_view p_format, const T &p_first, const Args &...p_rest)
+    {
+        const size_t next = append_literal(r_out, p_format);
+        if (next == std::string_view::npos)
+            return;
+
+        if constexpr (std::is_pointer_v<T> && !std::is_same_v<std::decay_t<std::remove_pointer_t<T>>, char>)
+            append(r_out, static_cast<const void *>(p_first));
+        else
+            append(r_out, p_first);
+
+        format_to(r_out, p_format.substr(next), p_rest...);
+    }
+
+    template <class... Args>
+    inline std::string format(std::string_view p_format, const Args &...p_args)
+    {
+        std::string out;
+        out.reserve(p_format.size() + 16 * sizeof...(Args));
+        format_to(out, p_format, p_args...);
+        return out;
+    }
+} //namespace Tools::Format
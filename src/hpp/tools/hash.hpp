@@ -21,5 +21,11 @@ namespace Tools
             return (static_cast<uint64_t>(pos.x & 0xFFFFFFFFu) << 32) |
                    (static_cast<uint64_t>(pos.y) & 0xFFFFFFFFu);
         }
+
+        static const godot::Vector2i chunk_pos_from(uint64_t key)
+        {
+            return godot::Vector2i(static_cast<int32_t>(static_cast<uint32_t>(key >> 32)),
+                                   static_cast<int32_t>(static_cast<uint32_t>(key & 0xFFFFFFFFu)));
+        }
     };
 } //namespace Tools
@@ -1,7 +1,20 @@
 ﻿#pragma once
 
+#include "hpp/tools/format.hpp"
+#include <atomic>
+#include <string>
 #include <string_view>
 
+// Most verbose level compiled in, set by the build's log_level option. Calls above it compile to nothing.
+#ifndef VOXEL_LOG_LEVEL
+#define VOXEL_LOG_LEVEL 3
+#endif
+
+// Overflow policy the log starts with, set by the build's log_overflow option.
+#ifndef VOXEL_LOG_OVERFLOW
+#define VOXEL_LOG_OVERFLOW 0
+#endif
+
 namespace Tools::Log
 {
     enum class Level : unsigned char
@@ -12,12 +25,65 @@ namespace Tools::Log
         Debug = 3
     };
 
+    // What a full queue does to Info and Debug lines. Errors and warnings always wait for room.
+    enum class Overflow : unsigned char
+    {
+        Drop = 0,
+        Block = 1
+    };
+
+    // Most verbose level written at runtime, set by begin.
+    inline std::atomic<Level> s_level{ Level::Debug };
+
+    constexpr bool is_compiled(Level lvl) { return static_cast<int>(lvl) <= VOXEL_LOG_LEVEL; }
+
+    inline bool is_enabled(Level lvl)
+    {
+        return is_compiled(lvl) && lvl <= s_level.load(std::memory_order_relaxed);
+    }
+
+    inline void set_level(Level lvl) { s_level.store(lvl, std::memory_order_relaxed); }
+
+    void write_line(Level lvl, std::string &&line);
+
+    // Formats with {} placeholders, see Tools::Format. Callers go through the VOXEL_LOG_* macros so the arguments
+    // aren't evaluated when the level is off.
+    template <class... Args>
+    void write(Level lvl, std::string_view format, const Args &...args)
+    {
+        write_line(lvl, Format::format(format, args...));
+    }
+
     void info(std::string_view msg);
     void warn(std::string_view msg);
     void error(std::string_view msg);
     void debug(std::string_view msg);
 
+    // Lines are queued and written to the console and file by a background thread once begin has run, so any thread
+    // may log. Before begin and after end they are printed on the calling thread.
     void begin(const char *pAPP_NAME, std::string_view utf8, bool use_timestamp, Level logging_level);
 
+    // Safe from any thread, defaults to the build's log_overflow option.
+    void set_overflow(Overflow overflow);
+    // Blocks until every line queued so far is written.
+    void flush();
+    // Writes what is still queued and stops the writer thread. Lines logged meanwhile or afterwards are written on the
+    // calling thread, so threads still running (ChunkIO, fluid workers) lose nothing, but they should be joined first:
+    // Worlds join theirs when freed, before the extension's terminator calls this.
     void end();
 } //namespace Tools::Log
+
+#define VOXEL_LOG(level, ...)                                  \
+    do                                                         \
+    {                                                          \
+        if constexpr (::Tools::Log::is_compiled(level))        \
+        {                                                      \
+            if (::Tools::Log::is_enabled(level))               \
+                ::Tools::Log::write(level, __VA_ARGS__);       \
+        }                                                      \
+    } while (false)
+
+#define VOXEL_LOG_INFO(...) VOXEL_LOG(::Tools::Log::Level::Info, __VA_ARGS__)
+#define VOXEL_LOG_ERROR(...) VOXEL_LOG(::Tools::Log::Level::Error, __VA_ARGS__)
+#define VOXEL_LOG_WARN(...) VOXEL_LOG(::Tools::Log::Level::Warn, __VA_ARGS__)
+#define VOXEL_LOG_DEBUG(...) VOXEL_LOG(::Tools::Log::Level::Debug, __VA_ARGS__)
@@ -11,9 +11,11 @@ namespace Tools::Log
     {
         Level level;
         std::ostringstream oss;
-        bool active = true;
+        // Lines of a disabled level skip formatting. Prefer the VOXEL_LOG_* macros on hot paths, they also skip
+        // evaluating the arguments.
+        bool active;
 
-        explicit Line(Level lvl) : level(lvl) {}
+        explicit Line(Level lvl) : level(lvl), active(is_enabled(lvl)) {}
 
         Line(const Line &) = delete;
         Line &operator=(const Line &) = delete;
@@ -28,13 +30,15 @@ namespace Tools::Log
         template <class T>
         Line &operator<<(const T &v)
         {
-            oss << v;
+            if (active)
+                oss << v;
             return *this;
         }
 
         Line &operator<<(std::ostream &(*manip)(std::ostream &))
         {
-            oss << manip;
+            if (active)
+                oss << manip;
             return *this;
         }
     };
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Tools
+{
+    // Read-write file whose contents are exposed through a read-only memory mapping. Writes go through the file
+    // handle and are visible in the mapping. The file grows geometrically so appends rarely remap, callers track
+    // how much of it is actually used and truncate on close.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        bool open(const std::string &p_path);
+        void close();
+        bool is_open() const;
+
+        size_t size() const { return m_size; }
+        const uint8_t *data() const { return m_pData; }
+
+        bool write(size_t p_offset, const void *p_data, size_t p_length);
+        bool resize(size_t p_size);
+
+    private:
+        bool map();
+        void unmap();
+
+#if defined(_WIN32)
+        void *m_file = nullptr;
+        void *m_mapping = nullptr;
+#else
+        int m_fd = -1;
+#endif
+        const uint8_t *m_pData = nullptr;
+        size_t m_size = 0;
+    };
+} //namespace Tools
@@ -13,21 +13,21 @@ namespace Tools
     class String
     {
     public:
-        static const std::string to_string(godot::Vector3 &p_vector3)
+        static const std::string to_string(const godot::Vector3 &p_vector3)
         {
             std::stringstream ss;
             ss << "(" << p_vector3.x << ", " << p_vector3.y << ", " << p_vector3.z << ")";
             return ss.str();
         }
 
-        static const std::string to_string(godot::Vector3i &p_vector3)
+        static const std::string to_string(const godot::Vector3i &p_vector3)
         {
             std::stringstream ss;
             ss << "(" << p_vector3.x << ", " << p_vector3.y << ", " << p_vector3.z << ")";
             return ss.str();
         }
 
-        static const std::string to_string(godot::Vector2i &p_vector2)
+        static const std::string to_string(const godot::Vector2i &p_vector2)
         {
             std::stringstream ss;
             ss << "(" << p_vector2.x << ", " << p_vector2.y << ")";
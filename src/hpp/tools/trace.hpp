@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Tools::Trace
+{
+    inline std::atomic<bool> s_enabled{ false };
+
+    inline bool is_enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // Turning tracing off also clears the frame totals, events recorded so far are kept for export.
+    void set_enabled(bool enabled);
+
+    // Nanoseconds on a monotonic clock.
+    uint64_t now_ns();
+
+    // Zones keep only the name pointer, so names must be string literals or otherwise outlive the trace.
+    void record(const char *pNAME, uint64_t start_ns, uint64_t end_ns);
+    // Shown for the calling thread's track in the exported trace.
+    void set_thread_name(const char *pNAME);
+
+    // Times its scope while tracing is enabled. Events go to a buffer owned by the recording thread, so zones on
+    // different threads never contend.
+    class Zone
+    {
+    public:
+        explicit Zone(const char *pNAME) : m_pNAME(pNAME), m_active(is_enabled()), m_startNs(m_active ? now_ns() : 0) {}
+
+        ~Zone()
+        {
+            if (m_active)
+                record(m_pNAME, m_startNs, now_ns());
+        }
+
+        Zone(const Zone &) = delete;
+        Zone &operator=(const Zone &) = delete;
+
+    private:
+        const char *m_pNAME;
+        bool m_active;
+        uint64_t m_startNs;
+    };
+
+    // Sums the zones ended since the last call into per name frame totals. Called once per frame.
+    void end_frame();
+    double get_frame_msec(std::string_view name);
+    uint32_t get_frame_count(std::string_view name);
+
+    size_t get_event_count();
+    void clear();
+    // Writes every recorded event as Chrome trace event JSON, which chrome://tracing and Perfetto open.
+    bool write_chrome_json(const std::string &utf8_path);
+} //namespace Tools::Trace
+
+#define VOXEL_TRACE_CONCAT_INNER(a, b) a##b
+#define VOXEL_TRACE_CONCAT(a, b) VOXEL_TRACE_CONCAT_INNER(a, b)
+#define VOXEL_TRACE_ZONE(name) ::Tools::Trace::Zone VOXEL_TRACE_CONCAT(traceZone, __LINE__)(name)
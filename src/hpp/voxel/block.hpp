@@ -1,28 +1,59 @@
 #pragma once
 
-#include "resource/pallet.hpp"
+#include "hpp/voxel/core/block_types.hpp"
+#include <cstdint>
 
 namespace Voxel
 {
+    // Plain value type shared by the core library and the GDExtension side.
     class Block
     {
     public:
+        // Compact block identifier used by the scripting and serialization APIs. 0 is air, every solid
+        // (material, texture) pair maps to 1 + material * TEXTURE_COUNT + texture.
+        static constexpr int32_t ID_NONE = -1; // Returned for unloaded or out of range positions
+        static constexpr int32_t ID_AIR = 0;
+        static constexpr int32_t ID_COUNT = 1 + Core::BlockTypes::TYPE_COUNT * Core::BlockTypes::TEXTURE_COUNT;
+
         Block() = default;
         ~Block() = default;
 
+        static int32_t make_id(Core::BlockTypes::MaterialType p_material, Core::BlockTypes::BlockTexture p_texture)
+        {
+            return 1 + static_cast<int32_t>(p_material) * Core::BlockTypes::TEXTURE_COUNT + static_cast<int32_t>(p_texture);
+        }
+
+        static Block from_id(int32_t p_id)
+        {
+            Block block;
+            if (p_id <= ID_AIR || p_id >= ID_COUNT)
+                return block;
+
+            block.m_isSolid = true;
+            block.m_materialType = static_cast<Core::BlockTypes::MaterialType>((p_id - 1) / Core::BlockTypes::TEXTURE_COUNT);
+            block.m_texture = static_cast<Core::BlockTypes::BlockTexture>((p_id - 1) % Core::BlockTypes::TEXTURE_COUNT);
+            return block;
+        }
+
+        int32_t to_id() const { return m_isSolid ? make_id(m_materialType, m_texture) : ID_AIR; }
+
+        // Air compares equal regardless of leftover material or texture.
+        bool operator==(const Block &p_other) const { return to_id() == p_other.to_id(); }
+        bool operator!=(const Block &p_other) const { return !(*this == p_other); }
+
         void set_solid(bool p_isSolid) { m_isSolid = p_isSolid; }
         bool is_solid() const { return m_isSolid; }
-        bool opaque() const { return m_isSolid && m_materialType != Resource::Pallet::MaterialType::TYPE_GLASS; }
+        bool opaque() const { return m_isSolid && m_materialType != Core::BlockTypes::TYPE_GLASS; }
 
-        void set_material_type(Resource::Pallet::MaterialType p_material) { m_materialType = p_material; }
-        Resource::Pallet::MaterialType get_material_type() const { return m_materialType; }
+        void set_material_type(Core::BlockTypes::MaterialType p_material) { m_materialType = p_material; }
+        Core::BlockTypes::MaterialType get_material_type() const { return m_materialType; }
 
-        void set_texture(Resource::Pallet::BlockTexture p_texture) { m_texture = p_texture; }
-        Resource::Pallet::BlockTexture get_texture() const { return m_texture; }
+        void set_texture(Core::BlockTypes::BlockTexture p_texture) { m_texture = p_texture; }
+        Core::BlockTypes::BlockTexture get_texture() const { return m_texture; }
 
     private:
         bool m_isSolid = false;
-        Resource::Pallet::BlockTexture m_texture = Resource::Pallet::TEXTURE_MISSING;
-        Resource::Pallet::MaterialType m_materialType = Resource::Pallet::MaterialType::TYPE_GENERIC;
+        Core::BlockTypes::BlockTexture m_texture = Core::BlockTypes::TEXTURE_MISSING;
+        Core::BlockTypes::MaterialType m_materialType = Core::BlockTypes::TYPE_GENERIC;
     };
 } //namespace Voxel
@@ -1,83 +1,196 @@
 #pragma once
 
 #include "block.hpp"
+#include "chunk_collider.hpp"
+#include "chunk_section.hpp"
 #include "constants.hpp"
+#include "core/block_layout.hpp"
+#include "core/chunk_view.hpp"
+#include "core/fluid.hpp"
+#include "core/mesh_builder.hpp"
+#include "core/terrain_generator.hpp"
 #include "godot_cpp/variant/vector2i.hpp"
 #include "godot_cpp/variant/vector3.hpp"
 #include "godot_cpp/variant/vector3i.hpp"
 #include "resource/pallet.hpp"
+#include <cstddef>
 #include <cstdint>
 #include <godot_cpp/classes/array_mesh.hpp>
 #include <godot_cpp/classes/material.hpp>
-#include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/variant/rid.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <memory>
+#include <vector>
 
 namespace Voxel
 {
+    class ChunkIO;
     class World;
 
-    class Chunk : public godot::Node3D
+    // Plain object owned by World. Chunks have no scene tree node; they draw through a RenderingServer instance
+    // placed relative to the World transform.
+    class Chunk
     {
-        GDCLASS(Chunk, Node3D)
     public:
+        // Direct links to the adjacent loaded chunks, kept current by the world's ChunkGrid on load and unload.
         struct Neighbors
         {
-            Chunk *pos_x;
-            Chunk *neg_x;
-            Chunk *pos_z;
-            Chunk *neg_z;
+            Chunk *pos_x = nullptr;
+            Chunk *neg_x = nullptr;
+            Chunk *pos_z = nullptr;
+            Chunk *neg_z = nullptr;
         };
 
         typedef godot::Vector2i ChunkPos;
 
         Chunk() = default;
-        ~Chunk() override = default;
+        ~Chunk();
 
-        void _ready() override;
-        void _exit_tree() override;
+        void initialize();
+        void sync_instance_transform(const godot::Transform3D &p_worldTransform);
 
         void set_pallet(godot::Ref<Resource::Pallet> p_pallet) { m_pallet = p_pallet; }
         void set_world_position(World *pWorld, int x, int y);
-        const Block *get_block_at(godot::Vector3 p_pos);
-        const Block *get_block_at(uint32_t x, uint32_t y, uint32_t z);
-        inline size_t get_block_index_local(uint32_t x, uint32_t y, uint32_t z) const
+        const Block *get_block_at(godot::Vector3 p_pos) const;
+        const Block *get_block_at(uint32_t x, uint32_t y, uint32_t z) const;
+        Block *get_block_mutable(uint32_t x, uint32_t y, uint32_t z) { return &m_pBlocks[get_block_index_local(x, y, z)]; }
+        const Block *get_block(size_t p_index) const { return &m_pBlocks[p_index]; }
+        Block *get_block_data() { return m_pBlocks.get(); }
+
+        // Packed light per block, see LightEngine.
+        uint8_t get_light(size_t p_index) const { return m_pLight[p_index]; }
+        void set_light(size_t p_index, uint8_t p_light) { m_pLight[p_index] = p_light; }
+        uint8_t *get_light_data() { return m_pLight.get(); }
+
+        // Fluid per block, see Core::Fluid and FluidSimulator. Allocated by the first fluid written, so most chunks
+        // never have any and get_fluid_data returns null for them. Saved and replicated with the blocks, and dropped
+        // when the blocks regenerate.
+        const uint8_t *get_fluid_data() const { return m_pFluid.get(); }
+        uint8_t get_fluid(size_t p_index) const { return m_pFluid ? m_pFluid[p_index] : Core::Fluid::NONE; }
+        void set_fluid(size_t p_index, uint8_t p_fluid);
+        // Empty storage for decoding a saved or replicated chunk's fluid into, allocated if needed.
+        uint8_t *allocate_fluid_data();
+        void clear_fluid() { m_pFluid.reset(); }
+
+        // Span writes along x at (y, z), both ends inclusive. They keep the tickable lists current but leave dirty
+        // marking to the caller, which knows the extent of the whole edit.
+        void fill_span(uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, const Block &p_block);
+        uint32_t replace_span(uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, const Block &p_from, const Block &p_to);
+        void write_span(uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, const Block *p_blocks);
+        inline size_t get_block_index_local(uint32_t x, uint32_t y, uint32_t z) const { return Core::get_block_index(x, y, z); }
+        const ChunkPos get_pos() const { return m_chunk_pos; }
+        godot::Vector3 get_origin() const { return godot::Vector3(m_origin); }
+
+        void generate_blocks();
+        // Replaces the blocks with a saved payload (see ChunkCodec), as an alternative to generating them.
+        bool load_blocks(const uint8_t *p_data, size_t p_size);
+        // Rebuilds what depends on the blocks after the storage was filled directly, as by ChunkWire::decode_chunk.
+        void finish_load();
+
+        // Set when the blocks differ from what was last saved.
+        bool is_modified() const { return m_isModified; }
+        void set_modified(bool p_modified) { m_isModified = p_modified; }
+        // Hands the encoded blocks to the I/O worker for write-behind if they changed since the last save.
+        bool save(ChunkIO &p_io);
+
+        ChunkSection &get_section(uint32_t p_section) { return m_sections[p_section]; }
+        uint32_t get_tickable_section_mask() const { return m_tickableSectionMask; }
+        void set_section_tickable(uint32_t p_section, bool p_tickable)
         {
-            return x +
-                   static_cast<size_t>(z) * CHUNK_AXIS_LENGTH_U +
-                   static_cast<size_t>(y) * (CHUNK_AXIS_LENGTH_U * CHUNK_AXIS_LENGTH_U);
+            if (p_tickable)
+                m_tickableSectionMask |= 1u << p_section;
+            else
+                m_tickableSectionMask &= ~(1u << p_section);
         }
-        const ChunkPos get_pos() { return m_chunk_pos; }
+        void update_tickable(uint32_t x, uint32_t y, uint32_t z);
+        void rebuild_tickable_sections();
 
-        void generate_blocks();
+        // Conservative: a set bit means the section may hold solid blocks, a clear bit means it is all air. Bits are
+        // only cleared when the chunk regenerates.
+        uint32_t get_solid_section_mask() const { return m_solidSectionMask; }
+        void mark_section_solid(uint32_t p_section) { m_solidSectionMask |= 1u << p_section; }
+
+        uint32_t get_dirty_section_mask() const { return m_dirtySectionMask; }
+        void mark_section_dirty(uint32_t p_section) { m_dirtySectionMask |= 1u << p_section; }
+        void clear_dirty_sections() { m_dirtySectionMask = 0; }
+
+        // Tick on which the chunk was last inside the simulation distance.
+        uint64_t get_simulation_stamp() const { return m_simulationStamp; }
+        void set_simulation_stamp(uint64_t p_tick) { m_simulationStamp = p_tick; }
+
+        // Stamp of the current block contents, unique across the World's chunks. Changes whenever the blocks do, except
+        // for edits replicated as deltas (see World::set_replicate_edits).
+        uint32_t get_content_version() const { return m_contentVersion; }
+        void set_content_version(uint32_t p_version) { m_contentVersion = p_version; }
+
+        // World::get_generation_hash when the blocks were last generated or loaded. Edits are saved against that
+        // baseline, so a chunk keeps its own until it is rebuilt for new settings.
+        uint64_t get_generation_hash() const { return m_generationHash; }
 
         World *get_world() const { return m_pWorld; }
         const godot::RID &get_rid() const { return m_instanceRID; }
 
-        Neighbors get_neighbors();
+        const Neighbors &get_neighbors() const { return m_neighbors; }
+        // This chunk's storage and its loaded neighbors' for the core meshing code.
+        Core::ChunkView get_view() const;
+        Neighbors &get_neighbor_links() { return m_neighbors; }
+
+        // Collision is opt-in per chunk. World enables it near tracked physics bodies and drops it once they leave.
+        void enable_collision();
+        void disable_collision();
+        bool has_collision() const { return m_pCollider != nullptr; }
+        ChunkCollider *get_collider() { return m_pCollider.get(); }
+        void mark_collision_dirty(uint32_t p_sectionMask)
+        {
+            if (m_pCollider)
+                m_pCollider->mark_sections_dirty(p_sectionMask);
+        }
 
         godot::Ref<godot::ArrayMesh> &get_mesh() { return m_mesh; }
+        // Faces of the last mesh built, to size the buffers for the next one.
+        Core::FaceCounts &get_mesh_face_counts() { return m_meshFaceCounts; }
+        // What each surface of the mesh draws, see ChunkMesher::get_surface_material.
+        std::vector<uint8_t> &get_mesh_surface_types() { return m_meshSurfaceTypes; }
         void remesh_neighbors();
 
+        // Saves a modified chunk on its way out.
         void unload();
 
-    protected:
-        static void _bind_methods() {}
-        void _notification(int p_what);
-
     private:
         void initialize_block_data();
+        void finish_blocks();
+        // Writes the generator's blocks for this chunk and returns their solid section mask.
+        uint32_t generate_into(Block *r_blocks) const;
+        // Takes the World's current generation settings as the baseline of the blocks about to be built.
+        void adopt_generation();
         void ensure_instance();
-        void sync_instance_transform();
 
         bool m_isInitialized = false;
+        bool m_isModified = false;
+        Core::GenerationParams m_generation;
+        uint64_t m_generationHash = 0;
+        uint32_t m_contentVersion = 0;
 
-        World *m_pWorld;
+        World *m_pWorld = nullptr;
 
         godot::Ref<Resource::Pallet> m_pallet;
         godot::Ref<godot::ArrayMesh> m_mesh;
+        Core::FaceCounts m_meshFaceCounts;
+        std::vector<uint8_t> m_meshSurfaceTypes;
         godot::RID m_instanceRID;
 
         ChunkPos m_chunk_pos;
-        std::unique_ptr<Voxel::Block *[]> m_pBlocks;
+        godot::Vector3i m_origin;
+        Neighbors m_neighbors;
+
+        ChunkSection m_sections[CHUNK_SECTION_COUNT];
+        uint32_t m_tickableSectionMask = 0;
+        uint32_t m_dirtySectionMask = 0;
+        uint32_t m_solidSectionMask = 0;
+        uint64_t m_simulationStamp = 0;
+        std::unique_ptr<Voxel::Block[]> m_pBlocks;
+        std::unique_ptr<uint8_t[]> m_pLight;
+        std::unique_ptr<uint8_t[]> m_pFluid;
+        std::unique_ptr<ChunkCollider> m_pCollider;
     };
 } //namespace Voxel
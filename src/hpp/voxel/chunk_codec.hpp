@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Voxel
+{
+    class Block;
+    class Chunk;
+
+    // Serialized block payloads. Multi-byte values are little endian.
+    // CODEC_RLE16 stores every block. Chunks are mostly long runs of air or one material, so blocks are stored as
+    // (run length, block id) pairs in chunk index order.
+    // CODEC_OVERLAY only stores the blocks that differ from the generated baseline, after the generation hash it was
+    // recorded against. Each section with changes holds (section, run count) then (start, length, block id) runs of
+    // changed blocks in section index order.
+    // Both end with the chunk's fluid, if it holds any, as Core::WireCodec encodes it.
+    class ChunkCodec
+    {
+    public:
+        enum Codec : uint8_t
+        {
+            CODEC_RLE16 = 1,
+            CODEC_OVERLAY
+        };
+
+        static void encode(const Chunk *p_chunk, std::vector<uint8_t> &r_bytes);
+        static void encode_overlay(const Chunk *p_chunk, const Block *p_baseline, uint64_t p_generationHash,
+                                   std::vector<uint8_t> &r_bytes);
+        // Decodes straight into the chunk's block storage. An overlay is applied over blocks already generated there.
+        // Fails without a complete, valid payload.
+        static bool decode(Chunk *p_chunk, const uint8_t *p_bytes, size_t p_size);
+
+        static bool is_overlay(const uint8_t *p_bytes, size_t p_size);
+        static bool read_generation_hash(const uint8_t *p_bytes, size_t p_size, uint64_t &r_hash);
+    };
+} //namespace Voxel
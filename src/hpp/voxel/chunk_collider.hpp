@@ -0,0 +1,43 @@
+#pragma once
+
+#include "hpp/voxel/constants.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <godot_cpp/variant/rid.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+
+namespace Voxel
+{
+    class Chunk;
+
+    // Static PhysicsServer3D body for a chunk with one concave shape per non-empty section. Only chunks near a
+    // tracked physics body own one, and shapes are rebuilt a section at a time as edits dirty them.
+    class ChunkCollider
+    {
+    public:
+        static constexpr uint32_t ALL_SECTIONS = CHUNK_SECTION_COUNT == 32u ? ~0u : (1u << CHUNK_SECTION_COUNT) - 1u;
+
+        explicit ChunkCollider(Chunk *p_chunk);
+        ~ChunkCollider();
+
+        ChunkCollider(const ChunkCollider &) = delete;
+        ChunkCollider &operator=(const ChunkCollider &) = delete;
+
+        void sync_transform(const godot::Transform3D &p_transform);
+
+        void mark_sections_dirty(uint32_t p_mask) { m_dirtySectionMask |= p_mask; }
+        bool has_dirty_sections() const { return m_dirtySectionMask != 0; }
+
+        // Rebuilds the lowest dirty section and returns the number of triangles it now has.
+        size_t rebuild_next_section();
+
+    private:
+        Chunk *m_pChunk;
+        godot::RID m_body;
+        godot::RID m_shapes[CHUNK_SECTION_COUNT];
+        // Index of each section's shape on the body, -1 until the section first has faces.
+        int32_t m_shapeIndices[CHUNK_SECTION_COUNT];
+        int32_t m_shapeCount = 0;
+        uint32_t m_dirtySectionMask = ALL_SECTIONS;
+    };
+} //namespace Voxel
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "hpp/tools/hash.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/constants.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Voxel
+{
+    // Toroidal index of loaded chunks. Loaded chunks form a bounded window around the viewers, so each chunk lives in
+    // slot (x mod AXIS, z mod AXIS) tagged with its position. Chunks that collide with an occupied slot (viewers farther
+    // apart than the window) fall back to an overflow map that is only probed while it isn't empty.
+    class ChunkGrid
+    {
+    public:
+        static constexpr int32_t AXIS = 256;
+        static constexpr int32_t MASK = AXIS - 1;
+
+        static_assert((AXIS & MASK) == 0, "Chunk grid axis must be a power of two.");
+        static_assert(AXIS > 2 * static_cast<int32_t>(SIMULATION_DISTANCE_MAX) + 1,
+                      "Chunk grid must fit the largest ticket window without wrapping onto itself.");
+
+        ChunkGrid() : m_slots(static_cast<size_t>(AXIS) * AXIS) {}
+
+        Chunk *find(Chunk::ChunkPos p_pos) const
+        {
+            const Slot &slot = m_slots[slot_index(p_pos)];
+            if (slot.pChunk && slot.pos == p_pos)
+                return slot.pChunk;
+
+            if (m_overflow.empty())
+                return nullptr;
+
+            return find_overflow(p_pos);
+        }
+
+        bool contains(Chunk::ChunkPos p_pos) const { return find(p_pos) != nullptr; }
+        size_t size() const { return m_count; }
+        bool empty() const { return m_count == 0; }
+
+        void insert(Chunk *p_chunk);
+        void erase(Chunk *p_chunk);
+
+        template <class Fn>
+        void for_each(Fn &&p_fn) const
+        {
+            for (const Slot &slot : m_slots)
+            {
+                if (slot.pChunk)
+                    p_fn(slot.pChunk);
+            }
+
+            for (const auto &kvp : m_overflow)
+                p_fn(kvp.second);
+        }
+
+    private:
+        struct Slot
+        {
+            Chunk::ChunkPos pos;
+            Chunk *pChunk = nullptr;
+        };
+
+        static size_t slot_index(Chunk::ChunkPos p_pos)
+        {
+            return static_cast<size_t>(p_pos.x & MASK) | (static_cast<size_t>(p_pos.y & MASK) * AXIS);
+        }
+
+        Chunk *find_overflow(Chunk::ChunkPos p_pos) const;
+        void link_neighbors(Chunk *p_chunk);
+        void unlink_neighbors(Chunk *p_chunk);
+
+        std::vector<Slot> m_slots;
+        std::unordered_map<uint64_t, Chunk *> m_overflow;
+        size_t m_count = 0;
+    };
+} //namespace Voxel
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/region_store.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Voxel
+{
+    // Moves region file reads and writes onto a worker thread. Loads go through a bounded queue and come back as
+    // encoded payloads for the main thread to decode. Saves are write-behind: the newest payload per chunk waits in a
+    // map until the worker writes it, so a chunk saved again before then is written once, and loads of a chunk with a
+    // pending write are answered from that payload.
+    class ChunkIO
+    {
+    public:
+        struct LoadResult
+        {
+            Chunk::ChunkPos pos;
+            bool found;
+            std::vector<uint8_t> bytes;
+        };
+
+        ~ChunkIO() { stop(); }
+
+        // (Re)starts the worker on a save directory. An empty directory leaves it stopped, disabling persistence.
+        void start(const std::string &p_directory);
+        // Writes everything still queued, then joins the worker.
+        void stop();
+        bool is_running() const { return m_thread.joinable(); }
+
+        // Queues a load. Returns false when the queue is full or the worker is stopped.
+        bool request_load(Chunk::ChunkPos p_chunkPos);
+        bool poll_load(LoadResult &r_result);
+        // Loads on the calling thread's behalf, waiting for the worker. Returns false when the chunk was never saved.
+        bool load_now(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &r_bytes);
+
+        // Blocks until the worker has written a payload when MAX_PENDING_WRITES are already waiting, so a disk that
+        // falls behind slows the hand-offs down instead of growing the map. Callers that can wait check
+        // is_write_queue_full first.
+        void save(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &&p_bytes);
+        bool is_write_queue_full() const;
+        // Barrier: blocks until every queued request is done and closes the region files, which compacts them.
+        void flush();
+
+        size_t get_queued_load_count() const;
+        size_t get_pending_write_count() const;
+
+    private:
+        static constexpr size_t MAX_QUEUED_LOADS = 64;
+        static constexpr size_t MAX_PENDING_WRITES = 256;
+
+        void run();
+        bool is_idle() const;
+        bool find_pending_write(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &r_bytes) const;
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        bool m_stopping = false;
+        bool m_busy = false;
+
+        std::deque<Chunk::ChunkPos> m_loadQueue;
+        std::deque<LoadResult> m_loadResults;
+        // Blocking loads skip the queue. Only the main thread waits on them, so there is at most one at a time.
+        std::deque<Chunk::ChunkPos> m_urgentLoads;
+        std::deque<LoadResult> m_urgentResults;
+        // Chunk hash -> newest unwritten payload.
+        std::unordered_map<uint64_t, std::vector<uint8_t>> m_pendingWrites;
+
+        // Only touched by the worker, or by flush while the worker is idle.
+        RegionStore m_store;
+    };
+} //namespace Voxel
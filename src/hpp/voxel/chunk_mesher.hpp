@@ -1,52 +1,27 @@
 #pragma once
 
-#include "godot_cpp/variant/packed_int32_array.hpp"
-#include "godot_cpp/variant/packed_vector2_array.hpp"
+#include "godot_cpp/classes/standard_material3d.hpp"
 #include "godot_cpp/variant/packed_vector3_array.hpp"
-#include "godot_cpp/variant/vector3.hpp"
+#include "godot_cpp/variant/vector2i.hpp"
+#include "hpp/voxel/core/mesh_builder.hpp"
+#include "hpp/voxel/resource/pallet.hpp"
+#include <cstddef>
 #include <cstdint>
 
 namespace Voxel
 {
     class Chunk;
 
+    // Godot side of meshing: queues chunks, runs Core::MeshBuilder over them and uploads the result to each chunk's
+    // ArrayMesh.
     class ChunkMesher
     {
     public:
-        struct SurfaceData
-        {
-            godot::PackedVector3Array vertices;
-            godot::PackedVector3Array vertex_normals;
-            godot::PackedVector2Array uvs;
-            godot::PackedInt32Array indices;
-        };
+        // CPU side result of meshing a chunk, one surface per material, ready to be committed to its ArrayMesh.
+        typedef Core::MeshBuffers MeshData;
 
-        struct FacePoints
-        {
-            const godot::Vector3 &p1;
-            const godot::Vector3 &p2;
-            const godot::Vector3 &p3;
-            const godot::Vector3 &p4;
-        };
-
-        struct CubePoints
-        {
-            godot::Vector3 p000;
-            godot::Vector3 p100;
-            godot::Vector3 p110;
-            godot::Vector3 p010;
-            godot::Vector3 p001;
-            godot::Vector3 p101;
-            godot::Vector3 p111;
-            godot::Vector3 p011;
-
-            const FacePoints pos_z() { return { p001, p101, p111, p011 }; }
-            const FacePoints neg_z() { return { p100, p000, p010, p110 }; }
-            const FacePoints pos_x() { return { p101, p100, p110, p111 }; }
-            const FacePoints neg_x() { return { p000, p001, p011, p010 }; }
-            const FacePoints pos_y() { return { p011, p111, p110, p010 }; }
-            const FacePoints neg_y() { return { p000, p100, p101, p001 }; }
-        };
+        // Surface type of the fluid surface, after the Pallet's material types.
+        static constexpr uint8_t SURFACE_FLUID = Resource::Pallet::TYPE_COUNT;
 
         enum DequeueQuantity
         {
@@ -55,15 +30,32 @@ namespace Voxel
             DEQUEUE_BATCH_ALL
         };
 
-        static void create_mesh(Chunk *p_chunk);
+        static size_t create_mesh(Chunk *p_chunk);
+        static void build_mesh(Chunk *p_chunk, MeshData &r_data);
+        static void commit_mesh(Chunk *p_chunk, const MeshData &p_data);
+        // Binds the World pallet's current materials to the chunk's existing surfaces, without remeshing.
+        static void apply_materials(Chunk *p_chunk);
+        static godot::Ref<godot::StandardMaterial3D> get_surface_material(const godot::Ref<Resource::Pallet> &p_pallet,
+                                                                          uint8_t p_surfaceType);
+        // Face-culled triangle soup for one section, in chunk space, for a concave collision shape.
+        static void build_collision_faces(const Chunk *p_chunk, uint32_t p_section, godot::PackedVector3Array &r_faces);
 
         static void debug_start_mesh_count();
         static uint32_t debug_end_mesh_count();
 
         static void on_chunk_unload(Chunk *p_chunk);
 
+        static bool is_queue_empty();
+        static size_t mesh_now(Chunk *p_chunk);
         static void mesh_queue(Chunk *p_chunk);
         static void mesh_dequeue(DequeueQuantity p_quantity);
+
+        // Budgeted streaming: build the queued mesh nearest to p_center on the CPU, then upload built meshes oldest
+        // first.
+        static bool build_next(godot::Vector2i p_center);
+        static bool has_pending_upload();
+        static size_t get_next_upload_size();
+        static size_t upload_next();
     };
 
 } //namespace Voxel
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "hpp/voxel/constants.hpp"
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+namespace Voxel
+{
+    // Per-section bookkeeping that lets systems skip sections with nothing to do. Block indices are local to the
+    // section (see Core::get_section_local_index), so a chunk index is section * SECTION_BLOCK_COUNT + local index.
+    struct ChunkSection
+    {
+        // Blocks that react to random ticks. Entries can go stale when a block changes and are dropped lazily.
+        std::vector<uint16_t> tickable;
+        std::bitset<SECTION_BLOCK_COUNT> tickableBits;
+        uint16_t tickCursor = 0;
+
+        void add_tickable(uint16_t p_local)
+        {
+            if (tickableBits.test(p_local))
+                return;
+
+            tickableBits.set(p_local);
+            tickable.emplace_back(p_local);
+        }
+
+        void remove_tickable_at(size_t p_entry)
+        {
+            tickableBits.reset(tickable[p_entry]);
+            tickable[p_entry] = tickable.back();
+            tickable.pop_back();
+        }
+
+        void clear_tickable()
+        {
+            tickable.clear();
+            tickableBits.reset();
+            tickCursor = 0;
+        }
+    };
+} //namespace Voxel
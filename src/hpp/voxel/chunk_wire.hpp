@@ -0,0 +1,74 @@
+#pragma once
+
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/core/wire_codec.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace Voxel
+{
+    class ChunkGrid;
+
+    // Network packets for replicating chunks. The section and delta bodies are Core::WireCodec's, this adds the packet
+    // framing and compression. Multi-byte values are little endian.
+    // PACKET_CHUNK: type, chunk x, chunk z (i32), body size (u32), then the sections and the fluid compressed with
+    // FastLZ.
+    // PACKET_DELTA: type, section count (u16), then the delta entries.
+    // PACKET_UNLOAD: type, chunk count (u16), then chunk x, chunk z of each chunk the receiver should drop.
+    class ChunkWire
+    {
+    public:
+        enum PacketType : uint8_t
+        {
+            PACKET_CHUNK = 1,
+            PACKET_DELTA,
+            PACKET_UNLOAD
+        };
+
+        using SectionDelta = Core::WireCodec::SectionDelta;
+
+        // Block and fluid changes collected between two packets. Every changed position is sent once with the block or
+        // fluid it holds when the batch is taken; a section with too many block changes is sent whole instead.
+        class DeltaBatch
+        {
+        public:
+            void record_span(const Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z);
+            void record_fluid(const Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z);
+            bool is_empty() const { return m_sections.empty(); }
+            // Encodes the batch against the current blocks and clears it. Sections of unloaded chunks are dropped.
+            godot::PackedByteArray take(const ChunkGrid &p_chunks);
+
+        private:
+            // Past this many changes a snapshot is about as small as the index/id pairs.
+            static constexpr size_t SNAPSHOT_THRESHOLD = SECTION_BLOCK_COUNT / 16;
+
+            struct Edits
+            {
+                bool snapshot = false;
+                std::vector<uint16_t> indices;
+                // Sent as their own DELTA_FLUID entry, never as a snapshot.
+                std::vector<uint16_t> fluidIndices;
+            };
+
+            // (chunk hash, section) -> edits, ordered so packets are deterministic.
+            std::map<std::pair<uint64_t, uint32_t>, Edits> m_sections;
+        };
+
+        static godot::PackedByteArray encode_chunk(const Chunk *p_chunk);
+        static bool read_chunk_pos(const godot::PackedByteArray &p_packet, Chunk::ChunkPos &r_pos);
+        // Decodes straight into the chunk's block and fluid storage. Its blocks are garbage when this fails.
+        static bool decode_chunk(const godot::PackedByteArray &p_packet, Chunk *r_chunk);
+
+        static bool decode_deltas(const godot::PackedByteArray &p_packet, std::vector<SectionDelta> &r_deltas);
+
+        static godot::PackedByteArray encode_unload(const std::vector<Chunk::ChunkPos> &p_chunks);
+        static bool decode_unload(const godot::PackedByteArray &p_packet, std::vector<Chunk::ChunkPos> &r_chunks);
+
+        static PacketType get_packet_type(const godot::PackedByteArray &p_packet);
+    };
+} //namespace Voxel
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "hpp/voxel/core/dimensions.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Build with VOXEL_MORTON_LAYOUT=1 (scons morton_layout=yes) for the Morton layout.
+#ifndef VOXEL_MORTON_LAYOUT
+#define VOXEL_MORTON_LAYOUT 0
+#endif
+
+#if VOXEL_MORTON_LAYOUT && defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Order of blocks in chunk storage. Chunks are stored section by section from the bottom up. Within a section the
+// default layout is linear: x fastest, then z, then y. The Morton layout interleaves the bits of x, z and y instead,
+// so a block's six neighbors are usually a few elements away rather than 16 or 256. Saves and network packets always
+// use the linear order, see to_storage_local.
+namespace Voxel::Core
+{
+    static constexpr bool MORTON_LAYOUT = VOXEL_MORTON_LAYOUT != 0;
+
+    // Bits of a Morton section index holding each axis, x lowest.
+    static constexpr uint32_t MORTON_MASK_X = 0x249;
+    static constexpr uint32_t MORTON_MASK_Z = 0x492;
+    static constexpr uint32_t MORTON_MASK_Y = 0x924;
+
+    // Lookup tables for targets without BMI2: the bits of a 4 bit coordinate spread three apart, and the linear
+    // index of every Morton index.
+    struct MortonTables
+    {
+        uint16_t dilated[SECTION_AXIS_LENGTH_U] = {};
+        uint16_t linear[SECTION_BLOCK_COUNT] = {};
+
+        constexpr MortonTables()
+        {
+            for (uint32_t value = 0; value < SECTION_AXIS_LENGTH_U; value++)
+            {
+                for (uint32_t bit = 0; bit < 4; bit++)
+                    dilated[value] |= static_cast<uint16_t>(((value >> bit) & 1u) << (bit * 3));
+            }
+
+            for (uint32_t y = 0; y < SECTION_AXIS_LENGTH_U; y++)
+            {
+                for (uint32_t z = 0; z < SECTION_AXIS_LENGTH_U; z++)
+                {
+                    for (uint32_t x = 0; x < SECTION_AXIS_LENGTH_U; x++)
+                    {
+                        const uint32_t morton = dilated[x] | (dilated[z] << 1) | (dilated[y] << 2);
+                        linear[morton] = static_cast<uint16_t>(x + z * SECTION_AXIS_LENGTH_U + y * SECTION_AXIS_LENGTH_U * SECTION_AXIS_LENGTH_U);
+                    }
+                }
+            }
+        }
+    };
+
+    inline constexpr MortonTables MORTON_TABLES{};
+
+    inline uint32_t encode_morton(uint32_t x, uint32_t y, uint32_t z)
+    {
+#if VOXEL_MORTON_LAYOUT && defined(__BMI2__)
+        return _pdep_u32(x, MORTON_MASK_X) | _pdep_u32(z, MORTON_MASK_Z) | _pdep_u32(y, MORTON_MASK_Y);
+#else
+        return MORTON_TABLES.dilated[x] | (MORTON_TABLES.dilated[z] << 1) | (MORTON_TABLES.dilated[y] << 2);
+#endif
+    }
+
+    inline void decode_morton(uint32_t p_morton, uint32_t &r_x, uint32_t &r_y, uint32_t &r_z)
+    {
+#if VOXEL_MORTON_LAYOUT && defined(__BMI2__)
+        r_x = _pext_u32(p_morton, MORTON_MASK_X);
+        r_z = _pext_u32(p_morton, MORTON_MASK_Z);
+        r_y = _pext_u32(p_morton, MORTON_MASK_Y);
+#else
+        const uint32_t linear = MORTON_TABLES.linear[p_morton];
+        r_x = linear & (SECTION_AXIS_LENGTH_U - 1);
+        r_z = (linear >> 4) & (SECTION_AXIS_LENGTH_U - 1);
+        r_y = linear >> 8;
+#endif
+    }
+
+    // Index of a block within its section, y relative to the section.
+    inline uint32_t get_section_local_index(uint32_t x, uint32_t y, uint32_t z)
+    {
+        if constexpr (MORTON_LAYOUT)
+            return encode_morton(x, y, z);
+        else
+            return x + z * SECTION_AXIS_LENGTH_U + y * (SECTION_AXIS_LENGTH_U * SECTION_AXIS_LENGTH_U);
+    }
+
+    inline void get_section_local_position(uint32_t p_local, uint32_t &r_x, uint32_t &r_y, uint32_t &r_z)
+    {
+        if constexpr (MORTON_LAYOUT)
+        {
+            decode_morton(p_local, r_x, r_y, r_z);
+        }
+        else
+        {
+            r_x = p_local & (SECTION_AXIS_LENGTH_U - 1);
+            r_z = (p_local >> 4) & (SECTION_AXIS_LENGTH_U - 1);
+            r_y = p_local >> 8;
+        }
+    }
+
+    inline size_t get_block_index(uint32_t x, uint32_t y, uint32_t z)
+    {
+        if constexpr (MORTON_LAYOUT)
+        {
+            return static_cast<size_t>(y / SECTION_AXIS_LENGTH_U) * SECTION_BLOCK_COUNT +
+                   encode_morton(x, y & (SECTION_AXIS_LENGTH_U - 1), z);
+        }
+        else
+        {
+            return x +
+                   static_cast<size_t>(z) * CHUNK_AXIS_LENGTH_U +
+                   static_cast<size_t>(y) * (CHUNK_AXIS_LENGTH_U * CHUNK_AXIS_LENGTH_U);
+        }
+    }
+
+    inline void get_block_position(size_t p_index, uint32_t &r_x, uint32_t &r_y, uint32_t &r_z)
+    {
+        const uint32_t section = static_cast<uint32_t>(p_index / SECTION_BLOCK_COUNT);
+        get_section_local_position(static_cast<uint32_t>(p_index % SECTION_BLOCK_COUNT), r_x, r_y, r_z);
+        r_y += section * SECTION_AXIS_LENGTH_U;
+    }
+
+    // Storage index within a section of the block at a linear (x + z * 16 + y * 256) index, and back.
+    inline uint32_t to_storage_local(uint32_t p_linear)
+    {
+        if constexpr (MORTON_LAYOUT)
+            return encode_morton(p_linear & (SECTION_AXIS_LENGTH_U - 1), p_linear >> 8, (p_linear >> 4) & (SECTION_AXIS_LENGTH_U - 1));
+        else
+            return p_linear;
+    }
+
+    inline uint32_t to_linear_local(uint32_t p_local)
+    {
+        if constexpr (MORTON_LAYOUT)
+            return MORTON_TABLES.linear[p_local];
+        else
+            return p_local;
+    }
+
+    // Same for a whole chunk.
+    inline size_t to_storage_index(size_t p_linear)
+    {
+        if constexpr (MORTON_LAYOUT)
+            return p_linear - p_linear % SECTION_BLOCK_COUNT + to_storage_local(static_cast<uint32_t>(p_linear % SECTION_BLOCK_COUNT));
+        else
+            return p_linear;
+    }
+} //namespace Voxel::Core
@@ -0,0 +1,54 @@
+#pragma once
+
+namespace Voxel::Core
+{
+    // Material (which surface and Pallet material draws a block) and atlas texture of a solid block.
+    struct BlockTypes
+    {
+        enum MaterialType
+        {
+            TYPE_UNKNOWN = 0,
+            TYPE_GENERIC,
+            TYPE_GLASS,
+            TYPE_METAL,
+            TYPE_COUNT
+        };
+
+        enum BlockTexture
+        {
+            TEXTURE_MISSING = 0,
+            TEXTURE_UNUSED_1,
+            TEXTURE_UNUSED_2,
+            TEXTURE_UNUSED_3,
+            TEXTURE_UNUSED_4,
+            TEXTURE_UNUSED_5,
+            TEXTURE_UNUSED_6,
+            TEXTURE_UNUSED_7,
+            TEXTURE_UNUSED_8,
+            TEXTURE_UNUSED_9,
+            TEXTURE_UNUSED_10,
+            TEXTURE_UNUSED_11,
+            TEXTURE_UNUSED_12,
+            TEXTURE_UNUSED_13,
+            TEXTURE_UNUSED_14,
+            TEXTURE_UNUSED_15,
+            TEXTURE_UNUSED_16,
+            TEXTURE_UNUSED_17,
+            TEXTURE_UNUSED_18,
+            TEXTURE_UNUSED_19,
+            TEXTURE_UNUSED_20,
+            TEXTURE_UNUSED_21,
+            TEXTURE_UNUSED_22,
+            TEXTURE_UNUSED_23,
+            TEXTURE_UNUSED_24,
+            TEXTURE_UNUSED_25,
+            TEXTURE_UNUSED_26,
+            TEXTURE_UNUSED_27,
+            TEXTURE_UNUSED_28,
+            TEXTURE_UNUSED_29,
+            TEXTURE_UNUSED_30,
+            TEXTURE_UNUSED_31,
+            TEXTURE_COUNT
+        };
+    };
+} //namespace Voxel::Core
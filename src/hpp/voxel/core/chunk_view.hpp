@@ -0,0 +1,35 @@
+#pragma once
+
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/core/block_layout.hpp"
+#include <cstdint>
+
+namespace Voxel::Core
+{
+    // Read-only access to a chunk's storage and that of its loaded neighbors, all in Core::get_block_index order.
+    // Light packs sky light in the high nibble and block light in the low one. Fluid is null for chunks without any,
+    // see Core::Fluid.
+    struct ChunkView
+    {
+        enum Side
+        {
+            SIDE_POS_X = 0,
+            SIDE_NEG_X,
+            SIDE_POS_Z,
+            SIDE_NEG_Z,
+            SIDE_COUNT
+        };
+
+        static constexpr uint8_t LIGHT_MAX = 15;
+        static uint8_t get_sky(uint8_t p_light) { return p_light >> 4; }
+        static uint8_t get_block(uint8_t p_light) { return p_light & 0x0F; }
+
+        const Block *pBlocks = nullptr;
+        const uint8_t *pLight = nullptr;
+        // Null for unloaded neighbors.
+        const Block *pNeighborBlocks[SIDE_COUNT] = {};
+        const uint8_t *pNeighborLight[SIDE_COUNT] = {};
+        const uint8_t *pFluid = nullptr;
+        const uint8_t *pNeighborFluid[SIDE_COUNT] = {};
+    };
+} //namespace Voxel::Core
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Chunk geometry shared by the Godot-independent core and the GDExtension side.
+namespace Voxel
+{
+    // World
+    static constexpr uint32_t CHUNK_AXIS_LENGTH_U = 16u;
+    static constexpr uint32_t CHUNK_HEIGHT_U = 512u;
+    static constexpr float CHUNK_AXIS_LENGTH_F = static_cast<float>(CHUNK_AXIS_LENGTH_U);
+    static constexpr uint32_t CHUNK_BLOCK_COUNT_MAX = CHUNK_AXIS_LENGTH_U * CHUNK_AXIS_LENGTH_U * CHUNK_HEIGHT_U;
+    static constexpr uint32_t CHUNK_AXIS_SHIFT = 4u;
+    static_assert((1u << CHUNK_AXIS_SHIFT) == CHUNK_AXIS_LENGTH_U, "Chunk axis shift must match the chunk axis length.");
+
+    // Sections (16^3 slices of a chunk stacked along y)
+    static constexpr uint32_t SECTION_AXIS_LENGTH_U = CHUNK_AXIS_LENGTH_U;
+    static constexpr uint32_t SECTION_BLOCK_COUNT = SECTION_AXIS_LENGTH_U * SECTION_AXIS_LENGTH_U * SECTION_AXIS_LENGTH_U;
+    static constexpr uint32_t CHUNK_SECTION_COUNT = CHUNK_HEIGHT_U / SECTION_AXIS_LENGTH_U;
+    static_assert(CHUNK_SECTION_COUNT <= 32u, "Section masks are stored in 32 bits.");
+
+    // Textures
+    static constexpr int ATLAS_TILES_PER_ROW = 32;
+    static constexpr int ATLAS_TILES_PER_COLUMN = 32;
+    static constexpr float TILE_UV_SIZE = 1.f / static_cast<float>(ATLAS_TILES_PER_ROW);
+} //namespace Voxel
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Voxel::Core
+{
+    // One byte of fluid per cell, stored beside a chunk's blocks only once it holds fluid. The low nibble is the level,
+    // 0 for no fluid up to LEVEL_MAX for a full cell, then the kind and whether the cell is a source. Sources keep
+    // their level, every other cell is recomputed from its neighbors whenever one of them changes.
+    struct Fluid
+    {
+        enum Kind
+        {
+            KIND_WATER = 0,
+            KIND_LAVA,
+            KIND_COUNT
+        };
+
+        static constexpr uint8_t LEVEL_MAX = 8;
+        static constexpr uint8_t NONE = 0;
+
+        static constexpr uint8_t LEVEL_MASK = 0x0F;
+        static constexpr uint8_t KIND_SHIFT = 4;
+        static constexpr uint8_t SOURCE_BIT = 0x20;
+
+        static uint8_t get_level(uint8_t p_fluid) { return p_fluid & LEVEL_MASK; }
+        static Kind get_kind(uint8_t p_fluid) { return static_cast<Kind>((p_fluid >> KIND_SHIFT) & 1); }
+        static bool is_source(uint8_t p_fluid) { return (p_fluid & SOURCE_BIT) != 0; }
+
+        // Whether a byte read from a save or a packet is NONE or a cell make could have produced.
+        static bool is_valid(uint8_t p_fluid)
+        {
+            const uint8_t known = LEVEL_MASK | (1u << KIND_SHIFT) | SOURCE_BIT;
+            return p_fluid == NONE || ((p_fluid & ~known) == 0 && get_level(p_fluid) > 0 && get_level(p_fluid) <= LEVEL_MAX);
+        }
+
+        static uint8_t make(Kind p_kind, uint8_t p_level, bool p_source = false)
+        {
+            if (p_level == 0)
+                return NONE;
+
+            return static_cast<uint8_t>((p_level & LEVEL_MASK) | (p_kind << KIND_SHIFT) | (p_source ? SOURCE_BIT : 0));
+        }
+
+        static uint8_t make_source(Kind p_kind) { return make(p_kind, LEVEL_MAX, true); }
+
+        // Levels lost per cell of sideways flow, so water runs 7 cells from a source and lava 3.
+        static uint8_t get_decay(Kind p_kind) { return p_kind == KIND_LAVA ? 2 : 1; }
+    };
+} //namespace Voxel::Core
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "hpp/voxel/core/block_types.hpp"
+#include "hpp/voxel/core/chunk_view.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Voxel::Core
+{
+    // Layout compatible with Godot's single precision Vector2, Vector3 and Color.
+    struct Float2
+    {
+        float x, y;
+    };
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    struct Float4
+    {
+        float r, g, b, a;
+    };
+
+    // Faces per material type, used to size mesh buffers before building.
+    struct FaceCounts
+    {
+        uint32_t surfaces[BlockTypes::TYPE_COUNT] = {};
+        uint32_t fluid = 0;
+
+        uint32_t get_total() const;
+    };
+
+    struct SurfaceBuffers
+    {
+        std::vector<Float3> vertices;
+        std::vector<Float3> normals;
+        std::vector<Float2> uvs;
+        std::vector<Float4> colors;
+        std::vector<int32_t> indices;
+
+        // Empties the buffers but keeps their capacity.
+        void clear();
+        // Makes room for p_faces faces, allocating only if the buffers are smaller.
+        void reserve(uint32_t p_faces);
+        size_t get_capacity_byte_size() const;
+        size_t get_byte_size() const;
+    };
+
+    // A chunk's render mesh, one surface per material type plus one for fluids, in chunk space.
+    struct MeshBuffers
+    {
+        SurfaceBuffers surfaces[BlockTypes::TYPE_COUNT];
+        // Tinted per fluid kind through the vertex color, with UVs spanning each face.
+        SurfaceBuffers fluid;
+        uint32_t faceCount = 0;
+
+        void clear();
+        void reserve(const FaceCounts &p_faceCounts);
+        FaceCounts get_face_counts() const;
+        size_t get_capacity_byte_size() const;
+        size_t get_byte_size() const;
+        // FNV-1a over every buffer, for catching changes to the generated geometry.
+        uint64_t get_hash() const;
+    };
+
+    // Mesh buffers kept with their capacity between builds. A set of buffers can be megabytes, so at most MAX_SPARE
+    // are kept and the rest freed on release: more than a few built meshes waiting on upload is a burst, not the
+    // steady state.
+    class MeshBufferPool
+    {
+    public:
+        static constexpr size_t MAX_SPARE = 4;
+
+        // Empty buffers with the capacity of a released set when there is one.
+        MeshBuffers acquire();
+        void release(MeshBuffers &&p_buffers);
+        size_t get_spare_count() const { return m_spare.size(); }
+
+    private:
+        std::vector<MeshBuffers> m_spare;
+    };
+
+    // Face-culled cube meshing. A face is drawn unless an opaque block covers it, faces against unloaded neighbors
+    // included. Each face is shaded by the light of the cell in front of it. Fluid cells become boxes as high as their
+    // level, or full height under more fluid, without the faces between fluid cells of at least the same level.
+    class MeshBuilder
+    {
+    public:
+        // Reuses r_mesh's capacity, so building into the same buffers again only allocates when a mesh outgrows them.
+        static void build(const ChunkView &p_view, MeshBuffers &r_mesh);
+        // Counts the faces build would emit without writing them, for sizing buffers up front.
+        static void count_faces(const ChunkView &p_view, FaceCounts &r_faceCounts);
+        // Triangle soup of one section's faces between solid and empty space, for a concave collision shape. Glass
+        // blocks bodies, so any solid block hides a face here.
+        static void build_collision(const ChunkView &p_view, uint32_t p_section, std::vector<Float3> &r_faces);
+
+        // Number of times a mesh buffer had to grow, by reserve or while building, on any thread. Stays flat once
+        // remeshing has warmed up its buffers.
+        static uint64_t get_allocation_count();
+    };
+} //namespace Voxel::Core
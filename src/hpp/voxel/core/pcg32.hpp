@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Voxel::Core
+{
+    // PCG32 (XSH RR) seeded and bounded the way Godot's RandomPCG is, so a chunk generates the same blocks here as it
+    // did through RandomNumberGenerator::set_seed and randi_range.
+    class Pcg32
+    {
+    public:
+        explicit Pcg32(uint64_t p_seed) { seed(p_seed); }
+
+        void seed(uint64_t p_seed)
+        {
+            m_state = 0;
+            m_increment = (DEFAULT_STREAM << 1u) | 1u;
+            next();
+            m_state += p_seed;
+            next();
+        }
+
+        uint32_t next()
+        {
+            const uint64_t old = m_state;
+            m_state = old * MULTIPLIER + m_increment;
+            const uint32_t xorShifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+            const uint32_t rotation = static_cast<uint32_t>(old >> 59u);
+            return (xorShifted >> rotation) | (xorShifted << ((~rotation + 1u) & 31u));
+        }
+
+        // Uniform in [0, p_bound) without modulo bias.
+        uint32_t next_bounded(uint32_t p_bound)
+        {
+            if (p_bound == 0)
+                return 0;
+
+            const uint32_t threshold = (~p_bound + 1u) % p_bound;
+            while (true)
+            {
+                const uint32_t value = next();
+                if (value >= threshold)
+                    return value % p_bound;
+            }
+        }
+
+        // Uniform in [p_from, p_to], both ends inclusive.
+        int32_t range(int32_t p_from, int32_t p_to)
+        {
+            if (p_from == p_to)
+                return p_from;
+
+            const int32_t low = p_from < p_to ? p_from : p_to;
+            const int32_t high = p_from < p_to ? p_to : p_from;
+            return static_cast<int32_t>(next_bounded(static_cast<uint32_t>(high - low) + 1u)) + low;
+        }
+
+    private:
+        static constexpr uint64_t MULTIPLIER = 6364136223846793005ull;
+        static constexpr uint64_t DEFAULT_STREAM = 1442695040888963407ull;
+
+        uint64_t m_state;
+        uint64_t m_increment;
+    };
+} //namespace Voxel::Core
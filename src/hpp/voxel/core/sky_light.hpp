@@ -0,0 +1,18 @@
+#pragma once
+
+#include "hpp/voxel/block.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Voxel::Core
+{
+    // Sky light of one chunk on its own: full light straight down every open column, then one level less per step
+    // sideways and up. The flood stops at the chunk's sides, exchanging light with the neighbors is up to the caller
+    // (see LightEngine). Light is packed as in ChunkView, the block light nibble is cleared.
+    class SkyLight
+    {
+    public:
+        // r_queue is scratch space, kept by the caller so its buffer is reused from chunk to chunk.
+        static void light_chunk(const Block *p_blocks, uint8_t *r_light, std::vector<uint32_t> &r_queue);
+    };
+} //namespace Voxel::Core
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "hpp/voxel/block.hpp"
+#include <cstdint>
+
+namespace Voxel::Core
+{
+    struct GenerationParams
+    {
+        int64_t seed = 0;
+        int32_t seaLevel = 0;
+    };
+
+    // Fills a chunk's blocks from the world seed alone. Each chunk has its own random stream, so a chunk generates the
+    // same blocks regardless of the order chunks stream in.
+    class TerrainGenerator
+    {
+    public:
+        static uint64_t get_chunk_seed(int64_t p_seed, int32_t p_chunkX, int32_t p_chunkZ);
+        // Writes CHUNK_BLOCK_COUNT_MAX blocks and returns the mask of sections holding a solid block.
+        static uint32_t generate(const GenerationParams &p_params, int32_t p_chunkX, int32_t p_chunkZ, Block *r_blocks);
+    };
+} //namespace Voxel::Core
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/core/dimensions.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Voxel::Core
+{
+    // Bodies of the network packets, without the framing and compression ChunkWire adds. Multi-byte values are little
+    // endian.
+    // Sections are sent as a palette of block ids followed by each block's palette index, bit packed at the fewest
+    // bits that fit the palette. Uniform sections (all air, solid stone) send only their id, with a count of the
+    // identical uniform sections that follow so a run of them costs one entry.
+    // Fluid follows the sections it belongs to, behind FLUID_MARKER: for each section holding any, (section, run count)
+    // then (start, length - 1, fluid) runs of equal cells in section index order, empty cells skipped.
+    // A delta entry is chunk x, chunk z (i32), section (u8) and a mode (u8). DELTA_SPARSE lists (index in section,
+    // block id) pairs, DELTA_SNAPSHOT carries the whole section body and DELTA_FLUID lists (index in section, fluid)
+    // pairs.
+    class WireCodec
+    {
+    public:
+        enum DeltaMode : uint8_t
+        {
+            DELTA_SPARSE = 0,
+            DELTA_SNAPSHOT,
+            DELTA_FLUID
+        };
+
+        // Changed blocks or fluid cells of one section, as decoded from a delta packet. Snapshots hold all
+        // SECTION_BLOCK_COUNT blocks, fluid entries fill fluids instead of blocks.
+        struct SectionDelta
+        {
+            int32_t chunkX = 0;
+            int32_t chunkZ = 0;
+            uint32_t section = 0;
+            DeltaMode mode = DELTA_SPARSE;
+            std::vector<uint16_t> indices;
+            std::vector<Block> blocks;
+            std::vector<uint8_t> fluids;
+        };
+
+        // Starts the fluid after a chunk's blocks. Never a section index, so it also ends a list of sections.
+        static constexpr uint8_t FLUID_MARKER = 0xFF;
+
+        // Above any valid chunk body (a full palette and 12 bit indices in every section, then fluid changing at every
+        // cell), caps what a packet can allocate.
+        static constexpr uint32_t MAX_BODY_SIZE = CHUNK_SECTION_COUNT * (2 + SECTION_BLOCK_COUNT * 2 + SECTION_BLOCK_COUNT * 12 / 8) + 1 +
+                                                  CHUNK_SECTION_COUNT * (3 + SECTION_BLOCK_COUNT * 5);
+
+        static void put_u16(std::vector<uint8_t> &r_bytes, uint32_t p_value)
+        {
+            r_bytes.push_back(static_cast<uint8_t>(p_value & 0xFF));
+            r_bytes.push_back(static_cast<uint8_t>((p_value >> 8) & 0xFF));
+        }
+
+        static void put_u32(std::vector<uint8_t> &r_bytes, uint32_t p_value)
+        {
+            put_u16(r_bytes, p_value & 0xFFFF);
+            put_u16(r_bytes, p_value >> 16);
+        }
+
+        static uint32_t get_u16(const uint8_t *p_bytes)
+        {
+            return static_cast<uint32_t>(p_bytes[0]) | (static_cast<uint32_t>(p_bytes[1]) << 8);
+        }
+
+        static uint32_t get_u32(const uint8_t *p_bytes) { return get_u16(p_bytes) | (get_u16(p_bytes + 2) << 16); }
+
+        // Appends p_count consecutive sections starting at p_blocks.
+        static void encode_sections(const Block *p_blocks, uint32_t p_count, std::vector<uint8_t> &r_bytes);
+        // Returns the end of what was read, or nullptr when the bytes are truncated or invalid.
+        static const uint8_t *decode_sections(const uint8_t *p_cursor, const uint8_t *p_end, uint32_t p_count, Block *r_blocks);
+
+        // Appends the fluid of a chunk, CHUNK_BLOCK_COUNT_MAX cells or null, and nothing when it holds none.
+        static void encode_fluid(const uint8_t *p_fluid, std::vector<uint8_t> &r_bytes);
+        // Reads fluid from FLUID_MARKER to p_end into r_fluid, CHUNK_BLOCK_COUNT_MAX cells cleared by the caller.
+        static bool decode_fluid(const uint8_t *p_cursor, const uint8_t *p_end, uint8_t *r_fluid);
+
+        // Appends one delta entry for section p_section, whose blocks start at p_blocks. Sparse entries send p_indices,
+        // which must be sorted and unique, with the blocks they hold now.
+        static void encode_delta(int32_t p_chunkX, int32_t p_chunkZ, uint32_t p_section, const Block *p_blocks,
+                                 DeltaMode p_mode, const std::vector<uint16_t> &p_indices, std::vector<uint8_t> &r_bytes);
+        // Appends a DELTA_FLUID entry for section p_section, whose fluid starts at p_fluid (null when the chunk has none).
+        static void encode_fluid_delta(int32_t p_chunkX, int32_t p_chunkZ, uint32_t p_section, const uint8_t *p_fluid,
+                                       const std::vector<uint16_t> &p_indices, std::vector<uint8_t> &r_bytes);
+        // Decodes p_count entries, which must fill the bytes exactly, into r_deltas reusing its entries' buffers.
+        static bool decode_deltas(const uint8_t *p_cursor, const uint8_t *p_end, uint32_t p_count, std::vector<SectionDelta> &r_deltas);
+
+        // Linear index of a block within its section as deltas send it, whatever the storage layout, and its inverse.
+        static uint32_t get_section_index(uint32_t x, uint32_t y, uint32_t z);
+        static void get_section_position(uint32_t p_index, uint32_t &r_x, uint32_t &r_y, uint32_t &r_z);
+    };
+} //namespace Voxel::Core
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "hpp/voxel/constants.hpp"
+#include "hpp/voxel/core/fluid.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Voxel
+{
+    class Chunk;
+    class World;
+
+    // Cellular automaton for water and lava. Only active cells are stepped: those placed or removed, and the neighbors
+    // of every cell that changed, kept in per-section sets. Fluid at rest leaves the sets empty and costs nothing, and
+    // a flood costs in proportion to its moving front.
+    //
+    // A step reads the current levels and writes each section's results to its own change list, so sections step in
+    // parallel without seeing each other's writes. The lists are then applied on the calling thread, which exchanges
+    // the cells on section and chunk borders into the next step's sets of the sections across them. Each changed cell
+    // is saved and replicated through World::mark_fluid_dirty inside the tick's edit, so a section is remeshed once per
+    // step at most.
+    //
+    // Flow rules: sources keep their level. A cell under fluid fills to LEVEL_MAX - 1 and falls on. Otherwise it takes
+    // the highest level among its horizontal neighbors resting on a solid block or a source, minus the kind's decay.
+    // Solid blocks hold no fluid.
+    class FluidSimulator
+    {
+    public:
+        // Simulation ticks between steps, so water spreads a cell every 0.2s.
+        static constexpr uint32_t TICKS_PER_STEP = 4;
+        // Fewer active sections than this step on the calling thread, waking the workers would cost more.
+        static constexpr size_t PARALLEL_MIN_SECTIONS = 8;
+
+        FluidSimulator() = default;
+        ~FluidSimulator();
+
+        FluidSimulator(const FluidSimulator &) = delete;
+        FluidSimulator &operator=(const FluidSimulator &) = delete;
+
+        // Steps the active cells of the chunks simulated this tick. The others stay active until they are again.
+        void tick(World *p_world, uint64_t p_tick);
+
+        // Writes a cell directly, remeshes it and wakes its neighbors. Returns false when a solid block is there.
+        bool set_fluid(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, uint8_t p_fluid);
+        // Wakes every cell whose flow may depend on the span, after its blocks changed. Free when no fluid is near.
+        void on_span_changed(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z);
+        // Wakes the chunk's fluid and its neighbors' along the shared borders, after all its blocks and fluid were
+        // replaced by generation, a load or a replicated packet.
+        void on_chunk_replaced(Chunk *p_chunk);
+        void on_chunk_unload(Chunk *p_chunk);
+
+        size_t get_active_cell_count() const;
+        size_t get_active_section_count() const;
+
+    private:
+        struct Change
+        {
+            uint16_t local;
+            uint8_t fluid;
+        };
+
+        // One section's share of a step.
+        struct Job
+        {
+            Chunk *pChunk;
+            uint32_t section;
+            std::vector<uint16_t> cells;
+            std::vector<Change> changes;
+        };
+
+        struct ActiveChunk
+        {
+            Chunk *pChunk = nullptr;
+            uint32_t sectionMask = 0;
+            // Section local indices, duplicates included until the step that takes them.
+            std::vector<uint16_t> cells[CHUNK_SECTION_COUNT];
+        };
+
+        void activate(Chunk *p_chunk, int32_t x, int32_t y, int32_t z);
+        void activate_dependents(Chunk *p_chunk, int32_t x, int32_t y, int32_t z);
+        void gather_jobs(uint64_t p_tick);
+        void run_jobs();
+        void apply_jobs(World *p_world);
+        static void step_section(Job &r_job);
+
+        void start_workers();
+        void stop_workers();
+        void run_worker(uint64_t p_generation);
+        void take_jobs();
+
+        // Chunk hash -> the cells to step next.
+        std::unordered_map<uint64_t, ActiveChunk> m_active;
+
+        std::vector<Job> m_jobs;
+        // Kept between steps with their buffers, only the first m_jobCount are this step's.
+        size_t m_jobCount = 0;
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        uint64_t m_generation = 0;
+        uint32_t m_busyWorkers = 0;
+        bool m_stopping = false;
+        std::atomic<size_t> m_nextJob{ 0 };
+    };
+} //namespace Voxel
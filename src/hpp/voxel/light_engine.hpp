@@ -0,0 +1,76 @@
+#pragma once
+
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/core/chunk_view.hpp"
+#include "hpp/voxel/resource/pallet.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Voxel
+{
+    class Chunk;
+    class World;
+
+    // Flood-fill sky and block light. Each voxel stores both levels in one byte (sky in the high nibble, block in the
+    // low one). Light spreads breadth first across chunk borders through the neighbor links, losing one level per
+    // step except sky light falling straight down. Edits only relight the cells whose light depended on the changed
+    // blocks, using a removal pass followed by a refill from the surrounding light.
+    class LightEngine
+    {
+    public:
+        enum Channel
+        {
+            CHANNEL_SKY = 0,
+            CHANNEL_BLOCK,
+            CHANNEL_COUNT
+        };
+
+        // The packing is shared with the meshing core, see Core::ChunkView.
+        static constexpr uint8_t LIGHT_MAX = Core::ChunkView::LIGHT_MAX;
+
+        static uint8_t get_sky(uint8_t p_light) { return Core::ChunkView::get_sky(p_light); }
+        static uint8_t get_block(uint8_t p_light) { return Core::ChunkView::get_block(p_light); }
+
+        void set_emission(Resource::Pallet::BlockTexture p_texture, uint8_t p_level);
+        uint8_t get_emission(const Block *p_block) const { return p_block->is_solid() ? m_emission[p_block->get_texture()] : 0; }
+
+        // Computes a freshly generated chunk's light and exchanges light with its loaded neighbors.
+        void light_chunk(World *p_world, Chunk *p_chunk);
+
+        void queue_span(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z);
+        // Relights around every queued change, marking the sections whose light changed for remeshing.
+        void propagate(World *p_world);
+
+        void on_chunk_unload(Chunk *p_chunk);
+
+    private:
+        struct Node
+        {
+            Chunk *pChunk;
+            uint32_t index;
+        };
+
+        struct RemovalNode
+        {
+            Chunk *pChunk;
+            uint32_t index;
+            uint8_t level;
+        };
+
+        void write_level(World *p_world, Chunk *p_chunk, uint32_t p_index, Channel p_channel, uint8_t p_level);
+        void run_removal(World *p_world, Channel p_channel);
+        void run_add(World *p_world, Channel p_channel);
+
+        uint8_t m_emission[Resource::Pallet::TEXTURE_COUNT] = {};
+        bool m_hasEmitters = false;
+
+        // Scratch for Core::SkyLight, one chunk at a time.
+        std::vector<uint32_t> m_skyQueue;
+        std::vector<Node> m_changed;
+        std::vector<Node> m_add[CHANNEL_COUNT];
+        std::vector<RemovalNode> m_remove[CHANNEL_COUNT];
+
+        // Chunk being lit by light_chunk. It is meshed afterwards anyway, so its own writes aren't marked dirty.
+        Chunk *m_pLighting = nullptr;
+    };
+} //namespace Voxel
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include "godot_cpp/variant/vector2.hpp"
+#include "hpp/voxel/chunk.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Voxel
+{
+    class ChunkGrid;
+
+    // Server side interest management. Every peer subscribes to the chunks within a square radius of its position and
+    // is sent those it doesn't have yet, or has an older version of, nearest and most in view first. Each peer has its
+    // own bytes per second budget, so a far teleport streams in over time instead of flooding the uplink. Chunks a
+    // peer moved away from are announced in unload packets. Outgoing packets queue per peer for the caller to send.
+    class PeerTracker
+    {
+    public:
+        void add_peer(int32_t p_peerId, Chunk::ChunkPos p_center, int32_t p_radius, int64_t p_ticket);
+        // Returns the peer's chunk ticket so the caller can release it, or 0 for an unknown peer.
+        int64_t remove_peer(int32_t p_peerId);
+        bool has_peer(int32_t p_peerId) const { return m_peers.find(p_peerId) != m_peers.end(); }
+        int64_t get_ticket(int32_t p_peerId) const;
+        size_t get_peer_count() const { return m_peers.size(); }
+
+        // p_viewDirection is on the horizontal plane. A zero vector ranks by distance only.
+        void set_peer_view(int32_t p_peerId, Chunk::ChunkPos p_center, godot::Vector2 p_viewDirection);
+
+        size_t get_bandwidth() const { return m_bytesPerSecond; }
+        void set_bandwidth(size_t p_bytesPerSecond) { m_bytesPerSecond = p_bytesPerSecond; }
+
+        // Queues what every peer is due this frame.
+        void update(const ChunkGrid &p_chunks, double p_delta);
+        std::vector<godot::PackedByteArray> take_packets(int32_t p_peerId);
+        // Chunks the peer was sent, at their current version or not.
+        size_t get_sent_count(int32_t p_peerId) const;
+
+    private:
+        // Budget a peer may save up while it has nothing to receive, so idle peers can't burst far past their rate.
+        static constexpr double MAX_BURST_SECONDS = 0.5;
+        static constexpr size_t MAX_SENDS_PER_PEER = 16;
+
+        struct Peer
+        {
+            Chunk::ChunkPos center;
+            godot::Vector2 viewDirection;
+            int32_t radius;
+            int64_t ticket;
+            double budgetBytes;
+            // Chunk hash -> content version the peer was sent.
+            std::unordered_map<uint64_t, uint32_t> sent;
+            std::vector<godot::PackedByteArray> outgoing;
+        };
+
+        struct Candidate
+        {
+            const Chunk *pChunk;
+            float score;
+        };
+
+        void update_peer(Peer &r_peer, const ChunkGrid &p_chunks, double p_delta);
+        const godot::PackedByteArray &get_chunk_packet(const Chunk *p_chunk);
+
+        std::unordered_map<int32_t, Peer> m_peers;
+        size_t m_bytesPerSecond = 256 * 1024;
+        std::vector<Candidate> m_candidates;
+
+        // Packets encoded this frame, shared by every peer due the same chunk version.
+        struct CachedPacket
+        {
+            uint32_t version;
+            godot::PackedByteArray packet;
+        };
+        std::unordered_map<uint64_t, CachedPacket> m_packetCache;
+    };
+} //namespace Voxel
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "hpp/tools/mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Voxel
+{
+    // One file holding up to REGION_AXIS x REGION_AXIS chunks. The first sector is an offset table with one entry per
+    // chunk (first sector << 8 | sector count, 0 when absent). Each chunk occupies whole SECTOR_SIZE sectors holding
+    // its payload length followed by the payload. Reads return pointers into the memory mapping.
+    class RegionFile
+    {
+    public:
+        static constexpr int32_t REGION_SHIFT = 5;
+        static constexpr int32_t REGION_AXIS = 1 << REGION_SHIFT;
+        static constexpr uint32_t CHUNK_COUNT = REGION_AXIS * REGION_AXIS;
+        static constexpr size_t SECTOR_SIZE = 4096;
+        static constexpr uint32_t HEADER_SECTORS = 1;
+        static constexpr uint32_t MAX_SECTORS_PER_CHUNK = 255;
+
+        static_assert(CHUNK_COUNT * sizeof(uint32_t) <= HEADER_SECTORS * SECTOR_SIZE, "Offset table must fit the header.");
+
+        bool open(const std::string &p_path);
+        // Compacts when enough of the file is free, then trims it to the sectors in use.
+        void close();
+
+        // The view stays valid until the next write or compaction.
+        bool read(uint32_t p_slot, const uint8_t *&r_data, size_t &r_size) const;
+        bool write(uint32_t p_slot, const uint8_t *p_data, size_t p_size);
+        void compact();
+
+        bool has(uint32_t p_slot) const { return m_table[p_slot] != 0; }
+
+    private:
+        static uint32_t entry_offset(uint32_t p_entry) { return p_entry >> 8; }
+        static uint32_t entry_count(uint32_t p_entry) { return p_entry & 0xFF; }
+
+        uint32_t allocate(uint32_t p_count);
+        void release(uint32_t p_offset, uint32_t p_count);
+        bool write_entry(uint32_t p_slot, uint32_t p_entry);
+
+        Tools::MappedFile m_file;
+        uint32_t m_table[CHUNK_COUNT] = {};
+        std::vector<bool> m_usedSectors;
+        uint32_t m_freeSectors = 0;
+    };
+} //namespace Voxel
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/region_file.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Voxel
+{
+    // Reads and writes encoded chunk payloads through the region files of one save directory, keeping the most
+    // recently used regions open. Persistence is disabled while no directory is set. Not thread safe, ChunkIO owns the
+    // store on its worker thread.
+    class RegionStore
+    {
+    public:
+        ~RegionStore() { close_all(); }
+
+        void set_directory(const std::string &p_directory);
+        bool is_enabled() const { return !m_directory.empty(); }
+
+        // Copies the chunk's saved payload out of its region. Returns false when it was never saved.
+        bool read(Chunk::ChunkPos p_chunkPos, std::vector<uint8_t> &r_bytes);
+        bool write(Chunk::ChunkPos p_chunkPos, const std::vector<uint8_t> &p_bytes);
+
+        void close_all();
+
+    private:
+        static constexpr size_t MAX_OPEN_REGIONS = 16;
+
+        struct OpenRegion
+        {
+            std::unique_ptr<RegionFile> pFile;
+            uint64_t lastUse;
+        };
+
+        static Chunk::ChunkPos get_region_pos(Chunk::ChunkPos p_chunkPos);
+        static uint32_t get_slot(Chunk::ChunkPos p_chunkPos);
+        RegionFile *get_region(Chunk::ChunkPos p_regionPos, bool p_create);
+
+        std::string m_directory;
+        std::unordered_map<uint64_t, OpenRegion> m_regions;
+        uint64_t m_useCounter = 0;
+    };
+} //namespace Voxel
@@ -3,60 +3,18 @@
 #include "godot_cpp/classes/resource.hpp"
 #include "godot_cpp/classes/standard_material3d.hpp"
 #include "godot_cpp/classes/texture.hpp"
+#include "hpp/voxel/core/block_types.hpp"
 #include <godot_cpp/core/class_db.hpp>
 
 namespace Voxel::Resource
 {
-    class Pallet : public godot::Resource
+    // Materials and atlas that draw the block types. The type enums live in Core::BlockTypes so the core library can
+    // use them without Godot.
+    class Pallet : public godot::Resource, public Core::BlockTypes
     {
         GDCLASS(Pallet, godot::Resource);
 
     public:
-        enum MaterialType
-        {
-            TYPE_UNKNOWN = 0,
-            TYPE_GENERIC,
-            TYPE_GLASS,
-            TYPE_METAL,
-            TYPE_COUNT
-        };
-
-        enum BlockTexture
-        {
-            TEXTURE_MISSING = 0,
-            TEXTURE_UNUSED_1,
-            TEXTURE_UNUSED_2,
-            TEXTURE_UNUSED_3,
-            TEXTURE_UNUSED_4,
-            TEXTURE_UNUSED_5,
-            TEXTURE_UNUSED_6,
-            TEXTURE_UNUSED_7,
-            TEXTURE_UNUSED_8,
-            TEXTURE_UNUSED_9,
-            TEXTURE_UNUSED_10,
-            TEXTURE_UNUSED_11,
-            TEXTURE_UNUSED_12,
-            TEXTURE_UNUSED_13,
-            TEXTURE_UNUSED_14,
-            TEXTURE_UNUSED_15,
-            TEXTURE_UNUSED_16,
-            TEXTURE_UNUSED_17,
-            TEXTURE_UNUSED_18,
-            TEXTURE_UNUSED_19,
-            TEXTURE_UNUSED_20,
-            TEXTURE_UNUSED_21,
-            TEXTURE_UNUSED_22,
-            TEXTURE_UNUSED_23,
-            TEXTURE_UNUSED_24,
-            TEXTURE_UNUSED_25,
-            TEXTURE_UNUSED_26,
-            TEXTURE_UNUSED_27,
-            TEXTURE_UNUSED_28,
-            TEXTURE_UNUSED_29,
-            TEXTURE_UNUSED_30,
-            TEXTURE_UNUSED_31,
-        };
-
         godot::Ref<godot::StandardMaterial3D> get_material(int p_type) const;
 
         godot::Ref<godot::StandardMaterial3D> get_unknown_material() const { return get_material(TYPE_UNKNOWN); }
@@ -87,6 +45,14 @@ namespace Voxel::Resource
             emit_changed();
         }
 
+        // Draws water and lava, tinted per kind through the vertex color. It doesn't take the atlas.
+        godot::Ref<godot::StandardMaterial3D> get_fluid_material() const { return m_fluidMaterial; }
+        void set_fluid_material(godot::Ref<godot::StandardMaterial3D> m)
+        {
+            m_fluidMaterial = m;
+            emit_changed();
+        }
+
         godot::Ref<godot::Texture> get_atlas() const { return m_atlas; }
         void set_atlas(godot::Ref<godot::Texture> p_atlas);
 
@@ -98,6 +64,7 @@ namespace Voxel::Resource
 
     private:
         godot::Ref<godot::StandardMaterial3D> m_materials[TYPE_COUNT];
+        godot::Ref<godot::StandardMaterial3D> m_fluidMaterial;
         godot::Ref<godot::Texture> m_atlas;
     };
 } //namespace Voxel::Resource
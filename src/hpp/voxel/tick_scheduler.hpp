@@ -0,0 +1,69 @@
+#pragma once
+
+#include "godot_cpp/variant/vector2i.hpp"
+#include "hpp/voxel/block.hpp"
+#include "hpp/voxel/resource/pallet.hpp"
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace Voxel
+{
+    class Chunk;
+    class World;
+
+    // Runs random ticks and scheduled block updates for the chunks inside the simulation distance.
+    // Random ticks walk each section's tickable list with a rolling stride, so sections without tickable blocks are
+    // never visited. A tick runs as one World edit, so every changed chunk is remeshed once at the end of it.
+    class TickScheduler
+    {
+    public:
+        // Returns true when the handler changed the block at local (x, y, z) of p_chunk.
+        typedef bool (*BlockHandler)(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, Block *p_block);
+
+        void set_random_tick_handler(Resource::Pallet::BlockTexture p_texture, BlockHandler p_handler);
+        void set_scheduled_update_handler(Resource::Pallet::BlockTexture p_texture, BlockHandler p_handler);
+
+        bool has_random_tick_handlers() const { return m_randomHandlerCount > 0; }
+        bool is_tickable(const Block *p_block) const
+        {
+            return p_block && p_block->get_texture() < Resource::Pallet::TEXTURE_COUNT &&
+                   m_randomHandlers[p_block->get_texture()] != nullptr;
+        }
+
+        void set_random_tick_speed(uint32_t p_speed) { m_randomTickSpeed = p_speed; }
+        uint32_t get_random_tick_speed() const { return m_randomTickSpeed; }
+
+        uint64_t get_tick() const { return m_tick; }
+
+        void schedule(godot::Vector2i p_chunkPos, uint32_t p_blockIndex, uint32_t p_delayTicks);
+        void tick(World *p_world, const std::vector<Chunk *> &p_simulatedChunks);
+        void on_chunk_unload(Chunk *p_chunk);
+
+    private:
+        struct ScheduledUpdate
+        {
+            uint64_t dueTick;
+            godot::Vector2i chunkPos;
+            uint32_t blockIndex;
+
+            bool operator>(const ScheduledUpdate &p_other) const { return dueTick > p_other.dueTick; }
+        };
+
+        void run_random_ticks(World *p_world, Chunk *p_chunk);
+        void run_scheduled_updates(World *p_world);
+        void restore_parked(Chunk *p_chunk);
+        void mark_changed(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z);
+
+        BlockHandler m_randomHandlers[Resource::Pallet::TEXTURE_COUNT] = {};
+        BlockHandler m_scheduledHandlers[Resource::Pallet::TEXTURE_COUNT] = {};
+        uint32_t m_randomHandlerCount = 0;
+        uint32_t m_randomTickSpeed = 3;
+
+        uint64_t m_tick = 0;
+        std::priority_queue<ScheduledUpdate, std::vector<ScheduledUpdate>, std::greater<ScheduledUpdate>> m_scheduled;
+        // Due updates whose chunk was loaded but outside the simulation distance, keyed by chunk hash.
+        std::unordered_map<uint64_t, std::vector<ScheduledUpdate>> m_parked;
+    };
+} //namespace Voxel
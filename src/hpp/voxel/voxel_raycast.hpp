@@ -0,0 +1,27 @@
+#pragma once
+
+#include "godot_cpp/variant/vector3.hpp"
+#include "godot_cpp/variant/vector3i.hpp"
+#include <cstdint>
+
+namespace Voxel
+{
+    class ChunkGrid;
+
+    // Amanatides-Woo traversal over chunk storage. Rays are in the World's local space, one unit per block. Cells in
+    // unloaded chunks or all-air sections are crossed a whole 16^3 section at a time.
+    class VoxelRaycast
+    {
+    public:
+        struct Hit
+        {
+            godot::Vector3i block;
+            godot::Vector3i normal; // Face the ray entered through, zero when the ray starts inside a solid block
+            float distance = 0.f;
+            int32_t id = 0;
+        };
+
+        static bool cast(const ChunkGrid &p_chunks, godot::Vector3 p_origin, godot::Vector3 p_direction,
+                         float p_maxDistance, Hit &r_hit);
+    };
+} //namespace Voxel
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "godot_cpp/variant/vector3.hpp"
+#include <cstdint>
+
+namespace Voxel
+{
+    class ChunkGrid;
+
+    // Swept AABB movement against the block grid, resolved one axis at a time (y, then x, then z) so entities slide
+    // along walls and settle on floors. Boxes are in the World's local space, one unit per block. Blocks in unloaded
+    // chunks count as solid so entities can't fall through terrain that hasn't streamed in yet.
+    class VoxelSweep
+    {
+    public:
+        enum Contact : uint32_t
+        {
+            CONTACT_NONE = 0,
+            CONTACT_FLOOR = 1u << 0,
+            CONTACT_CEILING = 1u << 1,
+            CONTACT_WALL_X = 1u << 2,
+            CONTACT_WALL_Z = 1u << 3
+        };
+
+        // Moves the box centered on r_center by p_motion and returns the Contact flags of the axes that were blocked.
+        static uint32_t move(const ChunkGrid &p_chunks, godot::Vector3 &r_center, godot::Vector3 p_halfExtents,
+                             godot::Vector3 p_motion);
+    };
+} //namespace Voxel
@@ -1,22 +1,39 @@
 #pragma once
 
-#include "godot_cpp/classes/random_number_generator.hpp"
 #include "godot_cpp/classes/timer.hpp"
 #include "godot_cpp/variant/vector2i.hpp"
 #include "hpp/tools/hash.hpp"
-#include "hpp/tools/log_stream.hpp"
+#include "hpp/tools/log.hpp"
 #include "hpp/tools/string.hpp"
+#include "hpp/tools/trace.hpp"
 #include "hpp/voxel/chunk.hpp"
+#include "hpp/voxel/chunk_grid.hpp"
+#include "hpp/voxel/chunk_io.hpp"
+#include "hpp/voxel/chunk_wire.hpp"
+#include "hpp/voxel/core/terrain_generator.hpp"
+#include "hpp/voxel/fluid_simulator.hpp"
+#include "hpp/voxel/light_engine.hpp"
+#include "hpp/voxel/peer_tracker.hpp"
+#include "hpp/voxel/tick_scheduler.hpp"
 #include "resource/generation_settings.hpp"
 #include "resource/pallet.hpp"
 #include <cstdint>
+#include <deque>
 #include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/classes/wrapped.hpp>
 #include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <hpp/tools/log.hpp>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace Voxel
 {
@@ -30,17 +47,34 @@ namespace Voxel
         GDCLASS(World, godot::Node3D)
 
     public:
+        // A request from a loader (player, camera, scripted area) to keep every chunk within a square radius of
+        // its center loaded. Overlapping tickets share chunks through a per-chunk reference count.
+        struct Ticket
+        {
+            Chunk::ChunkPos center;
+            int32_t radius;
+            int32_t priority;
+        };
+
+        enum SaveMode
+        {
+            SAVE_FULL = 0,
+            SAVE_EDITS
+        };
+
         World() = default;
         ~World() override = default;
 
         void _ready() override;
+        void _enter_tree() override;
         void _exit_tree() override;
+        void _process(double p_delta) override;
+        void _physics_process(double p_delta) override;
 
         int32_t get_render_distance() const { return m_renderDistance; }
         void set_render_distance(int32_t v)
         {
             m_renderDistance = godot::MAX(v, 1);
-            request_rebuild();
         }
 
         int64_t get_seed() const { return m_seed; }
@@ -54,42 +88,177 @@ namespace Voxel
         void set_spawn_radius(int32_t s)
         {
             m_spawnRadius = godot::CLAMP(s, 1, 3);
-            request_rebuild();
+            // Only the spawn ticket changes, the chunks it no longer covers unload and the new ones stream in.
+            if (is_inside_tree())
+                ensure_spawn_ticket();
         }
 
+        // Swapping the pallet, or a material or the atlas on it, rebinds the materials of the existing chunk meshes
+        // in place. Blocks and meshes are left as they are.
         godot::Ref<Resource::Pallet> get_pallet() const { return m_pallet; }
-        void set_pallet(const godot::Ref<Resource::Pallet> &p)
-        {
-            m_pallet = p;
-            request_rebuild();
-        }
+        void set_pallet(const godot::Ref<Resource::Pallet> &p);
+        void refresh_materials();
 
         godot::Ref<Resource::GenerationSettings> get_settings() const { return m_generationSettings; }
-        void set_settings(const godot::Ref<Resource::GenerationSettings> &g)
-        {
-            m_generationSettings = g;
-            request_rebuild();
-        }
+        void set_settings(const godot::Ref<Resource::GenerationSettings> &g);
+
+        // What Core::TerrainGenerator needs from the seed and settings.
+        Core::GenerationParams get_generation_params() const;
+        // Identifies what the generator produces, (seed, GenerationSettings) and the generator version. Saved edits
+        // only apply over the baseline they were recorded against.
+        uint64_t get_generation_hash() const;
+
+        double get_streaming_budget_ms() const { return m_streamingBudgetMs; }
+        void set_streaming_budget_ms(double v) { m_streamingBudgetMs = godot::CLAMP(v, 0.1, 16.6); }
+
+        int32_t get_simulation_distance() const { return m_simulationDistance; }
+        void set_simulation_distance(int32_t v) { m_simulationDistance = godot::CLAMP(v, 0, static_cast<int32_t>(SIMULATION_DISTANCE_MAX)); }
+
+        int32_t get_random_tick_speed() const { return static_cast<int32_t>(m_tickScheduler.get_random_tick_speed()); }
+        void set_random_tick_speed(int32_t v) { m_tickScheduler.set_random_tick_speed(static_cast<uint32_t>(godot::MAX(v, 0))); }
+
+        // Script handlers run by random ticks and by schedule_block_update for blocks with the given texture, as
+        // handler(block_position: Vector3i, id: int) -> int. Returning another block id replaces the block, returning
+        // the same id or nothing leaves it. An invalid Callable removes the handler. Handlers may edit other blocks but
+        // must not remove tickets or otherwise unload chunks.
+        void set_random_tick_handler(int32_t p_texture, const godot::Callable &p_handler);
+        void set_scheduled_update_handler(int32_t p_texture, const godot::Callable &p_handler);
+
+        TickScheduler &get_tick_scheduler() { return m_tickScheduler; }
+        LightEngine &get_light_engine() { return m_lightEngine; }
+        FluidSimulator &get_fluid_simulator() { return m_fluids; }
+        ChunkIO &get_chunk_io() { return m_io; }
+
+        // Block light emitted by solid blocks with the given texture. Chunks lit before a change keep their light
+        // until they regenerate or are edited.
+        void set_light_emission(int32_t p_texture, int32_t p_level);
+
+        // Block edits use integer block coordinates in the World's local space. Every edit between begin_edit and
+        // commit_edit only marks sections dirty, and each touched chunk is queued for a single remesh on commit.
+        static int32_t make_block_id(int32_t p_material, int32_t p_texture);
+        int32_t get_block(godot::Vector3i p_blockPos) const;
+        void set_block(godot::Vector3i p_blockPos, int32_t p_id);
+
+        void begin_edit();
+        void commit_edit();
+
+        int32_t fill_box(godot::Vector3i p_from, godot::Vector3i p_to, int32_t p_id);
+        int32_t fill_sphere(godot::Vector3i p_center, float p_radius, int32_t p_id);
+        int32_t fill_cylinder(godot::Vector3i p_baseCenter, float p_radius, int32_t p_height, int32_t p_id);
+        int32_t replace_blocks(godot::Vector3i p_from, godot::Vector3i p_to, int32_t p_fromId, int32_t p_toId);
+
+        // Bulk copies between chunk storage and a packed id buffer, ordered x fastest, then z, then y. Reads report
+        // ID_NONE for unloaded or out of range blocks; writes leave blocks whose entry is ID_NONE untouched.
+        godot::PackedInt32Array read_region(const godot::AABB &p_region) const;
+        int32_t write_region(const godot::AABB &p_region, const godot::PackedInt32Array &p_ids);
+
+        void mark_span_dirty(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z);
+        void mark_block_dirty(Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z) { mark_span_dirty(p_chunk, x, x, y, z); }
+        // Queues the sections whose faces see the span for remeshing without relighting it. p_geometry also dirties
+        // their collision shapes.
+        void mark_span_remesh(Chunk *p_chunk, uint32_t x0, uint32_t x1, uint32_t y, uint32_t z, bool p_geometry = false);
+        // A cell's fluid changed: saves and replicates it like a block edit and remeshes it, without relighting.
+        void mark_fluid_dirty(Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z);
+        void schedule_block_update(godot::Vector3i p_blockPos, int32_t p_delayTicks);
+
+        // Flowing water and lava, see FluidSimulator. Fluids spread within the simulation distance and are saved and
+        // replicated with their chunk.
+        // place_fluid_source fails on solid or unloaded blocks; get_fluid_level returns 0 to FLUID_LEVEL_MAX, or -1
+        // for unloaded blocks.
+        bool place_fluid_source(godot::Vector3i p_blockPos, int32_t p_kind);
+        bool remove_fluid(godot::Vector3i p_blockPos);
+        int32_t get_fluid_level(godot::Vector3i p_blockPos) const;
+        int32_t get_active_fluid_cell_count() const { return static_cast<int32_t>(m_fluids.get_active_cell_count()); }
+
+        // Grid raycasts against loaded blocks in the World's local space, without going through physics. raycast
+        // returns {position, normal, distance, id} or an empty dictionary on a miss. raycast_batch takes
+        // origin/direction pairs and returns each ray's hit distance, or -1 when it reaches max_distance unblocked.
+        godot::Dictionary raycast(godot::Vector3 p_origin, godot::Vector3 p_direction, float p_maxDistance) const;
+        godot::PackedFloat32Array raycast_batch(const godot::PackedVector3Array &p_rays, float p_maxDistance) const;
+
+        // Kinematic movement for many entities at once, resolved against the block grid without the physics server.
+        // Takes box centers, full sizes (one shared size or one per box) and velocities. Returns {positions, contacts}
+        // with the resolved centers and the CONTACT_* flags of each box.
+        godot::Dictionary move_aabbs(const godot::PackedVector3Array &p_centers, const godot::PackedVector3Array &p_sizes,
+                                     const godot::PackedVector3Array &p_velocities, float p_delta) const;
 
-        godot::Ref<godot::RandomNumberGenerator> get_generation_rng() { return m_worldGenRNG; }
+        // Region files for visited chunks live under save_path (a res:// or user:// path is globalized). An empty path
+        // disables persistence. Modified chunks are handed to the I/O worker when they unload, every save_interval
+        // seconds while loaded, and by save_world, so a chunk edited continuously is written at most once per
+        // interval. Everything handed off is on disk once the World leaves the tree.
+        godot::String get_save_path() const { return m_savePath; }
+        void set_save_path(const godot::String &p_path);
+        // SAVE_EDITS only stores blocks that differ from the generated baseline, and chunks nobody edited aren't
+        // saved at all. SAVE_FULL stores every visited chunk's blocks.
+        int32_t get_save_mode() const { return m_saveMode; }
+        void set_save_mode(int32_t v) { m_saveMode = static_cast<SaveMode>(godot::CLAMP(v, SAVE_FULL, SAVE_EDITS)); }
+        double get_save_interval() const { return m_saveInterval; }
+        void set_save_interval(double v) { m_saveInterval = godot::MAX(v, 0.0); }
+        int32_t save_world();
+
+        // Replication over the multiplayer API of the caller's choice, see ChunkWire for the packet layouts. The server
+        // sends encode_chunk_packet when a chunk streams in for a client and, with replicate_edits on, the packet from
+        // take_block_deltas once per network tick; it batches every block and fluid cell changed since the last call,
+        // per section. Clients apply both, usually with an empty save_path. Chunks created by a chunk packet aren't
+        // generated and stay loaded until the client unloads them.
+        uint32_t next_content_version() { return m_nextContentVersion++; }
+        bool get_replicate_edits() const { return m_replicateEdits; }
+        void set_replicate_edits(bool v) { m_replicateEdits = v; }
+        godot::PackedByteArray encode_chunk_packet(godot::Vector2i p_chunkPos) const;
+        bool apply_chunk_packet(const godot::PackedByteArray &p_packet);
+        godot::PackedByteArray take_block_deltas();
+        int32_t apply_block_deltas(const godot::PackedByteArray &p_packet);
+        // Applies a packet of any type, for clients that receive everything through one RPC.
+        bool apply_packet(const godot::PackedByteArray &p_packet);
+
+        // Dedicated server side of replication. Each peer holds a chunk ticket at its position and is queued the chunks
+        // within its radius it doesn't have at their current version, nearest and most in view first, limited to
+        // peer_bandwidth_kb per second each. take_peer_packets hands over what is due for the caller to send.
+        void add_peer(int32_t p_peerId, godot::Vector3 p_position, int32_t p_radius);
+        void update_peer(int32_t p_peerId, godot::Vector3 p_position, godot::Vector3 p_viewDirection);
+        void remove_peer(int32_t p_peerId);
+        godot::Array take_peer_packets(int32_t p_peerId);
+        int32_t get_peer_chunk_count(int32_t p_peerId) const { return static_cast<int32_t>(m_peers.get_sent_count(p_peerId)); }
+        int32_t get_peer_bandwidth_kb() const { return static_cast<int32_t>(m_peers.get_bandwidth() / 1024); }
+        void set_peer_bandwidth_kb(int32_t v) { m_peers.set_bandwidth(static_cast<size_t>(godot::MAX(v, 1)) * 1024u); }
+
+        // Chunks only get collision within collision_radius chunks of a tracked body, so collision cost scales with
+        // the number of bodies rather than the view distance.
+        int32_t get_collision_radius() const { return m_collisionRadius; }
+        void set_collision_radius(int32_t v) { m_collisionRadius = godot::CLAMP(v, 0, static_cast<int32_t>(COLLISION_RADIUS_MAX)); }
+        void add_collision_body(godot::Node3D *p_body);
+        void remove_collision_body(godot::Node3D *p_body);
+        int32_t get_collision_chunk_count() const { return static_cast<int32_t>(m_collidingChunks.size()); }
+
+        int32_t get_upload_budget_kb() const { return m_uploadBudgetKb; }
+        void set_upload_budget_kb(int32_t v) { m_uploadBudgetKb = godot::MAX(v, 1); }
+
+        // Timing zones around streaming, generation, meshing, uploads, ticks and chunk I/O. While tracing, the Voxel/
+        // Performance monitors show each zone's milliseconds in the last frame, and save_trace writes every zone
+        // recorded so far as Chrome trace JSON for chrome://tracing or Perfetto.
+        bool get_tracing() const { return Tools::Trace::is_enabled(); }
+        void set_tracing(bool v) { Tools::Trace::set_enabled(v); }
+        bool save_trace(const godot::String &p_path) const;
+        void clear_trace() { Tools::Trace::clear(); }
+        double get_trace_msec(const godot::String &p_zone) const;
+
+        int64_t add_ticket(godot::Vector3 p_position, int32_t p_radius, int32_t p_priority);
+        void move_ticket(int64_t p_id, godot::Vector3 p_position);
+        void remove_ticket(int64_t p_id);
+        bool has_ticket(int64_t p_id) const { return m_tickets.find(p_id) != m_tickets.end(); }
+
+        int32_t get_loaded_chunk_count() const { return static_cast<int32_t>(m_chunks.size()); }
+        int32_t get_pending_chunk_count() const { return static_cast<int32_t>(m_pendingLoads.size()); }
+        // Mesh buffer growths so far. Flat once remeshing has warmed up, see Core::MeshBuilder.
+        int64_t get_mesh_allocation_count() const { return static_cast<int64_t>(Core::MeshBuilder::get_allocation_count()); }
 
         Chunk *try_get_chunk(godot::Vector2i p_chunkPos) const
         {
-            // https://stackoverflow.com/questions/25144887/map-unordered-map-prefer-find-and-then-at-or-try-at-catch-out-of-range
-            auto key = Tools::Hash::chunk_pos(p_chunkPos);
-            auto iterator = m_chunks.find(key);
-
-            if (iterator != m_chunks.end())
-            {
-                Tools::Log::debug() << "Found chunk at " << Tools::String::to_string(p_chunkPos) << ".";
-                return iterator->second;
-            }
-            else
-            {
-                // Tools::Log::warn() << "Attempted to get chunk at " << Tools::String::to_string(p_chunkPos)
-                //                    << " but it was not part of the world's map.";
-                return nullptr;
-            }
+            Chunk *pChunk = m_chunks.find(p_chunkPos);
+            if (pChunk)
+                VOXEL_LOG_DEBUG("Found chunk at {}.", p_chunkPos);
+
+            return pChunk;
         }
 
         void unload_chunk(Chunk *p_chunk);
@@ -97,9 +266,50 @@ namespace Voxel
 
     protected:
         static void _bind_methods();
+        void _notification(int p_what);
 
     private:
-        void set_generation_rng();
+        enum StreamingStep
+        {
+            STEP_UNLOAD = 0,
+            STEP_GENERATE,
+            STEP_REGENERATE,
+            STEP_MESH,
+            STEP_UPLOAD,
+            STEP_SAVE,
+            // Regenerates the chunk's baseline before encoding it, costs about a STEP_GENERATE more than STEP_SAVE.
+            STEP_SAVE_OVERLAY,
+            STEP_COUNT
+        };
+
+        struct FrameBudget
+        {
+            uint64_t startUsec;
+            uint64_t timeUsec;
+            size_t uploadBytes;
+            size_t uploadedBytes;
+            uint32_t steps;
+        };
+
+        void integrate_streaming();
+        void run_tick();
+        static bool run_random_tick_handler(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, Block *p_block);
+        static bool run_scheduled_update_handler(World *p_world, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, Block *p_block);
+        bool call_block_handler(const godot::Callable &p_handler, Chunk *p_chunk, uint32_t x, uint32_t y, uint32_t z, Block *p_block);
+        void open_save_directory();
+        void update_colliders();
+        void add_trace_monitors();
+        void remove_trace_monitors();
+
+        bool get_region_bounds(const godot::AABB &p_region, godot::Vector3i &r_min, godot::Vector3i &r_size) const;
+        Chunk *find_block_chunk(godot::Vector3i p_blockPos, uint32_t &r_x, uint32_t &r_y, uint32_t &r_z) const;
+        template <class ShapeFn, class WriteFn>
+        int32_t apply_spans(godot::Vector3i p_min, godot::Vector3i p_max, ShapeFn &&p_shape, WriteFn &&p_write);
+        void mark_section_dirty(Chunk *p_chunk, uint32_t p_section);
+        void flush_dirty_chunks();
+        bool can_afford(const FrameBudget &p_budget, StreamingStep p_step) const;
+        void record_step(FrameBudget &r_budget, StreamingStep p_step, uint64_t p_stepStartUsec);
+
         void build_debounce_timer();
         void rebuild_debounce_timer();
         void default_pallet();
@@ -108,13 +318,35 @@ namespace Voxel
 
         void request_rebuild();
         void rebuild();
+        Chunk::ChunkPos get_camera_chunk_pos() const;
+        void sort_stale_chunks();
+        size_t regenerate_next_stale_chunk();
 
         void generate_spawn();
         // void generate_spawn_rebuild();
-        void generate_new_chunk(int x, int y);
+        // Decodes p_saved into the new chunk when given, generates it otherwise.
+        void generate_new_chunk(int x, int y, const std::vector<uint8_t> *p_saved = nullptr);
+        // Replaces a loaded chunk's blocks with its save, or generates them when none loads.
+        void reload_blocks(Chunk *p_chunk);
+        // Adds an empty, initialized chunk to the world for its blocks to be filled in.
+        Chunk *create_chunk(int x, int z);
+        void request_pending_loads();
+        void queue_modified_saves();
+
+        Chunk::ChunkPos to_chunk_pos(godot::Vector3 p_position) const;
+        int64_t add_ticket_at(Chunk::ChunkPos p_center, int32_t p_radius, int32_t p_priority);
+        void ensure_spawn_ticket();
+        void acquire_ticket_area(const Ticket &p_ticket);
+        void release_ticket_area(const Ticket &p_ticket);
+        void queue_ticketed_chunks();
+        void order_pending_loads(size_t p_max, std::vector<uint64_t> &r_keys) const;
+        bool unload_next_pending_chunk();
 
         godot::Timer *m_pDebounceTimer;
         const double DEBOUNCE_DELAY = 1.5;
+        bool m_isSubscribed = false;
+        // Only the World that added the shared monitors removes them.
+        bool m_hasTraceMonitors = false;
 
         // TODO: Implement material object dither distance fade for all chunk materials based on this value and update when
         // it changes
@@ -123,8 +355,68 @@ namespace Voxel
         int32_t m_spawnRadius = 3;
         godot::Ref<Resource::Pallet> m_pallet;
         godot::Ref<Resource::GenerationSettings> m_generationSettings;
-        godot::Ref<godot::RandomNumberGenerator> m_worldGenRNG;
 
-        std::unordered_map<uint64_t, Chunk *> m_chunks;
+        ChunkGrid m_chunks;
+
+        // Most load candidates ranked per frame. The time budget decides how many of them actually generate.
+        static constexpr size_t MAX_LOADS_PER_FRAME = 32;
+
+        double m_streamingBudgetMs = 4.0;
+        int32_t m_uploadBudgetKb = 4096;
+        // Running average cost of each streaming step, used to stop before a step would overrun the budget.
+        double m_stepCostUsec[STEP_COUNT] = {};
+
+        int32_t m_simulationDistance = 4;
+        double m_tickAccumulator = 0.0;
+        TickScheduler m_tickScheduler;
+        godot::Callable m_randomTickHandlers[Resource::Pallet::TEXTURE_COUNT];
+        godot::Callable m_scheduledUpdateHandlers[Resource::Pallet::TEXTURE_COUNT];
+        LightEngine m_lightEngine;
+        FluidSimulator m_fluids;
+
+        godot::String m_savePath = "user://world";
+        SaveMode m_saveMode = SAVE_EDITS;
+        double m_saveInterval = 5.0;
+        double m_saveAccumulator = 0.0;
+        ChunkIO m_io;
+        // Chunk hashes with a load on the I/O worker. Finished loads are dropped if the chunk is no longer pending.
+        std::unordered_set<uint64_t> m_loadRequests;
+        // Modified chunks left to hand off for the current save interval.
+        std::vector<uint64_t> m_saveQueue;
+        std::vector<Chunk *> m_simulatedChunks;
+
+        bool m_replicateEdits = false;
+        ChunkWire::DeltaBatch m_deltaBatch;
+        uint32_t m_nextContentVersion = 1;
+        PeerTracker m_peers;
+
+        // Section shapes rebuilt per physics frame, across all colliding chunks.
+        static constexpr uint32_t MAX_COLLISION_SECTIONS_PER_FRAME = 8;
+
+        int32_t m_collisionRadius = 1;
+        std::vector<uint64_t> m_collisionBodies;
+        std::vector<Chunk *> m_collidingChunks;
+
+        uint32_t m_editDepth = 0;
+        // Largest region read_region and write_region accept, 64 MiB of ids.
+        static constexpr int64_t MAX_REGION_BLOCKS = 16 * 1024 * 1024;
+
+        // Chunks with dirty sections, queued for remeshing when the outermost edit commits.
+        std::vector<Chunk *> m_dirtyChunks;
+
+        std::unordered_map<int64_t, Ticket> m_tickets;
+        // Chunk hash -> number of tickets covering it. A chunk is wanted while its count is non-zero.
+        std::unordered_map<uint64_t, uint32_t> m_ticketRefs;
+        // Wanted chunks that are not generated yet. Being a set, overlapping tickets can't queue a chunk twice.
+        std::unordered_set<uint64_t> m_pendingLoads;
+        // Chunks no ticket covers any more, unloaded by the integrator unless re-covered first.
+        std::deque<uint64_t> m_pendingUnloads;
+        int64_t m_nextTicketId = 1;
+        int64_t m_spawnTicket = 0;
+
+        // Chunk hashes awaiting in-place regeneration, farthest from the camera first. A chunk is stale while its
+        // generation hash differs from the World's.
+        std::vector<uint64_t> m_staleChunks;
+        Chunk::ChunkPos m_staleSortCenter;
     };
 } //namespace Voxel
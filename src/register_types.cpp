@@ -1,5 +1,5 @@
 #include "hpp/core/voxelgdcpp.hpp"
-#include "hpp/voxel/chunk.hpp"
+#include "hpp/tools/log.hpp"
 #include "hpp/voxel/resource/generation_settings.hpp"
 #include "hpp/voxel/resource/pallet.hpp"
 #include "hpp/voxel/world.hpp"
@@ -20,7 +20,6 @@ void initialize_gdextension_types(ModuleInitializationLevel p_level)
 
     GDREGISTER_CLASS(VoxelGDCPP)
 
-    ClassDB::register_class<Voxel::Chunk>();
     ClassDB::register_class<Voxel::World>();
 
     ClassDB::register_class<Voxel::Resource::Pallet>();
@@ -33,6 +32,9 @@ void uninitialize_gdextension_types(ModuleInitializationLevel p_level)
     {
         return;
     }
+
+    // The log writer thread must be joined before the library unloads.
+    Tools::Log::end();
 }
 
 extern "C"